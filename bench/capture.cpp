@@ -0,0 +1,187 @@
+#include "libpkt/interface.hpp"
+#include "libpkt/latency.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <linux/if_packet.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+// Capture profiles side by side: for each Interface::Config, a receiver
+// thread captures on <rx> while frames are sent on <tx> (the two ends of a
+// veth pair), first paced at [pps] to measure send-to-userspace latency,
+// then as fast as possible to measure drops. Each frame carries a sequence
+// number and its send time, so loss is counted exactly; the kernel's own
+// drop counter (PACKET_STATISTICS) is shown next to it.
+//
+//   bench_capture <tx> <rx> [pps] [frames]
+
+namespace {
+constexpr uint16_t BenchEtherType = 0x88B5; // IEEE local experimental
+constexpr uint32_t Magic = 0x4C504B54;
+constexpr size_t FrameSize = 128;
+
+struct Probe {
+    uint32_t magic;
+    uint32_t run;
+    uint64_t seq;
+    uint64_t sent_ns;
+};
+
+struct Profile {
+    const char* name;
+    libpkt::Interface::Config config;
+};
+
+struct Result {
+    std::string report;
+    uint64_t received = 0;
+    uint64_t kernel_drops = 0;
+    libpkt::LatencyHistogram latency;
+};
+
+uint64_t Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+void Receive(const char* rx, const libpkt::Interface::Config& config, uint32_t run,
+             uint64_t frames, std::atomic<int>& state, Result& result) {
+    libpkt::Interface iface(rx, config);
+    if (!iface.Open()) {
+        state = -1;
+        return;
+    }
+    result.report = iface.GetReport().Summary();
+    struct timeval timeout = {0, 100000};
+    setsockopt(iface.Fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::vector<bool> seen(frames);
+    libpkt::PacketBatch batch;
+    state = 1;
+    for (;;) {
+        // Keep draining after the sender is done; a timeout then ends it.
+        if (iface.ReceiveBatch(batch) <= 0) {
+            if (state == 2)
+                break;
+            continue;
+        }
+        const uint64_t now = Now();
+        for (const auto& frame : batch) {
+            Probe probe;
+            if (frame.length < 14 + sizeof(probe) || frame.data[12] != (BenchEtherType >> 8) ||
+                frame.data[13] != (BenchEtherType & 0xFF))
+                continue;
+            std::memcpy(&probe, frame.data + 14, sizeof(probe));
+            if (probe.magic != Magic || probe.run != run || probe.seq >= frames ||
+                seen[probe.seq])
+                continue;
+            seen[probe.seq] = true;
+            ++result.received;
+            result.latency.Record(now - probe.sent_ns);
+        }
+    }
+    struct tpacket_stats stats{};
+    socklen_t length = sizeof(stats);
+    if (getsockopt(iface.Fd(), SOL_PACKET, PACKET_STATISTICS, &stats, &length) == 0)
+        result.kernel_drops = stats.tp_drops;
+}
+
+// Send `frames` probes; `pps` 0 sends back to back.
+void Send(libpkt::Interface& tx, uint32_t run, uint64_t frames, double pps) {
+    uint8_t frame[FrameSize] = {};
+    std::memset(frame, 0xFF, 6);
+    const uint8_t source[6] = {0x02, 0, 0, 0, 0, 0x01};
+    std::memcpy(frame + 6, source, 6);
+    frame[12] = BenchEtherType >> 8;
+    frame[13] = BenchEtherType & 0xFF;
+    const uint64_t start = Now();
+    for (uint64_t seq = 0; seq < frames; ++seq) {
+        if (pps > 0) {
+            const uint64_t due = start + static_cast<uint64_t>(seq * 1e9 / pps);
+            while (Now() < due)
+                std::this_thread::yield();
+        }
+        Probe probe{Magic, run, seq, Now()};
+        std::memcpy(frame + 14, &probe, sizeof(probe));
+        while (tx.Send(frame, sizeof(frame)) < 0 && errno == ENOBUFS)
+            std::this_thread::yield();
+    }
+}
+
+bool Run(const char* rx, libpkt::Interface& tx, const Profile& profile, uint32_t run,
+         uint64_t frames, double pps) {
+    std::atomic<int> state(0);
+    Result result;
+    std::thread receiver(Receive, rx, std::cref(profile.config), run, frames, std::ref(state),
+                         std::ref(result));
+    while (state == 0)
+        std::this_thread::yield();
+    if (state < 0) {
+        receiver.join();
+        std::cerr << profile.name << ": failed to open " << rx << "\n";
+        return false;
+    }
+    Send(tx, run, frames, pps);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    state = 2;
+    receiver.join();
+
+    const uint64_t lost = frames - result.received;
+    if (pps > 0)
+        std::cout << "  options: " << result.report << "\n";
+    std::cout << "  " << (pps > 0 ? "paced" : "flood") << ": received=" << result.received << "/"
+              << frames << " lost=" << lost << " (" << 100.0 * lost / frames
+              << "%) kernel_drops=" << result.kernel_drops
+              << " latency: " << result.latency.Summary() << "\n";
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <tx> <rx> [pps] [frames]\n";
+        return 1;
+    }
+    const double pps = argc > 3 ? std::atof(argv[3]) : 20000;
+    const uint64_t frames = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 100000;
+    const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+
+    libpkt::Interface tx(argv[1]);
+    if (!tx.Open()) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    using Config = libpkt::Interface::Config;
+    std::vector<Profile> profiles(4);
+    profiles[0].name = "default";
+    profiles[1].name = "large rcvbuf";
+    profiles[1].config.rcvbuf = 32 << 20;
+    profiles[2].name = "busy poll";
+    profiles[2].config.rcvbuf = 32 << 20;
+    profiles[2].config.busy_poll_us = 50;
+    profiles[2].config.prefer_busy_poll = true;
+    profiles[3].name = "pinned";
+    profiles[3].config.rcvbuf = 32 << 20;
+    profiles[3].config.ignore_outgoing = true;
+    profiles[3].config.promiscuous = true;
+    profiles[3].config.cpu = cpus > 1 ? cpus - 1 : 0;
+    profiles[3].config.numa_node = Config::InterfaceNode;
+
+    uint32_t run = 0;
+    for (const Profile& profile : profiles) {
+        std::cout << profile.name << ":\n";
+        if (!Run(argv[2], tx, profile, ++run, frames, pps) ||
+            !Run(argv[2], tx, profile, ++run, frames, 0))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,439 @@
+#include "libpkt/classify.hpp"
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/pcap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Connection classification on mixed HTTPS/HTTP traffic. Without an
+// argument a capture is synthesized: TLS connections with Chrome-like
+// ClientHellos (shuffled extensions, GREASE, ECH and a post-quantum key
+// share, so most span two segments), HTTP/1.1 requests and server-first
+// connections, each followed by bulk data, interleaved. Reported are how
+// many connections the Classifier named correctly and its rate against
+// calling Parse() on every payload, which needs no table lookup but leaves
+// ClientHellos spanning segments incomplete.
+//
+// Before that, every ClientHello and request is cut at every length and
+// split into two segments at every offset, checking that nothing is read out
+// of bounds (run under ASan for that) and that the fields found agree with
+// the full parse.
+//
+//   bench_classify [file.pcap]
+
+namespace {
+using Bytes = std::vector<uint8_t>;
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Put16(Bytes& b, size_t value) {
+    b.push_back(static_cast<uint8_t>(value >> 8));
+    b.push_back(static_cast<uint8_t>(value));
+}
+
+void Append(Bytes& b, const std::string& s) {
+    b.insert(b.end(), s.begin(), s.end());
+}
+
+Bytes Random(std::mt19937_64& rng, size_t length) {
+    Bytes b(length);
+    for (auto& byte : b)
+        byte = static_cast<uint8_t>(rng());
+    return b;
+}
+
+Bytes Extension(uint16_t type, const Bytes& body) {
+    Bytes e;
+    Put16(e, type);
+    Put16(e, body.size());
+    e.insert(e.end(), body.begin(), body.end());
+    return e;
+}
+
+struct Expected {
+    std::string sni, host, method;
+    std::vector<std::string> alpn;
+    bool ech = false;
+};
+
+Bytes ClientHello(std::mt19937_64& rng, const std::string& sni, Expected& expected) {
+    const uint16_t grease = static_cast<uint16_t>(0x0A0A + 0x1010 * (rng() % 16));
+    std::vector<Bytes> extensions;
+
+    Bytes name;
+    Put16(name, sni.size() + 3);
+    name.push_back(0);
+    Put16(name, sni.size());
+    Append(name, sni);
+    extensions.push_back(Extension(0, name));
+
+    Bytes alpn;
+    const std::vector<std::string> protocols = {"h2", "http/1.1"};
+    Put16(alpn, (1 + 2) + (1 + 8));
+    for (const auto& p : protocols) {
+        alpn.push_back(static_cast<uint8_t>(p.size()));
+        Append(alpn, p);
+    }
+    extensions.push_back(Extension(16, alpn));
+    extensions.push_back(Extension(43, {6, static_cast<uint8_t>(grease >> 8),
+                                        static_cast<uint8_t>(grease), 3, 4, 3, 3}));
+    extensions.push_back(Extension(23, {}));
+    extensions.push_back(Extension(0xFF01, {0}));
+    extensions.push_back(Extension(10, {0, 8, 0x11, 0xEC, 0, 0x1D, 0, 0x17, 0, 0x18}));
+    extensions.push_back(Extension(11, {1, 0}));
+    extensions.push_back(Extension(35, {}));
+    extensions.push_back(Extension(5, {1, 0, 0, 0, 0}));
+    extensions.push_back(Extension(13, Random(rng, 18)));
+    extensions.push_back(Extension(18, {}));
+    // X25519MLKEM768 (1216 bytes) and X25519 (32 bytes) key shares.
+    Bytes shares;
+    Put16(shares, 4 + 1216 + 4 + 32);
+    Put16(shares, 0x11EC);
+    Put16(shares, 1216);
+    Bytes pq = Random(rng, 1216);
+    shares.insert(shares.end(), pq.begin(), pq.end());
+    Put16(shares, 0x1D);
+    Put16(shares, 32);
+    Bytes x = Random(rng, 32);
+    shares.insert(shares.end(), x.begin(), x.end());
+    extensions.push_back(Extension(51, shares));
+    extensions.push_back(Extension(45, {1, 1}));
+    extensions.push_back(Extension(27, {2, 0, 2}));
+    extensions.push_back(Extension(0xFE0D, Random(rng, 186 + rng() % 64)));
+    std::shuffle(extensions.begin(), extensions.end(), rng);
+    extensions.insert(extensions.begin(), Extension(grease, {}));
+    extensions.push_back(Extension(grease ^ 0x1010, {0}));
+
+    Bytes ext;
+    for (const auto& e : extensions)
+        ext.insert(ext.end(), e.begin(), e.end());
+    Bytes body = {3, 3};
+    Bytes random = Random(rng, 32);
+    body.insert(body.end(), random.begin(), random.end());
+    body.push_back(32);
+    Bytes session = Random(rng, 32);
+    body.insert(body.end(), session.begin(), session.end());
+    Put16(body, 32);
+    Bytes suites = Random(rng, 32);
+    body.insert(body.end(), suites.begin(), suites.end());
+    body.push_back(1);
+    body.push_back(0);
+    Put16(body, ext.size());
+    body.insert(body.end(), ext.begin(), ext.end());
+
+    Bytes hello = {22, 3, 1};
+    Put16(hello, body.size() + 4);
+    hello.push_back(1);
+    hello.push_back(0);
+    Put16(hello, body.size());
+    hello.insert(hello.end(), body.begin(), body.end());
+
+    expected.sni = sni;
+    expected.alpn = protocols;
+    expected.ech = true;
+    return hello;
+}
+
+Bytes Request(std::mt19937_64& rng, const std::string& host, Expected& expected) {
+    static const char* const methods[] = {"GET", "POST", "HEAD", "PUT"};
+    expected.method = methods[rng() % 4];
+    expected.host = host;
+    std::string request = expected.method + " /api/v1/items/" + std::to_string(rng() % 100000) +
+                          " HTTP/1.1\r\nUser-Agent: bench/1.0\r\nAccept: */*\r\nHost: " + host +
+                          "\r\nConnection: keep-alive\r\n\r\n";
+    return Bytes(request.begin(), request.end());
+}
+
+bool Same(const libpkt::l7::Result& r, const Expected& e) {
+    if (r.sni != e.sni || r.host != e.host || r.method != e.method)
+        return false;
+    if (e.sni.empty())
+        return true;
+    if (r.alpn_count != e.alpn.size() || r.tls_version != 0x0304 || r.ech != e.ech)
+        return false;
+    for (size_t i = 0; i < e.alpn.size(); ++i) {
+        if (r.alpn[i] != e.alpn[i])
+            return false;
+    }
+    return true;
+}
+
+// Merge what a later segment added.
+void Merge(libpkt::l7::Result& into, const libpkt::l7::Result& more, std::string& sni,
+           std::vector<std::string>& alpn) {
+    if (!more.sni.empty())
+        sni = more.sni;
+    for (size_t i = 0; i < more.alpn_count; ++i)
+        alpn.emplace_back(more.alpn[i]);
+    into.tls_version = std::max(into.tls_version, more.tls_version);
+    into.ech |= more.ech;
+}
+
+// Every prefix and every two-segment split of `message`; returns mismatches.
+uint64_t Sweep(const Bytes& message, const Expected& expected, uint64_t& checks) {
+    using namespace libpkt::l7;
+    uint64_t bad = 0;
+    Result full;
+    Parse(message.data(), message.size(), full);
+    if (!full.complete || !Same(full, expected))
+        ++bad;
+    for (size_t cut = 0; cut <= message.size(); ++cut) {
+        // A prefix in its own buffer, so ASan sees any overread.
+        Bytes prefix(message.begin(), message.begin() + cut);
+        Result r;
+        Parse(prefix.data(), prefix.size(), r);
+        ++checks;
+        if ((!r.sni.empty() && r.sni != expected.sni) ||
+            (!r.host.empty() && r.host != expected.host) || (r.complete && cut != message.size()))
+            ++bad;
+
+        // Second segment: what the prefix did not cover.
+        Continuation c;
+        Parse(prefix.data(), prefix.size(), r, &c);
+        std::string sni(r.sni);
+        std::vector<std::string> alpn;
+        for (size_t i = 0; i < r.alpn_count; ++i)
+            alpn.emplace_back(r.alpn[i]);
+        Bytes rest(message.begin() + cut, message.end());
+        Result more;
+        if (Resume(c, rest.data(), rest.size(), more)) {
+            Merge(r, more, sni, alpn);
+            r.complete = more.complete;
+        }
+        if (r.kind == Kind::TLS && cut >= 200) {
+            // Past the fixed fields the walk resumes and must find it all.
+            ++checks;
+            if (sni != expected.sni || alpn != expected.alpn || r.tls_version != 0x0304 ||
+                r.ech != expected.ech || !r.complete)
+                ++bad;
+        }
+    }
+    return bad;
+}
+
+Bytes Frame(uint32_t src, uint32_t dst, uint16_t sport, uint16_t dport, uint32_t seq,
+            uint8_t flags, const uint8_t* payload, size_t length) {
+    Bytes f(14 + 20 + 20 + length);
+    f[12] = 0x08;
+    uint8_t* ip = f.data() + 14;
+    ip[0] = 0x45;
+    ip[2] = static_cast<uint8_t>((40 + length) >> 8);
+    ip[3] = static_cast<uint8_t>(40 + length);
+    ip[8] = 64;
+    ip[9] = 6;
+    for (int i = 0; i < 4; ++i) {
+        ip[12 + i] = static_cast<uint8_t>(src >> (24 - 8 * i));
+        ip[16 + i] = static_cast<uint8_t>(dst >> (24 - 8 * i));
+    }
+    uint8_t* tcp = ip + 20;
+    tcp[0] = static_cast<uint8_t>(sport >> 8);
+    tcp[1] = static_cast<uint8_t>(sport);
+    tcp[2] = static_cast<uint8_t>(dport >> 8);
+    tcp[3] = static_cast<uint8_t>(dport);
+    for (int i = 0; i < 4; ++i)
+        tcp[4 + i] = static_cast<uint8_t>(seq >> (24 - 8 * i));
+    tcp[12] = 0x50;
+    tcp[13] = flags;
+    if (length != 0)
+        std::memcpy(tcp + 20, payload, length);
+    return f;
+}
+
+struct Synthetic {
+    std::vector<Bytes> frames;
+    std::vector<std::pair<libpkt::FlowKey, Expected>> connections;
+};
+
+Synthetic Synthesize(size_t connections, std::mt19937_64& rng) {
+    constexpr size_t Mss = 1448;
+    constexpr uint8_t SYN = 0x02, ACK = 0x10, PSH = 0x08;
+    Synthetic out;
+    std::vector<std::vector<Bytes>> flows(connections);
+    for (size_t i = 0; i < connections; ++i) {
+        const uint32_t client = 0x0A000000 | static_cast<uint32_t>(rng() % 0xFFFFFF);
+        const uint32_t server = 0xC0A80000 | static_cast<uint32_t>(rng() % 0xFFFF);
+        const uint16_t port = static_cast<uint16_t>(1024 + rng() % 60000);
+        const int kind = static_cast<int>(rng() % 10);
+        const uint16_t service = kind < 6 ? 443 : kind < 9 ? 80 : 22;
+        const std::string name = "host" + std::to_string(i) + ".example.com";
+        Expected expected;
+        Bytes first;
+        if (service == 443)
+            first = ClientHello(rng, name, expected);
+        else if (service == 80)
+            first = Request(rng, name, expected);
+        out.connections.push_back({{client, server, port, service, 6}, expected});
+
+        auto& f = flows[i];
+        uint32_t cseq = static_cast<uint32_t>(rng()), sseq = static_cast<uint32_t>(rng());
+        f.push_back(Frame(client, server, port, service, cseq++, SYN, nullptr, 0));
+        f.push_back(Frame(server, client, service, port, sseq++, SYN | ACK, nullptr, 0));
+        f.push_back(Frame(client, server, port, service, cseq, ACK, nullptr, 0));
+        if (service == 22) {
+            const std::string banner = "SSH-2.0-OpenSSH_9.6\r\n";
+            f.push_back(Frame(server, client, service, port, sseq, PSH | ACK,
+                              reinterpret_cast<const uint8_t*>(banner.data()), banner.size()));
+            sseq += static_cast<uint32_t>(banner.size());
+        }
+        for (size_t at = 0; at < first.size(); at += Mss) {
+            size_t n = std::min(Mss, first.size() - at);
+            f.push_back(
+                Frame(client, server, port, service, cseq, PSH | ACK, first.data() + at, n));
+            cseq += static_cast<uint32_t>(n);
+        }
+        Bytes data = Random(rng, Mss);
+        for (int k = 0; k < 20; ++k) {
+            f.push_back(Frame(server, client, service, port, sseq, ACK, data.data(), Mss));
+            sseq += Mss;
+            if (k % 2)
+                f.push_back(Frame(client, server, port, service, cseq, ACK, nullptr, 0));
+        }
+    }
+    // Interleave: frames of ~256 connections at a time.
+    for (size_t base = 0; base < connections; base += 256) {
+        const size_t last = std::min(connections, base + 256);
+        for (size_t k = 0;; ++k) {
+            bool any = false;
+            for (size_t i = base; i < last; ++i) {
+                if (k < flows[i].size()) {
+                    out.frames.push_back(std::move(flows[i][k]));
+                    any = true;
+                }
+            }
+            if (!any)
+                break;
+        }
+    }
+    return out;
+}
+
+libpkt::FlowKey Canonical(libpkt::FlowKey key) {
+    bool swap = key.src_ip > key.dst_ip ||
+                (key.src_ip == key.dst_ip && key.src_port > key.dst_port);
+    return swap ? key.Reversed() : key;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::mt19937_64 rng(11);
+
+    uint64_t checks = 0, mismatches = 0;
+    for (int i = 0; i < 40; ++i) {
+        Expected e;
+        Bytes hello = ClientHello(rng, "sweep" + std::to_string(i) + ".example.org", e);
+        mismatches += Sweep(hello, e, checks);
+        Expected h;
+        Bytes request = Request(rng, "www" + std::to_string(i) + ".example.net", h);
+        mismatches += Sweep(request, h, checks);
+    }
+    std::cout << "truncation/split checks=" << checks << " mismatches=" << mismatches << "\n";
+
+    std::vector<Bytes> owned;
+    std::vector<libpkt::FrameView> frames;
+    Synthetic synthetic;
+    if (argc > 1) {
+        libpkt::PcapReader reader;
+        if (!reader.Open(argv[1])) {
+            std::cerr << "Failed to open " << argv[1] << "\n";
+            return 1;
+        }
+        libpkt::FrameView f;
+        while (reader.Next(f))
+            owned.emplace_back(f.data, f.data + f.length);
+    } else {
+        synthetic = Synthesize(20000, rng);
+        owned = std::move(synthetic.frames);
+    }
+    for (const auto& f : owned)
+        frames.push_back({f.data(), f.size(), 0});
+
+    // Correctness against the synthesized connections.
+    if (!synthetic.connections.empty()) {
+        std::unordered_map<uint64_t, size_t> index;
+        for (size_t i = 0; i < synthetic.connections.size(); ++i)
+            index[libpkt::HashFlowKey(Canonical(synthetic.connections[i].first))] = i;
+        std::vector<Expected> got(synthetic.connections.size());
+        libpkt::l7::Classifier classifier;
+        for (const auto& frame : frames) {
+            libpkt::l7::Result r;
+            libpkt::FlowKey key;
+            if (!classifier.Update(frame, r) ||
+                !libpkt::ExtractFlowKey(frame.data, frame.length, key))
+                continue;
+            auto it = index.find(libpkt::HashFlowKey(Canonical(key)));
+            if (it == index.end())
+                continue;
+            Expected& e = got[it->second];
+            if (!r.sni.empty())
+                e.sni = r.sni;
+            if (!r.host.empty())
+                e.host = r.host;
+            if (!r.method.empty())
+                e.method = r.method;
+            for (size_t i = 0; i < r.alpn_count; ++i)
+                e.alpn.emplace_back(r.alpn[i]);
+        }
+        uint64_t named = 0, wrong = 0;
+        for (size_t i = 0; i < got.size(); ++i) {
+            const Expected& want = synthetic.connections[i].second;
+            named += !got[i].sni.empty() || !got[i].host.empty();
+            wrong += got[i].sni != want.sni || got[i].host != want.host ||
+                     got[i].method != want.method || got[i].alpn != want.alpn;
+        }
+        const auto& stats = classifier.GetStats();
+        std::cout << "connections=" << got.size() << " named=" << named << " wrong=" << wrong
+                  << " tls=" << stats.tls << " http=" << stats.http
+                  << " unknown=" << stats.unknown << " resumed=" << stats.resumed
+                  << " skipped=" << stats.skipped << "\n";
+    }
+
+    const int rounds = 5;
+    uint64_t sink = 0;
+    std::vector<libpkt::l7::Classifier> classifiers(rounds);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& classifier : classifiers) {
+        for (const auto& frame : frames) {
+            libpkt::l7::Result r;
+            sink += classifier.Update(frame, r) ? r.sni.size() + r.host.size() : 0;
+        }
+    }
+    const double classifierMpps = rounds * frames.size() / Seconds(start) / 1e6;
+
+    // Without the short circuit: every payload goes through Parse().
+    uint64_t labelled = 0, incomplete = 0;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& frame : frames) {
+            libpkt::EthernetFrame eth(frame.data, frame.length);
+            if (!eth.IsValid() || eth.Ethertype() != libpkt::EtherType::IPv4)
+                continue;
+            libpkt::IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+            if (!ip.IsValid() || ip.GetProtocol() != libpkt::Protocol::TCP)
+                continue;
+            libpkt::tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+            if (!tcp.IsValid() || tcp.PayloadLength() == 0)
+                continue;
+            libpkt::l7::Result r;
+            labelled += libpkt::l7::Parse(tcp.Payload(), tcp.PayloadLength(), r) !=
+                        libpkt::l7::Kind::Unknown;
+            incomplete += r.kind != libpkt::l7::Kind::Unknown && !r.complete;
+            sink += r.sni.size() + r.host.size();
+        }
+    }
+    const double parseMpps = rounds * frames.size() / Seconds(start) / 1e6;
+
+    std::cout << "frames=" << frames.size() << " classifier Mpps=" << classifierMpps
+              << " parse-every-payload Mpps=" << parseMpps
+              << " (labelled=" << labelled / rounds << " incomplete=" << incomplete / rounds
+              << ")" << (sink == 0 ? " " : "") << "\n";
+    return 0;
+}
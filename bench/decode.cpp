@@ -0,0 +1,181 @@
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/layer.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+// Per-packet cost of decoding Ethernet/IPv4/TCP|UDP headers, once through the
+// concrete packet types, once through DecodeLayers() + std::visit, and once
+// through a polymorphic layer stack modelled on the pre-variant design
+// (virtual destructor and accessors, MACs copied at construction) as the
+// baseline for both.
+
+namespace {
+std::vector<std::vector<uint8_t>> MakeFrames(size_t count) {
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint8_t> f(64 + rng() % 1400);
+        for (auto& b : f)
+            b = static_cast<uint8_t>(rng());
+        size_t total = f.size() - 14;
+        f[12] = 0x08;
+        f[13] = 0x00;
+        f[14] = 0x45;
+        f[16] = static_cast<uint8_t>(total >> 8);
+        f[17] = static_cast<uint8_t>(total);
+        f[23] = (i & 1) ? 6 : 17;
+        f[46] = 0x50;
+        frames.push_back(std::move(f));
+    }
+    return frames;
+}
+
+// Baseline: each layer a polymorphic object, reached through base pointers.
+class VirtualLayer {
+  public:
+    virtual ~VirtualLayer() = default;
+    virtual bool IsValid() const = 0;
+};
+
+class VirtualEthernet : public VirtualLayer {
+  public:
+    VirtualEthernet(const uint8_t* data, size_t length) : m_frame(data, length) {
+        if (m_frame.IsValid()) {
+            std::memcpy(m_dst.data(), data, 6);
+            std::memcpy(m_src.data(), data + 6, 6);
+        }
+    }
+    bool IsValid() const override { return m_frame.IsValid(); }
+    const libpkt::EthernetFrame& Frame() const { return m_frame; }
+
+  private:
+    libpkt::EthernetFrame m_frame;
+    std::array<uint8_t, 6> m_dst{};
+    std::array<uint8_t, 6> m_src{};
+};
+
+class VirtualIPv4 : public VirtualLayer {
+  public:
+    VirtualIPv4(const uint8_t* data, size_t length) : m_packet(data, length) {}
+    bool IsValid() const override { return m_packet.IsValid(); }
+    const libpkt::IPv4Packet& Packet() const { return m_packet; }
+
+  private:
+    libpkt::IPv4Packet m_packet;
+};
+
+template <typename T> class VirtualTransport : public VirtualLayer {
+  public:
+    VirtualTransport(const uint8_t* data, size_t length) : m_packet(data, length) {}
+    bool IsValid() const override { return m_packet.IsValid(); }
+
+  private:
+    T m_packet;
+};
+
+// Placement storage for one decoded stack.
+class VirtualStack {
+  public:
+    ~VirtualStack() {
+        for (size_t i = 0; i < m_count; ++i)
+            m_layers[i]->~VirtualLayer();
+    }
+    template <typename T> T* Push(const uint8_t* data, size_t length) {
+        static_assert(sizeof(T) <= sizeof(m_storage[0]));
+        T* layer = new (m_storage[m_count]) T(data, length);
+        m_layers[m_count++] = layer;
+        return layer;
+    }
+    VirtualLayer* const* Layers() const { return m_layers; }
+    size_t Count() const { return m_count; }
+
+  private:
+    alignas(8) unsigned char m_storage[libpkt::MaxLayers][64];
+    VirtualLayer* m_layers[libpkt::MaxLayers];
+    size_t m_count = 0;
+};
+
+void DecodeVirtual(const uint8_t* data, size_t length, VirtualStack& stack) {
+    auto* eth = stack.Push<VirtualEthernet>(data, length);
+    if (!eth->IsValid() || eth->Frame().Ethertype() != libpkt::EtherType::IPv4)
+        return;
+    auto* ip = stack.Push<VirtualIPv4>(eth->Frame().Payload(), eth->Frame().PayloadLength());
+    if (!ip->IsValid() || ip->Packet().FragmentOffset() != 0)
+        return;
+    if (ip->Packet().GetProtocol() == libpkt::Protocol::TCP)
+        stack.Push<VirtualTransport<libpkt::tcp::Packet>>(ip->Packet().Payload(),
+                                                          ip->Packet().PayloadLength());
+    else if (ip->Packet().GetProtocol() == libpkt::Protocol::UDP)
+        stack.Push<VirtualTransport<libpkt::udp::Packet>>(ip->Packet().Payload(),
+                                                          ip->Packet().PayloadLength());
+}
+
+// Out of line, so the calls below stay virtual.
+[[gnu::noinline]] uint64_t SumLayers(VirtualLayer* const* layers, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += layers[i]->IsValid();
+    return sum;
+}
+
+template <typename Fn> double NsPerPacket(const std::vector<std::vector<uint8_t>>& frames, Fn fn) {
+    constexpr int Iterations = 1000;
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < Iterations; ++it)
+        for (const auto& f : frames)
+            fn(f.data(), f.size());
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (double(Iterations) * frames.size());
+}
+} // namespace
+
+int main() {
+    auto frames = MakeFrames(4096);
+    uint64_t sink = 0;
+
+    double direct = NsPerPacket(frames, [&](const uint8_t* data, size_t len) {
+        libpkt::EthernetFrame eth(data, len);
+        if (!eth.IsValid())
+            return;
+        libpkt::IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+        if (!ip.IsValid() || ip.FragmentOffset() != 0)
+            return;
+        if (ip.GetProtocol() == libpkt::Protocol::TCP) {
+            libpkt::tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+            sink += tcp.SrcPort() + tcp.DstPort() + tcp.Flags();
+        } else {
+            libpkt::udp::Packet udp(ip.Payload(), ip.PayloadLength());
+            sink += udp.SrcPort() + udp.DstPort();
+        }
+    });
+
+    double layered = NsPerPacket(frames, [&](const uint8_t* data, size_t len) {
+        libpkt::Layer layers[libpkt::MaxLayers];
+        size_t n = libpkt::DecodeLayers(data, len, layers);
+        for (size_t i = 0; i < n; ++i)
+            sink += libpkt::IsValid(layers[i]);
+    });
+
+    double virtualized = NsPerPacket(frames, [&](const uint8_t* data, size_t len) {
+        VirtualStack stack;
+        DecodeVirtual(data, len, stack);
+        sink += SumLayers(stack.Layers(), stack.Count());
+    });
+
+    std::cout << "direct:  " << direct << " ns/packet\n"
+              << "layered: " << layered << " ns/packet\n"
+              << "virtual: " << virtualized << " ns/packet (baseline)\n"
+              << "(checksum " << sink << ")\n";
+    return 0;
+}
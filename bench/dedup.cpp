@@ -0,0 +1,165 @@
+#include "libpkt/dedup.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/utils/checksum.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Inject mirrored copies into a capture the way a SPAN port would produce
+// them: each copy shows up to 500 us late (or 50 us early, from another
+// tap), has the TTL decremented with a fixed-up checksum, new MACs, and half
+// the time an extra VLAN tag. Then compare Deduplicator against an exact
+// reference that remembers the full normalized content of every frame, and
+// measure its throughput. [speedup] compresses the capture's timeline to
+// put more frames inside one window.
+
+namespace {
+constexpr uint64_t WindowNs = 5'000'000;
+
+struct Frame {
+    std::vector<uint8_t> bytes;
+    uint64_t timestamp_ns;
+    bool injected;
+};
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Frame MirrorCopy(const libpkt::FrameView& original, std::mt19937_64& rng) {
+    Frame copy{{original.data, original.data + original.length}, original.timestamp_ns, true};
+    std::vector<uint8_t>& b = copy.bytes;
+    int64_t delay = static_cast<int64_t>(rng() % 550'000) - 50'000;
+    copy.timestamp_ns += delay;
+    if (b.size() >= 34 && b[12] == 0x08 && b[13] == 0x00 && b[22] > 1) {
+        // Routed copy: new MACs, TTL one lower, header checksum recomputed.
+        for (int i = 0; i < 12; ++i)
+            b[i] ^= 0x5A;
+        b[0] &= 0xFE;
+        --b[22];
+        b[24] = b[25] = 0;
+        uint16_t sum = libpkt::checksum::IPChecksum(b.data() + 14, (b[14] & 0x0F) * 4);
+        std::memcpy(b.data() + 24, &sum, 2);
+    }
+    if (rng() & 1) {
+        const uint8_t tag[4] = {0x81, 0x00, 0x00, static_cast<uint8_t>(rng() % 4094 + 1)};
+        b.insert(b.begin() + 12, tag, tag + 4);
+    }
+    return copy;
+}
+
+// What the hash is meant to cover, byte for byte.
+std::string Normalize(const std::vector<uint8_t>& b) {
+    if (b.size() < 14)
+        return std::string(b.begin(), b.end());
+    size_t offset = 12;
+    while ((b[offset] == 0x81 && b[offset + 1] == 0x00) && offset + 6 <= b.size())
+        offset += 4;
+    uint16_t type = static_cast<uint16_t>(b[offset] << 8 | b[offset + 1]);
+    offset += 2;
+    if (type == 0x0800 && b.size() - offset >= 20 && (b[offset] >> 4) == 4 &&
+        (b[offset] & 0x0F) >= 5 && b.size() - offset >= (b[offset] & 0x0F) * 4u) {
+        size_t header = (b[offset] & 0x0F) * 4;
+        size_t total = std::min<size_t>(
+            std::max<size_t>(b[offset + 2] << 8 | b[offset + 3], header), b.size() - offset);
+        std::string s(b.begin() + offset, b.begin() + offset + total);
+        s[8] = s[10] = s[11] = 0;
+        return "4" + s;
+    }
+    std::string s(b.begin(), b.begin() + 12);
+    s += static_cast<char>(type >> 8);
+    s += static_cast<char>(type);
+    s.append(b.begin() + offset, b.end());
+    return "e" + s;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap> [speedup]\n";
+        return 1;
+    }
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    const double speedup = argc == 3 ? std::atof(argv[2]) : 1.0;
+    std::mt19937_64 rng(42);
+    std::vector<Frame> stream;
+    libpkt::FrameView f;
+    uint64_t first = 0;
+    while (reader.Next(f)) {
+        if (first == 0)
+            first = f.timestamp_ns;
+        f.timestamp_ns = first + static_cast<uint64_t>((f.timestamp_ns - first) / speedup);
+        stream.push_back({{f.data, f.data + f.length}, f.timestamp_ns, false});
+        int copies = rng() % 4 == 0 ? 2 : (rng() % 2);
+        for (int i = 0; i < copies; ++i)
+            stream.push_back(MirrorCopy(f, rng));
+    }
+    std::stable_sort(stream.begin(), stream.end(), [](const Frame& a, const Frame& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+    std::vector<libpkt::FrameView> views;
+    uint64_t injected = 0;
+    for (const auto& frame : stream) {
+        views.push_back({frame.bytes.data(), frame.bytes.size(), frame.timestamp_ns});
+        injected += frame.injected;
+    }
+
+    // Exact reference with the same first-copy-wins window semantics, on the
+    // table's 1.024 us clock so frames right at the window edge agree.
+    const uint64_t windowTicks = (WindowNs + 1023) >> 10;
+    std::vector<bool> expected(views.size());
+    std::unordered_map<std::string, uint64_t> seen;
+    for (size_t i = 0; i < views.size(); ++i) {
+        uint64_t t = views[i].timestamp_ns >> 10;
+        auto [it, fresh] = seen.emplace(Normalize(stream[i].bytes), t);
+        uint64_t age = t > it->second ? t - it->second : it->second - t;
+        expected[i] = !fresh && age <= windowTicks;
+        if (!fresh && !expected[i])
+            it->second = t;
+    }
+
+    for (size_t capacity : {size_t(1) << 10, size_t(1) << 16}) {
+        libpkt::Deduplicator::Config config;
+        config.capacity = capacity;
+        config.window_ns = WindowNs;
+        libpkt::Deduplicator dedup(config);
+        uint64_t falsePositives = 0, misses = 0, dropped = 0;
+        for (size_t i = 0; i < views.size(); ++i) {
+            bool duplicate = dedup.IsDuplicate(views[i]);
+            dropped += duplicate;
+            falsePositives += duplicate && !expected[i];
+            misses += !duplicate && expected[i];
+        }
+        const auto stats = dedup.GetStats();
+
+        const int rounds = 5;
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sink = 0;
+        for (int r = 0; r < rounds; ++r) {
+            dedup.Clear();
+            for (const auto& view : views)
+                sink += dedup.IsDuplicate(view);
+        }
+        double mpps = rounds * views.size() / Seconds(start) / 1e6;
+
+        std::cout << "capacity=" << capacity << " frames=" << views.size()
+                  << " injected=" << injected << " dropped=" << dropped
+                  << " expected=" << std::count(expected.begin(), expected.end(), true)
+                  << " false_positives=" << falsePositives << " misses=" << misses
+                  << " evictions=" << stats.evictions << " Mpps=" << mpps << (sink == 0 ? " " : "")
+                  << "\n";
+    }
+    return 0;
+}
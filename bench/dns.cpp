@@ -0,0 +1,202 @@
+#include "libpkt/dns.hpp"
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/udp.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Parse every DNS message (UDP port 53) of a pcap: query name, type, rcode
+// and answer addresses, as a sensor would, and report the cost per message.
+// The checksum keeps the work from being optimized away.
+//
+// First, a built-in response and the first messages of the pcap are fuzzed:
+// cut at every length, with compression pointers planted at every offset
+// (backwards, forwards, self-referencing) and with random byte damage. Each
+// variant sits in its own buffer, so running under ASan catches any read
+// past the message; decoded names are checked for length and termination.
+//
+//   bench_dns [file.pcap]
+
+namespace {
+using Bytes = std::vector<uint8_t>;
+
+void PutName(Bytes& b, const char* name) {
+    while (*name != 0) {
+        const char* dot = std::strchr(name, '.');
+        const size_t label = dot != nullptr ? dot - name : std::strlen(name);
+        b.push_back(static_cast<uint8_t>(label));
+        b.insert(b.end(), name, name + label);
+        name += label + (dot != nullptr);
+    }
+    b.push_back(0);
+}
+
+void Put16(Bytes& b, uint16_t value) {
+    b.push_back(static_cast<uint8_t>(value >> 8));
+    b.push_back(static_cast<uint8_t>(value));
+}
+
+// www.example.com A: a CNAME and two A and one AAAA answer, all with
+// compressed owner names.
+Bytes SampleResponse() {
+    Bytes b = {0x12, 0x34, 0x81, 0x80, 0, 1, 0, 4, 0, 0, 0, 0};
+    PutName(b, "www.example.com");
+    Put16(b, 1);
+    Put16(b, 1);
+    auto answer = [&](uint16_t owner, uint16_t type, const Bytes& rdata) {
+        Put16(b, static_cast<uint16_t>(0xC000 | owner));
+        Put16(b, type);
+        Put16(b, 1);
+        b.insert(b.end(), {0, 0, 0x0E, 0x10});
+        Put16(b, static_cast<uint16_t>(rdata.size()));
+        b.insert(b.end(), rdata.begin(), rdata.end());
+    };
+    Bytes cname = {3, 'c', 'd', 'n', 0xC0, 16}; // cdn.example.com
+    answer(12, 5, cname);
+    const uint16_t target = static_cast<uint16_t>(b.size() - cname.size());
+    answer(target, 1, {192, 0, 2, 1});
+    answer(target, 1, {192, 0, 2, 2});
+    answer(target, 28, {0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1});
+    return b;
+}
+
+// Decode everything a sensor would; false if a name broke its contract.
+bool DecodeAll(const Bytes& message, uint64_t& work) {
+    libpkt::dns::Packet dns(message.data(), message.size());
+    char name[libpkt::dns::MaxNameLength];
+    bool ok = true;
+    auto check = [&](ssize_t n) {
+        if (n < 0)
+            return;
+        ok &= static_cast<size_t>(n) < sizeof(name) && std::strlen(name) == static_cast<size_t>(n);
+        work += static_cast<uint64_t>(n);
+    };
+    libpkt::dns::Record rr;
+    auto reader = dns.Records();
+    while (reader.Next(rr)) {
+        check(dns.Name(rr.name_offset, name, sizeof(name)));
+        if (rr.rdata != nullptr) {
+            ok &= rr.rdata >= message.data() &&
+                  rr.rdata + rr.rdata_length <= message.data() + message.size();
+            for (uint16_t i = 0; i < rr.rdata_length; ++i)
+                work += rr.rdata[i];
+        }
+    }
+    check(dns.QueryName(name, sizeof(name)));
+    uint8_t v4[8][4];
+    uint8_t v6[8][16];
+    work += dns.AnswerIPv4(v4, 8) + dns.AnswerIPv6(v6, 8) + dns.QueryType();
+    work += dns.Summary().size();
+    return ok;
+}
+
+// Returns the number of variants whose decoded names broke the contract.
+uint64_t Fuzz(const Bytes& message, std::mt19937& rng, uint64_t& variants, uint64_t& work) {
+    uint64_t bad = 0;
+    auto run = [&](const Bytes& variant) {
+        ++variants;
+        bad += !DecodeAll(variant, work);
+    };
+    for (size_t cut = 0; cut <= message.size(); ++cut)
+        run(Bytes(message.begin(), message.begin() + cut));
+    for (size_t at = libpkt::dns::Packet::HeaderSize; at + 1 < message.size(); ++at) {
+        // Pointers to the start, to themselves, forwards and at random.
+        const uint16_t targets[] = {12, static_cast<uint16_t>(at),
+                                    static_cast<uint16_t>(at + 2),
+                                    static_cast<uint16_t>(rng() & 0x3FFF)};
+        for (uint16_t target : targets) {
+            Bytes variant = message;
+            variant[at] = static_cast<uint8_t>(0xC0 | target >> 8);
+            variant[at + 1] = static_cast<uint8_t>(target);
+            run(variant);
+        }
+    }
+    for (int i = 0; i < 256; ++i) {
+        Bytes variant = message;
+        for (int k = 1 + static_cast<int>(rng() % 4); k > 0; --k)
+            variant[rng() % variant.size()] = static_cast<uint8_t>(rng());
+        run(variant);
+    }
+    return bad;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    libpkt::PcapReader reader;
+    if (argc > 1 && !reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Locate the DNS payloads up front so only DNS parsing is timed.
+    std::vector<libpkt::FrameView> frames;
+    if (argc > 1)
+        reader.ReadBatch(frames, SIZE_MAX);
+    std::vector<std::pair<const uint8_t*, size_t>> messages;
+    for (const auto& f : frames) {
+        libpkt::EthernetFrame eth(f.data, f.length);
+        if (!eth.IsValid() || eth.Ethertype() != libpkt::EtherType::IPv4)
+            continue;
+        libpkt::IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+        if (!ip.IsValid() || ip.GetProtocol() != libpkt::Protocol::UDP)
+            continue;
+        libpkt::udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        if (udp.IsValid() && (udp.SrcPort() == 53 || udp.DstPort() == 53))
+            messages.emplace_back(udp.Payload(), udp.PayloadLength());
+    }
+
+    std::mt19937 rng(53);
+    uint64_t variants = 0, broken = 0, work = 0;
+    broken += Fuzz(SampleResponse(), rng, variants, work);
+    for (size_t i = 0; i < messages.size() && i < 64; ++i) {
+        const auto& [data, length] = messages[i];
+        broken += Fuzz(Bytes(data, data + length), rng, variants, work);
+    }
+    std::cout << "fuzz variants=" << variants << " broken=" << broken << "\n";
+    if (messages.empty())
+        return broken == 0 ? 0 : 1;
+
+    const int rounds = 5;
+    uint64_t checksum = 0, malformed = 0, addresses = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& [data, length] : messages) {
+            libpkt::dns::Packet dns(data, length);
+            libpkt::dns::Record rr;
+            char name[libpkt::dns::MaxNameLength];
+            auto reader = dns.Records();
+            if (!reader.Next(rr) || dns.Name(rr.name_offset, name, sizeof(name)) < 0) {
+                ++malformed;
+                continue;
+            }
+            checksum += static_cast<uint64_t>(rr.type) * 31 + name[0];
+            if (!dns.IsResponse())
+                continue;
+            checksum += static_cast<uint64_t>(dns.GetRCode());
+
+            // One pass over the answers for both address families.
+            while (reader.Next(rr) && rr.section == libpkt::dns::Section::Answer) {
+                if ((rr.type == static_cast<uint16_t>(libpkt::dns::Type::A) &&
+                     rr.rdata_length == 4) ||
+                    (rr.type == static_cast<uint16_t>(libpkt::dns::Type::AAAA) &&
+                     rr.rdata_length == 16)) {
+                    checksum += rr.rdata[rr.rdata_length - 1];
+                    ++addresses;
+                }
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double total = static_cast<double>(messages.size()) * rounds;
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / total;
+    std::cout << "messages=" << messages.size() << " malformed=" << malformed / rounds
+              << " addresses=" << addresses / rounds << " ns/message=" << ns << " checksum=0x"
+              << std::hex << checksum << "\n";
+    return broken == 0 ? 0 : 1;
+}
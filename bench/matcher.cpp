@@ -0,0 +1,147 @@
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/matcher.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Scan TCP/UDP payloads for 10, 1k and 10k patterns and report throughput.
+// One pattern in ten is taken from the payloads themselves, the rest are
+// random strings, so matches do occur. Without a pcap, synthetic
+// HTTP-like text is scanned instead. memmem per pattern is the baseline
+// for the small set.
+
+namespace {
+void CountMatch(uint32_t, uint64_t, void* count) {
+    ++*static_cast<uint64_t*>(count);
+}
+
+std::vector<std::string> MakePatterns(size_t count, const std::vector<std::string>& payloads,
+                                      std::mt19937& rng) {
+    std::vector<std::string> patterns;
+    while (patterns.size() < count) {
+        size_t length = 6 + rng() % 11;
+        std::string p;
+        const std::string& src = payloads[rng() % payloads.size()];
+        if (patterns.size() % 10 == 0 && src.size() > length) {
+            p = src.substr(rng() % (src.size() - length), length);
+        } else {
+            for (size_t i = 0; i < length; ++i)
+                p += static_cast<char>('a' + rng() % 26);
+        }
+        patterns.push_back(p);
+    }
+    return patterns;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::mt19937 rng(42);
+    std::vector<std::string> payloads;
+    libpkt::PcapReader reader;
+    if (argc == 2 && reader.Open(argv[1])) {
+        libpkt::FrameView f;
+        while (reader.Next(f)) {
+            libpkt::EthernetFrame eth(f.data, f.length);
+            if (!eth.IsValid() || eth.Ethertype() != libpkt::EtherType::IPv4)
+                continue;
+            libpkt::IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+            if (!ip.IsValid())
+                continue;
+            const uint8_t* data = nullptr;
+            size_t length = 0;
+            if (ip.GetProtocol() == libpkt::Protocol::TCP) {
+                libpkt::tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+                data = tcp.Payload();
+                length = tcp.PayloadLength();
+            } else if (ip.GetProtocol() == libpkt::Protocol::UDP) {
+                libpkt::udp::Packet udp(ip.Payload(), ip.PayloadLength());
+                data = udp.Payload();
+                length = udp.PayloadLength();
+            }
+            if (length != 0)
+                payloads.emplace_back(reinterpret_cast<const char*>(data), length);
+        }
+    } else if (argc == 2) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    } else {
+        const char* words[] = {"GET", "POST", "/index.html", "Host:", "example.com", "User-Agent:",
+                               "Mozilla/5.0", "Accept:", "text/html", "Cookie:", "session=",
+                               "Content-Length:", "\r\n", " ", "application/json", "{\"id\":"};
+        for (int i = 0; i < 20000; ++i) {
+            std::string p;
+            while (p.size() < 200 + rng() % 1200) {
+                p += words[rng() % std::size(words)];
+                p += std::to_string(rng() % 1000);
+            }
+            payloads.push_back(p);
+        }
+    }
+    size_t total = 0;
+    for (const auto& p : payloads)
+        total += p.size();
+    std::cout << "payloads=" << payloads.size() << " bytes=" << total << "\n";
+
+    for (size_t count : {10, 1000, 10000}) {
+        auto patterns = MakePatterns(count, payloads, rng);
+        for (bool prefilter : {true, false}) {
+            if (prefilter && count > libpkt::match::Matcher::Config{}.prefilter_max_patterns)
+                continue;
+            libpkt::match::Matcher::Config config;
+            if (!prefilter)
+                config.prefilter_max_patterns = 0;
+            libpkt::match::Matcher matcher(config);
+            for (const auto& p : patterns)
+                matcher.Add(p);
+            auto compileStart = std::chrono::steady_clock::now();
+            matcher.Compile();
+            auto compileEnd = std::chrono::steady_clock::now();
+
+            uint64_t matches = 0;
+            const int rounds = 3;
+            auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds; ++round) {
+                for (const auto& p : payloads)
+                    matcher.Scan(reinterpret_cast<const uint8_t*>(p.data()), p.size(), CountMatch,
+                                 &matches);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double sec = std::chrono::duration<double>(end - start).count();
+            double compileMs =
+                std::chrono::duration<double, std::milli>(compileEnd - compileStart).count();
+            std::cout << "patterns=" << count << " prefilter=" << matcher.UsesPrefilter()
+                      << " dfa=" << matcher.UsesDFA() << " states=" << matcher.StateCount()
+                      << " compile_ms=" << compileMs << " matches=" << matches / rounds
+                      << " GB/s=" << total * rounds / sec / 1e9 << "\n";
+        }
+
+        if (count == 10) {
+            uint64_t matches = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& p : payloads) {
+                for (const auto& pattern : patterns) {
+                    const char* at = p.data();
+                    const char* last = p.data() + p.size();
+                    const void* hit;
+                    while ((hit = memmem(at, last - at, pattern.data(), pattern.size()))) {
+                        ++matches;
+                        at = static_cast<const char*>(hit) + 1;
+                    }
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            double sec = std::chrono::duration<double>(end - start).count();
+            std::cout << "patterns=10 memmem matches=" << matches << " GB/s=" << total / sec / 1e9
+                      << "\n";
+        }
+    }
+    return 0;
+}
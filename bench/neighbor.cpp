@@ -0,0 +1,147 @@
+#include "libpkt/neighbor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Lookups per second from N reader threads while one writer keeps
+// refreshing bindings, as decoder threads would against an ARP learner.
+// Compares NeighborCache with an unordered_map behind a mutex and behind a
+// shared_mutex. Scaling past the machine's core count is not meaningful.
+
+namespace {
+constexpr uint32_t Hosts = 2000;
+constexpr auto Duration = std::chrono::milliseconds(500);
+
+uint32_t HostIP(uint32_t i) {
+    return 0x0A000000 | (i + 1);
+}
+
+void HostMAC(uint32_t i, uint8_t* mac) {
+    const uint8_t base[6] = {0x02, 0, 0, 0, 0, 0};
+    std::memcpy(mac, base, 6);
+    std::memcpy(mac + 2, &i, 4);
+}
+
+struct MutexMap {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, uint64_t> map;
+
+    void Update(uint32_t ip, uint64_t mac) {
+        std::lock_guard<std::mutex> lock(mutex);
+        map[ip] = mac;
+    }
+    bool Lookup(uint32_t ip, uint64_t& mac) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = map.find(ip);
+        if (it == map.end())
+            return false;
+        mac = it->second;
+        return true;
+    }
+};
+
+struct SharedMap {
+    std::shared_mutex mutex;
+    std::unordered_map<uint32_t, uint64_t> map;
+
+    void Update(uint32_t ip, uint64_t mac) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        map[ip] = mac;
+    }
+    bool Lookup(uint32_t ip, uint64_t& mac) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = map.find(ip);
+        if (it == map.end())
+            return false;
+        mac = it->second;
+        return true;
+    }
+};
+
+// Runs `readers` threads calling lookup(ip) and one calling update(i)
+// until Duration elapses; returns lookups per second.
+template <typename Lookup, typename Update>
+double Run(int readers, Lookup lookup, Update update) {
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> total(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            uint64_t count = 0, found = 0;
+            uint32_t x = 12345 + t;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int n = 0; n < 256; ++n) {
+                    x = x * 1664525 + 1013904223;
+                    found += lookup(HostIP(x % Hosts));
+                }
+                count += 256;
+            }
+            total += count + (found == 0);
+        });
+    }
+    threads.emplace_back([&] {
+        for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i = (i + 1) % Hosts)
+            update(i);
+    });
+    std::this_thread::sleep_for(Duration);
+    stop = true;
+    for (auto& t : threads)
+        t.join();
+    return total / std::chrono::duration<double>(Duration).count();
+}
+} // namespace
+
+int main() {
+    libpkt::arp::NeighborCache cache;
+    MutexMap mutexMap;
+    SharedMap sharedMap;
+    for (uint32_t i = 0; i < Hosts; ++i) {
+        uint8_t mac[6];
+        HostMAC(i, mac);
+        cache.Update(HostIP(i), mac, 1);
+        uint64_t packed = 0;
+        std::memcpy(&packed, mac, 6);
+        mutexMap.Update(HostIP(i), packed);
+        sharedMap.Update(HostIP(i), packed);
+    }
+    std::cout << "hardware threads=" << std::thread::hardware_concurrency() << "\n";
+
+    uint64_t now = 2;
+    for (int readers : {1, 2, 4, 8}) {
+        double seqlock = Run(
+            readers,
+            [&](uint32_t ip) {
+                uint8_t mac[6];
+                return cache.Lookup(ip, mac);
+            },
+            [&](uint32_t i) {
+                uint8_t mac[6];
+                HostMAC(i, mac);
+                cache.Update(HostIP(i), mac, now++);
+            });
+        double mutex = Run(
+            readers,
+            [&](uint32_t ip) {
+                uint64_t mac;
+                return mutexMap.Lookup(ip, mac);
+            },
+            [&](uint32_t i) { mutexMap.Update(HostIP(i), i); });
+        double shared = Run(
+            readers,
+            [&](uint32_t ip) {
+                uint64_t mac;
+                return sharedMap.Lookup(ip, mac);
+            },
+            [&](uint32_t i) { sharedMap.Update(HostIP(i), i); });
+        std::cout << "readers=" << readers << " Mlookups/s: seqlock=" << seqlock / 1e6
+                  << " mutex=" << mutex / 1e6 << " shared_mutex=" << shared / 1e6 << "\n";
+    }
+    return 0;
+}
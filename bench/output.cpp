@@ -0,0 +1,75 @@
+#include "libpkt/layer.hpp"
+#include "libpkt/output.hpp"
+#include "libpkt/pcap.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Write a summary line per frame of a pcap to /dev/null: first the way the
+// examples used to (Summary() strings and std::endl on an ofstream), then
+// through output::Sink in each format, synchronously and with the
+// background writer. Reports millions of records per second.
+
+namespace {
+template <typename Fn> void Report(const char* name, size_t frames, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    std::cout << name << ": " << frames / sec / 1e6 << " Mpps\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap>\n";
+        return 1;
+    }
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<libpkt::FrameView> frames;
+    reader.ReadBatch(frames, SIZE_MAX);
+    std::cout << "frames=" << frames.size() << "\n";
+
+    Report("ostream+endl", frames.size(), [&] {
+        std::ofstream out("/dev/null");
+        libpkt::Layer layers[libpkt::MaxLayers];
+        for (const auto& f : frames) {
+            size_t count = libpkt::DecodeLayers(f.data, f.length, layers);
+            out << f.timestamp_ns;
+            for (size_t i = 0; i < count; ++i)
+                out << " | " << libpkt::Summary(layers[i]);
+            out << std::endl;
+        }
+    });
+
+    const std::pair<const char*, libpkt::output::Format> formats[] = {
+        {"text", libpkt::output::Format::Text},
+        {"json", libpkt::output::Format::JSON},
+        {"csv", libpkt::output::Format::CSV},
+    };
+    for (bool async : {false, true}) {
+        for (const auto& [name, format] : formats) {
+            libpkt::output::Sink::Config config;
+            config.format = format;
+            config.async = async;
+            libpkt::output::Sink sink(config);
+            std::string label = std::string(async ? "async " : "sync ") + name;
+            Report(label.c_str(), frames.size(), [&] {
+                sink.Open("/dev/null");
+                for (const auto& f : frames)
+                    sink.Write(f);
+                sink.Close();
+            });
+            auto stats = sink.GetStats();
+            std::cout << "  bytes=" << stats.bytes << " writes=" << stats.writes
+                      << " stalls=" << stats.stalls << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "libpkt/interface.hpp"
+#include "libpkt/replay.hpp"
+#include "libpkt/ring.hpp"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// N analysis processes reading the same traffic, either each through its own
+// AF_PACKET socket or through one capture process feeding a shared-memory
+// ring. A capture is replayed at top speed on <tx> and received on <rx>
+// (e.g. the two ends of a veth pair); reported are the frames each consumer
+// saw, the CPU time of all receiving processes together, and that of the
+// sender, which on veth pays for delivering a copy to every socket.
+//
+//   bench_ring <file.pcap> <tx> <rx> [consumers]
+
+namespace {
+const char* RingPath = "/dev/shm/libpkt-bench-ring";
+
+std::atomic<bool> running(true);
+
+void signal_handler(int) {
+    running = false;
+}
+
+// Child: run `body`, report its frame count through `fd`, and exit.
+template <typename Body>
+pid_t Spawn(int fd, Body body) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::signal(SIGTERM, signal_handler);
+        uint64_t frames = body();
+        (void)!write(fd, &frames, sizeof(frames));
+        _exit(0);
+    }
+    return pid;
+}
+
+uint64_t SocketConsumer(const char* iface) {
+    libpkt::Interface rx(iface);
+    if (!rx.Open(true))
+        return 0;
+    int size = 64 << 20;
+    setsockopt(rx.Fd(), SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size));
+    libpkt::PacketBatch batch;
+    uint64_t frames = 0, sum = 0;
+    while (running) {
+        if (rx.ReceiveBatch(batch) <= 0) {
+            usleep(100);
+            continue;
+        }
+        for (const auto& frame : batch)
+            sum += frame.data[frame.length - 1];
+        frames += batch.Size();
+    }
+    return frames + (sum == 1);
+}
+
+uint64_t RingProducer(const char* iface, int ready) {
+    libpkt::ring::Producer::Config config;
+    config.policy = libpkt::ring::Policy::Overwrite;
+    libpkt::ring::Producer producer(config);
+    libpkt::Interface rx(iface);
+    char ok = producer.Create(RingPath) && rx.Open(true);
+    (void)!write(ready, &ok, 1);
+    int size = 64 << 20;
+    setsockopt(rx.Fd(), SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size));
+    libpkt::PacketBatch batch;
+    while (ok && running) {
+        if (rx.ReceiveBatch(batch) <= 0) {
+            usleep(100);
+            continue;
+        }
+        producer.Write(batch.Frames());
+    }
+    return producer.GetStats().frames;
+}
+
+uint64_t RingConsumer() {
+    libpkt::ring::Consumer consumer;
+    if (!consumer.Attach(RingPath))
+        return 0;
+    std::vector<libpkt::FrameView> frames;
+    uint64_t sum = 0;
+    while (running) {
+        if (consumer.NextBatch(frames, 64) == 0) {
+            consumer.Wait(100);
+            continue;
+        }
+        for (const auto& frame : frames)
+            sum += frame.data[frame.length - 1];
+    }
+    return consumer.GetStats().frames + (sum == 1);
+}
+
+struct Result {
+    std::vector<uint64_t> frames; // per consumer
+    double cpu = 0;               // all receiving processes
+    double sender_cpu = 0;        // includes the kernel's per-socket delivery on veth
+};
+
+double CpuSeconds(const struct rusage& ru) {
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+template <typename Start>
+Result Run(const char* pcap, const char* tx, Start start) {
+    int fds[2];
+    if (pipe(fds) < 0)
+        return {};
+    std::vector<pid_t> children = start(fds[1]);
+    usleep(300000);
+
+    Result result;
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    libpkt::Interface out(tx);
+    if (out.Open()) {
+        libpkt::Replayer::Config config;
+        config.mode = libpkt::Replayer::Mode::TopSpeed;
+        libpkt::Replayer replayer(out, config);
+        replayer.Run(pcap);
+    }
+    getrusage(RUSAGE_SELF, &after);
+    result.sender_cpu = CpuSeconds(after) - CpuSeconds(before);
+    usleep(500000);
+
+    for (pid_t pid : children) {
+        kill(pid, SIGTERM);
+        int status;
+        struct rusage ru;
+        wait4(pid, &status, 0, &ru);
+        result.cpu += CpuSeconds(ru);
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+        uint64_t frames = 0;
+        if (read(fds[0], &frames, sizeof(frames)) == sizeof(frames))
+            result.frames.push_back(frames);
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return result;
+}
+
+void Print(const char* name, const Result& result, size_t consumers) {
+    std::cout << name << ": cpu=" << result.cpu << "s sender_cpu=" << result.sender_cpu
+              << "s frames per process:";
+    for (uint64_t frames : result.frames)
+        std::cout << " " << frames;
+    std::cout << " (" << consumers << " consumers)\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap> <tx> <rx> [consumers]\n";
+        return 1;
+    }
+    const char* rxName = argv[3];
+    const size_t consumers = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4;
+
+    Result sockets = Run(argv[1], argv[2], [&](int fd) {
+        std::vector<pid_t> pids;
+        for (size_t i = 0; i < consumers; ++i)
+            pids.push_back(Spawn(fd, [&] { return SocketConsumer(rxName); }));
+        return pids;
+    });
+    Print("sockets", sockets, consumers);
+
+    Result ring = Run(argv[1], argv[2], [&](int fd) {
+        int ready[2];
+        std::vector<pid_t> pids;
+        if (pipe(ready) < 0)
+            return pids;
+        pids.push_back(Spawn(fd, [&] { return RingProducer(rxName, ready[1]); }));
+        char ok = 0;
+        if (read(ready[0], &ok, 1) == 1 && ok) {
+            for (size_t i = 0; i < consumers; ++i)
+                pids.push_back(Spawn(fd, [] { return RingConsumer(); }));
+        }
+        close(ready[0]);
+        close(ready[1]);
+        return pids;
+    });
+    Print("ring (producer first)", ring, consumers);
+    return 0;
+}
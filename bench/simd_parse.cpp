@@ -0,0 +1,98 @@
+#include "libpkt/pcap.hpp"
+#include "libpkt/simd_parse.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Header-parsing cost per frame for each available kernel, on synthetic
+// traffic mixes or on a pcap file given as the first argument.
+
+namespace {
+struct Mix {
+    const char* name;
+    int tcp, udp, other; // percentages
+};
+
+std::vector<std::vector<uint8_t>> MakeFrames(const Mix& mix, size_t count) {
+    std::mt19937 rng(11);
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t i = 0; i < count; ++i) {
+        int pick = static_cast<int>(rng() % 100);
+        std::vector<uint8_t> f(pick < mix.tcp + mix.udp ? 60 + rng() % 1400 : 42 + rng() % 40);
+        for (auto& b : f)
+            b = static_cast<uint8_t>(rng());
+        if (pick < mix.tcp + mix.udp) {
+            size_t total = f.size() - 14;
+            f[12] = 0x08;
+            f[13] = 0x00;
+            f[14] = 0x45;
+            f[16] = static_cast<uint8_t>(total >> 8);
+            f[17] = static_cast<uint8_t>(total);
+            f[23] = pick < mix.tcp ? 6 : 17;
+        } else {
+            f[12] = 0x08;
+            f[13] = 0x06; // ARP
+        }
+        frames.push_back(std::move(f));
+    }
+    return frames;
+}
+
+void Run(const char* name, const std::vector<libpkt::FrameView>& views) {
+    using libpkt::simd::Level;
+    std::cout << name << ":";
+    for (Level level : {Level::Scalar, Level::AVX2, Level::AVX512}) {
+        if (level > libpkt::simd::DetectLevel())
+            break;
+        constexpr int Iterations = 200;
+        uint64_t sink = 0;
+        libpkt::simd::HeaderLanes lanes;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < Iterations; ++it) {
+            for (size_t i = 0; i < views.size(); i += libpkt::simd::MaxLanes) {
+                size_t n = std::min(libpkt::simd::MaxLanes, views.size() - i);
+                libpkt::simd::ParseHeaders(level, views.data() + i, n, lanes);
+                sink += lanes.tcp_valid + lanes.udp_valid;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() /
+                    (double(Iterations) * views.size());
+        const char* label = level == Level::Scalar ? "scalar"
+                            : level == Level::AVX2 ? "avx2"
+                                                   : "avx512";
+        std::cout << "  " << label << "=" << ns << "ns";
+        if (sink == 0)
+            std::cout << "(no L4)";
+    }
+    std::cout << "\n";
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        libpkt::PcapReader reader;
+        if (!reader.Open(argv[1])) {
+            std::cerr << "Failed to open " << argv[1] << "\n";
+            return 1;
+        }
+        std::vector<libpkt::FrameView> views;
+        reader.ReadBatch(views, SIZE_MAX);
+        Run(argv[1], views);
+        return 0;
+    }
+
+    for (const Mix& mix : {Mix{"tcp-only", 100, 0, 0}, Mix{"web (80/15/5)", 80, 15, 5},
+                           Mix{"dns-heavy (20/75/5)", 20, 75, 5}}) {
+        auto frames = MakeFrames(mix, 8192);
+        std::vector<libpkt::FrameView> views;
+        for (const auto& f : frames)
+            views.push_back({f.data(), f.size(), 0});
+        Run(mix.name, views);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "libpkt/flow.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/sketch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+// Feed a pcap through a TrafficSketch (split over two instances that are then
+// merged, as per-thread sketches would be) and compare against exact counts:
+// count-min error bound, space-saving bounds and top-20 recall, HyperLogLog
+// relative error, plus update throughput.
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap>\n";
+        return 1;
+    }
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<libpkt::FrameView> frames;
+    reader.ReadBatch(frames, SIZE_MAX);
+
+    using libpkt::sketch::TrafficSketch;
+    TrafficSketch::Config config;
+    TrafficSketch timed(config), even(config), odd(config);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& f : frames)
+        timed.Update(f.data, f.length);
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / frames.size();
+
+    std::map<uint32_t, uint64_t> packets, bytes;
+    std::set<uint64_t> distinct;
+    uint64_t total = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        libpkt::FlowKey key;
+        if (!libpkt::ExtractFlowKey(frames[i].data, frames[i].length, key))
+            continue;
+        (i & 1 ? odd : even).Update(key, static_cast<uint32_t>(frames[i].length));
+        packets[key.src_ip]++;
+        bytes[key.src_ip] += frames[i].length;
+        distinct.insert(uint64_t{key.dst_ip} << 16 | key.dst_port);
+        ++total;
+    }
+    even.Merge(odd);
+
+    const double bound = 2.0 * total / config.cm_width;
+    size_t under = 0, over = 0;
+    for (const auto& [ip, count] : packets) {
+        libpkt::FlowKey key{ip};
+        uint64_t estimate = even.EstimatePackets(key);
+        under += estimate < count;
+        over += estimate - count > bound;
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> exactTop;
+    for (const auto& [ip, count] : bytes)
+        exactTop.push_back({count, ip});
+    std::sort(exactTop.rbegin(), exactTop.rend());
+    auto top = even.TopTalkers();
+    std::set<uint32_t> tracked;
+    size_t boundViolations = 0;
+    for (const auto& e : top) {
+        tracked.insert(e.key.src_ip);
+        uint64_t exact = bytes[e.key.src_ip];
+        boundViolations += !(e.count - e.error <= exact && exact <= e.count);
+    }
+    size_t recall = 0, wanted = std::min<size_t>(20, exactTop.size());
+    for (size_t i = 0; i < wanted; ++i)
+        recall += tracked.count(exactTop[i].second);
+
+    double hllError =
+        (even.DistinctCount() - distinct.size()) / std::max<size_t>(distinct.size(), 1);
+
+    std::cout << "frames=" << frames.size() << " ipv4=" << total << " update=" << ns << "ns\n"
+              << "count-min: " << under << " underestimates, " << over
+              << " keys beyond 2N/w=" << bound << "\n"
+              << "space-saving: top-" << wanted << " recall " << recall << "/" << wanted << ", "
+              << boundViolations << " bound violations\n"
+              << "hyperloglog: " << even.DistinctCount() << " vs exact " << distinct.size() << " ("
+              << 100 * hllError << "%)\n";
+    return (under || boundViolations) ? 1 : 0;
+}
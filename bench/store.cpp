@@ -0,0 +1,135 @@
+#include "libpkt/flow.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/store.hpp"
+
+#include <chrono>
+#include <dirent.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Ingest a pcap into a store (replayed several times with shifted clocks so
+// there are many segments), then answer "host X between T1 and T2" and
+// "flow F" queries through the index and by scanning every segment with
+// PcapReader. Both run against a warm page cache, so the gap is the work
+// avoided, not disk time.
+
+namespace {
+void Count(const libpkt::FrameView&, void* count) {
+    ++*static_cast<uint64_t*>(count);
+}
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t LinearScan(const std::string& directory, const libpkt::store::Query& query) {
+    std::vector<std::string> files;
+    DIR* dir = opendir(directory.c_str());
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 5 && name.compare(name.size() - 5, 5, ".pcap") == 0)
+            files.push_back(directory + "/" + name);
+    }
+    closedir(dir);
+
+    uint64_t matches = 0;
+    for (const auto& file : files) {
+        libpkt::PcapReader reader;
+        if (!reader.Open(file))
+            continue;
+        libpkt::FrameView f;
+        while (reader.Next(f)) {
+            if (f.timestamp_ns < query.from_ns || f.timestamp_ns > query.to_ns)
+                continue;
+            libpkt::FlowKey key;
+            if (!libpkt::ExtractFlowKey(f.data, f.length, key))
+                continue;
+            if (query.has_host && key.src_ip != query.host && key.dst_ip != query.host)
+                continue;
+            if (query.has_flow && !(key == query.flow || key == query.flow.Reversed()))
+                continue;
+            ++matches;
+        }
+    }
+    return matches;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap> <new store directory>\n";
+        return 1;
+    }
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<libpkt::FrameView> frames;
+    reader.ReadBatch(frames, SIZE_MAX);
+    if (frames.empty())
+        return 1;
+    uint64_t first = frames.front().timestamp_ns, last = frames.back().timestamp_ns;
+    uint64_t span = last - first + 1;
+
+    const int replays = 10;
+    libpkt::store::Writer::Config config;
+    config.segment_bytes = 16 << 20;
+    libpkt::store::Writer writer(config);
+    if (!writer.Open(argv[2])) {
+        std::cerr << "Failed to open store " << argv[2] << "\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < replays; ++r) {
+        for (libpkt::FrameView f : frames) {
+            f.timestamp_ns += r * span;
+            writer.Append(f);
+        }
+    }
+    writer.Close();
+    double sec = Seconds(start);
+    const auto& ws = writer.GetStats();
+    std::cout << "ingest: packets=" << ws.packets << " segments=" << ws.segments
+              << " index_bytes=" << ws.index_bytes << " (" << 100.0 * ws.index_bytes / ws.bytes
+              << "% of data) Mpps=" << ws.packets / sec / 1e6
+              << " MB/s=" << ws.bytes / sec / 1e6 << "\n";
+
+    libpkt::store::Reader store;
+    store.Open(argv[2]);
+
+    libpkt::FlowKey sample;
+    libpkt::ExtractFlowKey(frames[frames.size() / 2].data, frames[frames.size() / 2].length,
+                           sample);
+    libpkt::store::Query queries[3];
+    queries[0].from_ns = first + replays * span / 2;
+    queries[0].to_ns = queries[0].from_ns + span / 10;
+    queries[0].has_host = true;
+    queries[0].host = sample.src_ip;
+    queries[1].has_host = true;
+    queries[1].host = sample.dst_ip;
+    queries[2].has_flow = true;
+    queries[2].flow = sample;
+    const char* names[] = {"host+time", "host", "flow"};
+
+    for (int q = 0; q < 3; ++q) {
+        const int rounds = 20;
+        uint64_t indexed = 0;
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+            store.Run(queries[q], Count, &indexed);
+        double indexedMs = Seconds(start) * 1e3 / rounds;
+        const auto& rs = store.GetStats();
+
+        start = std::chrono::steady_clock::now();
+        uint64_t linear = LinearScan(argv[2], queries[q]);
+        double linearMs = Seconds(start) * 1e3;
+
+        std::cout << names[q] << ": matches=" << indexed / rounds << " (scan " << linear
+                  << ") skipped_time=" << rs.skipped_time << " skipped_bloom="
+                  << rs.skipped_bloom << " candidates=" << rs.candidates
+                  << " index_ms=" << indexedMs << " scan_ms=" << linearMs << "\n";
+    }
+    return 0;
+}
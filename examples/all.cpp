@@ -77,21 +77,21 @@ int main(int argc, char* argv[]) {
             case libpkt::Protocol::TCP: {
                 libpkt::tcp::Packet tcpPkt(ipPkt.Payload(), ipPkt.PayloadLength());
                 if (tcpPkt.IsValid()) {
-                    std::cout << tcpPkt.Summary() << std::endl;
+                    std::cout << tcpPkt.Summary() << "\n";
                 }
                 break;
             }
             case libpkt::Protocol::UDP: {
                 libpkt::udp::Packet udpPkt(ipPkt.Payload(), ipPkt.PayloadLength());
                 if (udpPkt.IsValid()) {
-                    std::cout << udpPkt.Summary() << std::endl;
+                    std::cout << udpPkt.Summary() << "\n";
                 }
                 break;
             }
             case libpkt::Protocol::ICMP: {
                 libpkt::icmp::Packet icmpPkt(ipPkt.Payload(), ipPkt.PayloadLength());
                 if (icmpPkt.IsValid()) {
-                    std::cout << icmpPkt.Summary() << std::endl;
+                    std::cout << icmpPkt.Summary() << "\n";
                 }
                 break;
             }
@@ -104,7 +104,7 @@ int main(int argc, char* argv[]) {
         } else if (ethertype == libpkt::EtherType::ARP) {
             libpkt::arp::Packet arpPkt(ethFrame.Payload(), ethFrame.PayloadLength());
             if (arpPkt.IsValid()) {
-                std::cout << arpPkt.Summary() << std::endl;
+                std::cout << arpPkt.Summary() << "\n";
             }
         } else {
             std::cout << "Unhandled EtherType: 0x" << std::hex << static_cast<uint16_t>(ethertype)
@@ -0,0 +1,108 @@
+#include "libpkt/anonymize.hpp"
+#include "libpkt/pcap.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Write an anonymized copy of an Ethernet capture, ready to hand to a third
+// party: prefix-preserving IPv4/IPv6 addresses, scrambled MACs, and with
+// --snap only the first N transport payload bytes of each frame.
+//
+//   examples_anonymize <in.pcap> <out.pcap> [--key HEX32] [--snap N] [--keep-oui]
+//
+// Without --key a random key is used and printed, so later captures can be
+// anonymized consistently with the same mapping.
+
+namespace {
+bool ParseKey(const char* hex, std::array<uint8_t, 16>& key) {
+    if (std::strlen(hex) != 32)
+        return false;
+    for (size_t i = 0; i < 16; ++i) {
+        char byte[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char* end;
+        key[i] = static_cast<uint8_t>(std::strtoul(byte, &end, 16));
+        if (end != byte + 2)
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <in.pcap> <out.pcap> [--key HEX32] [--snap N] [--keep-oui]\n";
+        return 1;
+    }
+
+    libpkt::Anonymizer::Config config;
+    for (int i = 3; i < argc; ++i) {
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+        if (std::strcmp(argv[i], "--key") == 0) {
+            if (!ParseKey(value, config.key)) {
+                std::cerr << "--key takes 32 hex digits\n";
+                return 1;
+            }
+            ++i;
+        } else if (std::strcmp(argv[i], "--snap") == 0) {
+            config.max_payload = std::strtoul(value, nullptr, 10);
+            ++i;
+        } else if (std::strcmp(argv[i], "--keep-oui") == 0) {
+            config.keep_oui = true;
+        } else {
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+    if (reader.LinkType() != libpkt::PcapReader::LinkTypeEthernet) {
+        std::cerr << "Not an Ethernet capture\n";
+        return 1;
+    }
+    FILE* out = std::fopen(argv[2], "wb");
+    if (out == nullptr) {
+        std::cerr << "Failed to create " << argv[2] << "\n";
+        return 1;
+    }
+
+    libpkt::Anonymizer anonymizer(config);
+    // Nanosecond pcap, version 2.4, Ethernet.
+    const uint32_t header[6] = {0xA1B23C4D, 2 | (4u << 16), 0, 0, 262144, 1};
+    std::fwrite(header, sizeof(header), 1, out);
+    std::vector<uint8_t> buffer;
+    libpkt::FrameView frame;
+    while (reader.Next(frame)) {
+        buffer.assign(frame.data, frame.data + frame.length);
+        size_t length = anonymizer.Rewrite(buffer.data(), buffer.size());
+        const uint32_t record[4] = {static_cast<uint32_t>(frame.timestamp_ns / 1000000000ull),
+                                    static_cast<uint32_t>(frame.timestamp_ns % 1000000000ull),
+                                    static_cast<uint32_t>(length),
+                                    static_cast<uint32_t>(frame.length)};
+        std::fwrite(record, sizeof(record), 1, out);
+        std::fwrite(buffer.data(), 1, length, out);
+    }
+    bool ok = std::fclose(out) == 0;
+
+    const auto& stats = anonymizer.GetStats();
+    std::cout << "frames=" << stats.frames << " ipv4=" << stats.ipv4 << " ipv6=" << stats.ipv6
+              << " arp=" << stats.arp << " truncated=" << stats.truncated << "\n";
+    std::cout << "key=" << std::hex << std::setfill('0');
+    for (uint8_t b : anonymizer.Key())
+        std::cout << std::setw(2) << static_cast<int>(b);
+    std::cout << std::dec << "\n";
+    if (!ok) {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "libpkt/event_loop.hpp"
+#include "libpkt/interface.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <sys/resource.h>
+#include <vector>
+
+// Capture on several interfaces from one thread and report, every few
+// seconds, the wake-up latency (kernel receive timestamp -> coroutine resume)
+// and the CPU time consumed by the loop.
+
+namespace {
+std::atomic<bool> running(true);
+
+void signal_handler(int) {
+    running = false;
+}
+
+uint64_t NowNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+struct Stats {
+    std::vector<uint64_t> latencies;
+    uint64_t frames = 0;
+    uint64_t wakeups = 0;
+};
+
+libpkt::Task Capture(libpkt::Interface& iface, libpkt::EventLoop& loop, Stats& stats) {
+    libpkt::PacketBatch batch;
+    for (;;) {
+        ssize_t n = co_await iface.NextBatch(loop, batch);
+        if (n < 0) {
+            std::cerr << iface.Name() << ": receive error\n";
+            co_return;
+        }
+        uint64_t now = NowNs(CLOCK_REALTIME);
+        ++stats.wakeups;
+        for (const auto& frame : batch) {
+            ++stats.frames;
+            if (frame.timestamp_ns != 0 && now > frame.timestamp_ns)
+                stats.latencies.push_back(now - frame.timestamp_ns);
+        }
+    }
+}
+
+double CpuSeconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+void Print(Stats& stats, double cpu, double wall) {
+    auto& lat = stats.latencies;
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double p) {
+        return lat.empty() ? 0 : lat[static_cast<size_t>(p * (lat.size() - 1))];
+    };
+    std::cout << "frames=" << stats.frames << " wakeups=" << stats.wakeups
+              << " latency_us p50=" << pct(0.5) / 1000.0 << " p99=" << pct(0.99) / 1000.0
+              << " max=" << pct(1.0) / 1000.0 << " cpu=" << (100.0 * cpu / wall) << "%\n";
+    stats = {};
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <interface> [interface...]\n";
+        return 1;
+    }
+
+    libpkt::EventLoop loop;
+    if (!loop.IsValid()) {
+        std::cerr << "Failed to create event loop\n";
+        return 1;
+    }
+    std::signal(SIGINT, signal_handler);
+
+    Stats stats;
+    std::vector<std::unique_ptr<libpkt::Interface>> ifaces;
+    for (int i = 1; i < argc; ++i) {
+        auto iface = std::make_unique<libpkt::Interface>(argv[i]);
+        if (!iface->Open(true)) {
+            std::cerr << "Failed to open interface: " << iface->Name() << "\n";
+            return 1;
+        }
+        Capture(*iface, loop, stats);
+        ifaces.push_back(std::move(iface));
+    }
+
+    uint64_t wallStart = NowNs(CLOCK_MONOTONIC);
+    double cpuStart = CpuSeconds();
+    while (running) {
+        loop.RunOnce(500);
+        uint64_t wall = NowNs(CLOCK_MONOTONIC);
+        if (wall - wallStart >= 5000000000ull) {
+            double cpu = CpuSeconds();
+            Print(stats, cpu - cpuStart, (wall - wallStart) / 1e9);
+            wallStart = wall;
+            cpuStart = cpu;
+        }
+    }
+    std::cout << "Exiting...\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "libpkt/netflow.hpp"
+#include "libpkt/pcap.hpp"
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Export the flows of a pcap file to a collector, or act as a minimal
+// collector that prints every record it receives:
+//
+//   examples_netflow export <file.pcap> <host> <port> [v9]
+//   examples_netflow collect <port>
+
+namespace {
+std::string FormatIP(uint32_t ip) {
+    struct in_addr addr{htonl(ip)};
+    char buf[INET_ADDRSTRLEN];
+    return inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+}
+
+void PrintRecord(const libpkt::netflow::FlowRecord& rec, void*) {
+    std::cout << FormatIP(rec.key.src_ip) << ':' << rec.key.src_port << " -> "
+              << FormatIP(rec.key.dst_ip) << ':' << rec.key.dst_port
+              << " proto=" << static_cast<int>(rec.key.protocol) << " packets=" << rec.packets
+              << " bytes=" << rec.bytes << " duration_ms=" << (rec.last_ns - rec.first_ns) / 1000000
+              << '\n';
+}
+
+int Export(const char* path, const std::string& host, uint16_t port, bool v9) {
+    libpkt::PcapReader reader;
+    if (!reader.Open(path)) {
+        std::cerr << "Failed to open " << path << "\n";
+        return 1;
+    }
+
+    libpkt::netflow::Exporter::Config config;
+    if (v9)
+        config.format = libpkt::netflow::Format::NetFlowV9;
+    libpkt::netflow::Exporter exporter(config);
+    if (!exporter.OpenUDP(host, port)) {
+        std::cerr << "Failed to reach " << host << ":" << port << "\n";
+        return 1;
+    }
+
+    libpkt::netflow::FlowTable table({}, &libpkt::netflow::Exporter::Sink, &exporter);
+    libpkt::FrameView frame;
+    uint64_t frames = 0;
+    while (reader.Next(frame)) {
+        table.Update(frame);
+        if ((++frames & 1023) == 0)
+            table.Expire(frame.timestamp_ns);
+    }
+    table.FlushAll();
+    exporter.Flush();
+
+    const auto& stats = exporter.GetStats();
+    std::cout << "frames=" << frames << " records=" << stats.records
+              << " messages=" << stats.messages << " send_errors=" << stats.send_errors << "\n";
+    return 0;
+}
+
+int Collect(uint16_t port) {
+    int fd = socket(AF_INET6, SOCK_DGRAM, 0);
+    int off = 0;
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    struct sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_port = htons(port);
+    addr.sin6_addr = in6addr_any;
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind port " << port << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    libpkt::netflow::Collector collector;
+    uint8_t buf[65536];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0)
+            break;
+        if (collector.Feed(buf, n, PrintRecord, nullptr) < 0)
+            std::cerr << "Malformed message (" << n << " bytes)\n";
+    }
+    close(fd);
+    return 0;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc >= 5 && std::string(argv[1]) == "export")
+        return Export(argv[2], argv[3], static_cast<uint16_t>(std::stoi(argv[4])),
+                      argc > 5 && std::string(argv[5]) == "v9");
+    if (argc == 3 && std::string(argv[1]) == "collect")
+        return Collect(static_cast<uint16_t>(std::stoi(argv[2])));
+
+    std::cerr << "Usage: " << argv[0] << " export <file.pcap> <host> <port> [v9]\n"
+              << "       " << argv[0] << " collect <port>\n";
+    return 1;
+}
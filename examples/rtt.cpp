@@ -0,0 +1,84 @@
+#include "libpkt/icmp_echo.hpp"
+#include "libpkt/pcap.hpp"
+#include "libpkt/tcp_rtt.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+// Replay a pcap through the passive TCP RTT and ICMP echo trackers and
+// print a latency summary and histogram for each sample kind.
+
+namespace {
+void PrintHistogram(const libpkt::LatencyHistogram& hist) {
+    // Merge the fine buckets into one row per power of two for display.
+    uint64_t rows[64] = {};
+    uint64_t widest = 0;
+    for (size_t i = 0; i < libpkt::LatencyHistogram::BucketCount; ++i) {
+        uint64_t count = hist.BucketCountAt(i);
+        if (count == 0)
+            continue;
+        uint64_t lower = libpkt::LatencyHistogram::BucketLowerBound(i);
+        unsigned row = lower ? 63 - __builtin_clzll(lower) : 0;
+        rows[row] += count;
+        widest = std::max(widest, rows[row]);
+    }
+    for (unsigned row = 0; row < 64; ++row) {
+        if (rows[row] == 0)
+            continue;
+        char line[128];
+        int bar = static_cast<int>(rows[row] * 50 / widest);
+        std::snprintf(line, sizeof(line), "  >= %10.1f us %10llu |%.*s\n", (1ull << row) / 1000.0,
+                      static_cast<unsigned long long>(rows[row]), bar,
+                      "##################################################");
+        std::cout << line;
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.pcap>\n";
+        return 1;
+    }
+    libpkt::PcapReader reader;
+    if (!reader.Open(argv[1])) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    using libpkt::tcp::RttTracker;
+    RttTracker tracker;
+    libpkt::icmp::EchoTracker echo;
+    libpkt::FrameView frame;
+    uint64_t frames = 0, last = 0;
+    while (reader.Next(frame)) {
+        if (!tracker.Update(frame))
+            echo.Update(frame);
+        last = frame.timestamp_ns;
+        if ((++frames & 1023) == 0) {
+            tracker.Expire(frame.timestamp_ns);
+            echo.Expire(frame.timestamp_ns);
+        }
+    }
+    echo.Expire(last + libpkt::icmp::EchoTracker::Config{}.timeout_ns, SIZE_MAX);
+
+    const char* names[] = {"SYN -> SYN/ACK", "SYN/ACK -> ACK", "data -> ACK", "TSval -> TSecr"};
+    for (size_t kind = 0; kind < RttTracker::SampleKinds; ++kind) {
+        const auto& hist = tracker.Histogram(static_cast<RttTracker::Sample>(kind));
+        std::cout << names[kind] << ": " << hist.Summary() << "\n";
+        PrintHistogram(hist);
+    }
+    std::cout << "echo request -> reply: " << echo.Histogram().Summary() << "\n";
+    PrintHistogram(echo.Histogram());
+
+    const auto& stats = tracker.GetStats();
+    std::cout << "frames=" << frames << " connections=" << stats.connections
+              << " evictions=" << stats.evictions << " karn_discards=" << stats.karn_discards
+              << " clock_discards=" << stats.clock_discards << "\n";
+    const auto& es = echo.GetStats();
+    std::cout << "echo requests=" << es.requests << " replies=" << es.replies
+              << " lost=" << es.timeouts << " errors=" << es.errors
+              << " duplicates=" << es.duplicates << " unmatched=" << es.unmatched << "\n";
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace libpkt {
+
+// Rewrites captured Ethernet frames in place so they can be shared without
+// revealing who talked to whom.
+//
+// IPv4 and IPv6 addresses are anonymized prefix-preservingly in the manner
+// of Crypto-PAn: bit i of the output is bit i of the input flipped by a
+// keyed pseudo-random function of the i bits before it, so two addresses
+// sharing a k-bit prefix map to addresses sharing exactly a k-bit prefix and
+// subnet structure survives. The PRF is SipHash-2-4; the flips of the first
+// 16 bits are precomputed into a table and recent results are cached, so a
+// repeated address costs one lookup.
+//
+// Addresses are rewritten in the IPv4/IPv6 header, in the datagram quoted by
+// ICMP errors, in neighbor discovery and in ARP; MACs are replaced by a
+// keyed hash that keeps the group bit, cached the same way. IPv4 header,
+// TCP, UDP and ICMP checksums are fixed up incrementally so a frame that was
+// valid stays valid. Optionally the transport payload is cut off to keep
+// only headers.
+class Anonymizer {
+  public:
+    struct Config {
+        // PRF key; the same key gives the same mapping across runs and
+        // processes. All zero (the default) draws a random key.
+        std::array<uint8_t, 16> key{};
+        bool addresses = true;
+        bool macs = true;
+        bool keep_oui = false; // scramble only the low 3 bytes of each MAC
+        // Transport payload bytes kept per frame; SIZE_MAX keeps everything.
+        // Length fields still describe the original packet.
+        size_t max_payload = SIZE_MAX;
+        size_t cache_size = 1 << 12; // per address family, rounded up to a power of two
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t ipv4 = 0;
+        uint64_t ipv6 = 0;
+        uint64_t arp = 0;
+        uint64_t truncated = 0;
+        uint64_t cache_misses = 0; // addresses that had to be computed
+    };
+
+    explicit Anonymizer(const Config& config);
+    Anonymizer() : Anonymizer(Config{}) {}
+    ~Anonymizer();
+
+    // Rewrite one frame of `length` captured bytes; returns the length to
+    // keep, which is shorter only when the payload was truncated.
+    size_t Rewrite(uint8_t* frame, size_t length);
+
+    // The address mappings on their own; IPv4 in host byte order.
+    uint32_t AnonymizeIPv4(uint32_t address);
+    void AnonymizeIPv6(const uint8_t* address, uint8_t* out);
+    void ScrambleMAC(const uint8_t* mac, uint8_t* out);
+
+    const std::array<uint8_t, 16>& Key() const { return m_key; }
+    const Stats& GetStats() const { return m_stats; }
+
+    Anonymizer(const Anonymizer&) = delete;
+    Anonymizer& operator=(const Anonymizer&) = delete;
+
+  private:
+    struct Entry4;
+    struct Entry6;
+    struct EntryMAC;
+
+    size_t RewriteIPv4(uint8_t* frame, size_t offset, size_t length);
+    size_t RewriteIPv6(uint8_t* frame, size_t offset, size_t length);
+    void RewriteARP(uint8_t* frame, size_t offset, size_t length);
+    // Anonymize the 4-byte address at `p` in place.
+    void Address4(uint8_t* p);
+    size_t Truncate(size_t payloadStart, size_t length);
+    uint64_t Prf(uint64_t a, uint64_t b, uint64_t c) const;
+
+    Config m_config;
+    Stats m_stats;
+    std::array<uint8_t, 16> m_key;
+    uint64_t m_k0, m_k1;
+    // Anonymized top 16 bits for every possible top 16 bits.
+    std::unique_ptr<uint16_t[]> m_top4;
+    std::unique_ptr<uint16_t[]> m_top6;
+    std::unique_ptr<Entry4[]> m_cache4;
+    std::unique_ptr<Entry6[]> m_cache6;
+    std::unique_ptr<EntryMAC[]> m_cacheMAC;
+    size_t m_cacheMask;
+};
+
+} // namespace libpkt
@@ -7,11 +7,18 @@
  */
 #pragma once
 
+#include "packet.hpp"
+
 #include <cstdint>
 #include <string>
 
 namespace libpkt::arp {
-class Packet {
+enum Opcode : uint16_t {
+    Request = 1,
+    Reply = 2,
+};
+
+class Packet : public libpkt::Packet {
   public:
     static constexpr size_t HeaderSize = 28;
 
@@ -30,11 +37,23 @@ class Packet {
     std::string TargetMAC() const;
     std::string TargetIP() const;
 
+    // Binary forms; MACs point into the packet, addresses are host order.
+    const uint8_t* SenderMACRaw() const;
+    uint32_t SenderIPRaw() const;
+    const uint8_t* TargetMACRaw() const;
+    uint32_t TargetIPRaw() const;
+
+    // Ethernet/IPv4 ARP, the only kind the accessors above make sense for.
+    bool IsEthernetIPv4() const;
+    // Announcement of the sender's own binding (sender IP == target IP).
+    bool IsGratuitous() const;
+    // RFC 5227 address probe: sender IP is 0.0.0.0.
+    bool IsProbe() const;
+
     std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
 
   private:
-    const uint8_t* m_data;
-    size_t m_length;
     bool m_valid;
 
     std::string MACToString(const uint8_t* mac) const;
@@ -0,0 +1,142 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+#include "tcp.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace libpkt::l7 {
+
+// Fast classification of a TCP connection from its first payload: the SNI,
+// ALPN and version of a TLS ClientHello, or the method, target and Host of
+// an HTTP/1.x request. Nothing is allocated or copied; every length is
+// checked against both the enclosing structure and the bytes at hand, so
+// truncated or hostile input only ends the walk early.
+
+enum class Kind : uint8_t { Unknown, TLS, HTTP };
+
+struct Result {
+    static constexpr size_t MaxALPN = 4;
+
+    Kind kind = Kind::Unknown;
+    // The whole ClientHello / request head was seen.
+    bool complete = false;
+
+    // TLS ClientHello. The version is the highest in supported_versions,
+    // else the legacy one; with ECH, `sni` is the outer (public) name.
+    uint16_t tls_version = 0;
+    bool ech = false;
+    std::string_view sni;
+    std::string_view alpn[MaxALPN]; // the first MaxALPN protocols offered
+    uint8_t alpn_count = 0;
+
+    // HTTP/1.x request.
+    uint8_t http_version = 0; // 10 or 11
+    std::string_view method;
+    std::string_view target;
+    std::string_view host;
+};
+
+// Where a ClientHello cut off by the end of a segment picks up in the next
+// one. Only the extensions block is resumed; an SNI, ALPN or
+// supported_versions extension split by the boundary is collected here if
+// it fits, so its fields may point into this state.
+struct Continuation {
+    uint32_t left = 0; // extension-block bytes still to come; 0: nothing to resume
+    uint32_t skip = 0; // of those, the rest of the current extension
+    uint8_t head[4];   // a split extension header
+    uint8_t head_length = 0;
+    uint16_t type = 0;       // extension being collected into `partial`
+    uint8_t partial_length = 0;
+    bool collecting = false;
+    uint8_t partial[64];
+};
+
+// Classify a connection's first payload; fields point into `data`. If a
+// ClientHello continues past `length` and `resume` is given, it is set up
+// for Resume() with the next in-order segment.
+Kind Parse(const uint8_t* data, size_t length, Result& out, Continuation* resume = nullptr);
+// Continue a ClientHello; fills in what this segment adds. False once
+// there is nothing (more) to resume.
+bool Resume(Continuation& resume, const uint8_t* data, size_t length, Result& out);
+
+// Per-connection short-circuit around Parse(): the first payload in either
+// direction classifies a connection, later segments cost one table lookup,
+// and a ClientHello spanning segments is followed in sequence order. A SYN
+// or RST forgets the connection. State lives in fixed-size tables: a small
+// slot per connection, and a pool of continuations for the ClientHellos in
+// progress.
+class Classifier {
+  public:
+    struct Config {
+        size_t capacity = 1 << 16; // connections, rounded up to a power of two
+        uint64_t idle_timeout_ns = 120'000'000'000;
+        uint8_t max_segments = 4; // segments one ClientHello may span
+        size_t pending = 1024;    // ClientHellos followed across segments at once
+    };
+
+    struct Stats {
+        uint64_t segments = 0;  // with payload
+        uint64_t skipped = 0;   // short-circuited: connection already classified
+        uint64_t tls = 0;
+        uint64_t http = 0;
+        uint64_t unknown = 0;
+        uint64_t resumed = 0;   // later segments of a ClientHello parsed
+        uint64_t evictions = 0;
+    };
+
+    explicit Classifier(const Config& config);
+    Classifier() : Classifier(Config{}) {}
+
+    // True when `out` describes this segment: the first payload of a
+    // connection, or a later segment of its ClientHello. Fields stay valid
+    // until the next call to Update().
+    bool Update(const FrameView& frame, Result& out);
+    bool Update(const FlowKey& key, const tcp::Packet& tcp, uint64_t timestamp_ns, Result& out);
+
+    // Drop idle connections, examining at most `budget` slots per call.
+    void Expire(uint64_t now_ns, size_t budget = 1024);
+
+    const Stats& GetStats() const { return m_stats; }
+    size_t Size() const { return m_size; }
+
+  private:
+    struct Connection {
+        FlowKey key; // canonical orientation: lower endpoint first
+        uint64_t hash;
+        uint64_t last_ns;
+        uint32_t next_seq; // of the next ClientHello segment
+        uint32_t pending;  // its continuation in m_pending, or NotPending
+        uint8_t dir;       // direction the ClientHello travels
+        uint8_t segments;
+        bool used;
+    };
+
+    static constexpr uint32_t NotPending = UINT32_MAX;
+
+    size_t Home(uint64_t hash) const { return hash & (m_slots.size() - 1); }
+    Connection* Find(const FlowKey& key, uint64_t hash, bool create);
+    void Erase(size_t slot);
+    void Release(Connection& conn);
+
+    Config m_config;
+    Stats m_stats;
+    std::vector<Connection> m_slots;
+    std::vector<Continuation> m_pending;
+    std::vector<uint32_t> m_free; // unused m_pending entries
+    size_t m_size;
+    size_t m_hand;
+};
+
+} // namespace libpkt::l7
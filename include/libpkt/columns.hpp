@@ -0,0 +1,60 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace libpkt {
+
+// Structure-of-arrays view of a decoded batch: one contiguous column per
+// field, indexed by frame position. Fields of layers that are absent or
+// invalid are zero; the bitmaps say which layers decoded (bit i of word i/64).
+// Reusing a ColumnBatch across batches of at most Capacity() frames never
+// reallocates.
+struct ColumnBatch {
+    std::vector<uint64_t> timestamp_ns;
+    std::vector<uint32_t> length;
+    std::vector<uint16_t> ethertype;
+    std::vector<uint8_t> ip_protocol;
+    std::vector<uint32_t> src_ip; // host byte order
+    std::vector<uint32_t> dst_ip;
+    std::vector<uint16_t> src_port;
+    std::vector<uint16_t> dst_port;
+    std::vector<uint8_t> tcp_flags;
+
+    std::vector<uint64_t> ethernet_valid;
+    std::vector<uint64_t> ipv4_valid;
+    std::vector<uint64_t> l4_valid; // TCP or UDP header present
+
+    explicit ColumnBatch(size_t capacity = 0) { Reserve(capacity); }
+
+    void Reserve(size_t capacity);
+    size_t Capacity() const { return timestamp_ns.capacity(); }
+    size_t Size() const { return timestamp_ns.size(); }
+
+    static bool Test(const std::vector<uint64_t>& bitmap, size_t i) {
+        return (bitmap[i >> 6] >> (i & 63)) & 1;
+    }
+
+  private:
+    friend size_t DecodeBatch(std::span<const FrameView>, ColumnBatch&);
+    void Resize(size_t count);
+};
+
+// Decode Ethernet/IPv4/TCP|UDP headers of `frames` into `out`, replacing its
+// contents. Headers are prefetched a few frames ahead of parsing and decoded
+// simd::MaxLanes at a time with the vectorized kernel. Returns the number of
+// frames with a valid IPv4 header.
+size_t DecodeBatch(std::span<const FrameView> frames, ColumnBatch& out);
+
+} // namespace libpkt
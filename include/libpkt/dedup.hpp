@@ -0,0 +1,78 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace libpkt {
+
+// Drops repeats of a frame seen within a short window, as produced by SPAN
+// ports mirroring both directions of a link or by several taps on one path.
+//
+// Frames are compared by a 64-bit hash of their invariant content: for
+// IPv4, the IP packet up to its total length with TTL and header checksum
+// masked, so copies taken before and after a router hop (new MACs, VLAN tag
+// added or removed, TTL decremented) still match; for anything else, the
+// frame without its VLAN tags.
+//
+// Seen hashes live in a set-associative table of 64-byte buckets holding
+// eight (tag, time) entries, so a lookup touches one cache line. A full
+// bucket replaces its oldest entry. Two different frames are mistaken for
+// one another only if they share bucket and 32-bit tag within the window.
+class Deduplicator {
+  public:
+    struct Config {
+        // Entries, rounded up to a power of two; give it at least twice the
+        // frames expected within one window.
+        size_t capacity = 1 << 16;
+        uint64_t window_ns = 5'000'000; // kept to ~1 us
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t duplicates = 0;
+        uint64_t evictions = 0; // entries replaced while still inside the window
+    };
+
+    explicit Deduplicator(const Config& config);
+    Deduplicator() : Deduplicator(Config{}) {}
+
+    // True if the frame repeats one seen within the window; the first copy
+    // is remembered and passes.
+    bool IsDuplicate(const FrameView& frame);
+    bool IsDuplicate(uint64_t hash, uint64_t timestamp_ns);
+
+    // Remove duplicates from `frames` in place, keeping order; returns how
+    // many were removed.
+    size_t Filter(std::vector<FrameView>& frames);
+
+    // The invariant-content hash described above.
+    static uint64_t Hash(const uint8_t* frame, size_t length);
+
+    const Stats& GetStats() const { return m_stats; }
+    void Clear();
+
+  private:
+    struct alignas(64) Bucket {
+        uint32_t tags[8]; // 0 marks an empty entry
+        uint32_t ticks[8];
+    };
+
+    Config m_config;
+    Stats m_stats;
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_mask;
+    uint32_t m_windowTicks;
+};
+
+} // namespace libpkt
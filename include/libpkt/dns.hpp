@@ -0,0 +1,137 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "packet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+namespace libpkt::dns {
+
+enum class Type : uint16_t {
+    A = 1,
+    NS = 2,
+    CNAME = 5,
+    SOA = 6,
+    PTR = 12,
+    MX = 15,
+    TXT = 16,
+    AAAA = 28,
+    SRV = 33,
+    OPT = 41,
+    HTTPS = 65,
+    ANY = 255,
+};
+
+enum class RCode : uint8_t {
+    NoError = 0,
+    FormErr = 1,
+    ServFail = 2,
+    NXDomain = 3,
+    NotImp = 4,
+    Refused = 5,
+};
+
+enum class Section : uint8_t { Question, Answer, Authority, Additional };
+
+// Buffer size that holds any decoded name, fully escaped, plus the NUL.
+constexpr size_t MaxNameLength = 1024;
+
+// A question or resource record, pointing into the message. Questions have
+// no TTL or RDATA.
+struct Record {
+    Section section;
+    uint16_t name_offset; // decode with Packet::Name()
+    uint16_t type;
+    uint16_t rclass;
+    uint32_t ttl;
+    const uint8_t* rdata;
+    uint16_t rdata_length;
+};
+
+// Decode the (possibly compressed) name at `offset` of a DNS message into
+// `out` as dotted text without a trailing dot ("." for the root). Dots,
+// backslashes and non-printable label bytes are escaped as in zone files
+// (\. and \DDD). Compression pointers must point strictly backwards, which
+// rules out loops, and at most 32 are followed. Returns the name length
+// excluding the NUL, or -1 for a malformed name or one that does not fit in
+// `capacity`.
+ssize_t DecodeName(const uint8_t* message, size_t length, size_t offset, char* out,
+                   size_t capacity);
+
+// DNS message (RFC 1035) parsed in place, usually a UDP payload. Nothing is
+// copied or allocated: records are walked on demand and names are decoded
+// into caller buffers.
+class Packet : public libpkt::Packet {
+  public:
+    static constexpr size_t HeaderSize = 12;
+
+    // Walks all sections in order, skipping names without decoding them.
+    class Reader {
+      public:
+        explicit Reader(const Packet& packet);
+
+        // False at the end of the message or on the first malformed record.
+        bool Next(Record& record);
+        bool Malformed() const { return m_malformed; }
+
+      private:
+        const uint8_t* m_data;
+        size_t m_length;
+        size_t m_offset;
+        uint32_t m_remaining[4];
+        uint8_t m_section;
+        bool m_malformed;
+    };
+
+    Packet(const uint8_t* data, size_t length);
+
+    bool IsValid() const;
+
+    uint16_t Id() const;
+    bool IsResponse() const;
+    uint8_t Opcode() const;
+    bool Authoritative() const;
+    bool Truncated() const;
+    bool RecursionDesired() const;
+    bool RecursionAvailable() const;
+    RCode GetRCode() const;
+
+    uint16_t QuestionCount() const;
+    uint16_t AnswerCount() const;
+    uint16_t AuthorityCount() const;
+    uint16_t AdditionalCount() const;
+
+    Reader Records() const { return Reader(*this); }
+
+    // Name at an offset of this message (see DecodeName()).
+    ssize_t Name(uint16_t offset, char* out, size_t capacity) const;
+
+    // First question; false if there is none or it is malformed.
+    bool FirstQuestion(Record& question) const;
+    ssize_t QueryName(char* out, size_t capacity) const;
+    uint16_t QueryType() const;
+
+    // Copy up to `max` A (4 bytes each) or AAAA (16 bytes each) answer
+    // addresses, in network byte order; returns how many were copied.
+    size_t AnswerIPv4(uint8_t (*out)[4], size_t max) const;
+    size_t AnswerIPv6(uint8_t (*out)[16], size_t max) const;
+
+    std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
+
+  private:
+    bool m_valid;
+
+    uint16_t Field(size_t offset) const;
+};
+
+} // namespace libpkt::dns
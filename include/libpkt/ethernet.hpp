@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include "packet.hpp"
+
 #include <array>
 #include <cstdint>
 #include <string>
@@ -26,7 +28,28 @@ enum class EtherType : uint16_t {
     Unknown = 0xFFFF
 };
 
-class EthernetFrame {
+namespace detail {
+// Known EtherTypes indexed by (high byte ^ low byte), which is collision-free
+// for the values above; 0 marks an empty slot.
+constexpr std::array<uint16_t, 256> MakeEtherTypeTable() {
+    std::array<uint16_t, 256> table{};
+    for (EtherType t : {EtherType::IPv4, EtherType::ARP, EtherType::WOL, EtherType::VLAN,
+                        EtherType::IPv6, EtherType::LLDP}) {
+        uint16_t v = static_cast<uint16_t>(t);
+        table[(v >> 8) ^ (v & 0xFF)] = v;
+    }
+    return table;
+}
+inline constexpr std::array<uint16_t, 256> EtherTypeTable = MakeEtherTypeTable();
+} // namespace detail
+
+constexpr EtherType ToEtherType(uint16_t raw) {
+    return detail::EtherTypeTable[(raw >> 8) ^ (raw & 0xFF)] == raw && raw != 0
+               ? static_cast<EtherType>(raw)
+               : EtherType::Unknown;
+}
+
+class EthernetFrame : public Packet {
   public:
     static constexpr size_t HeaderSize = 14;
 
@@ -42,15 +65,13 @@ class EthernetFrame {
     const uint8_t* Payload() const;
     size_t PayloadLength() const;
 
+    std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
+
   private:
-    std::array<uint8_t, 6> m_dst_mac;
-    std::array<uint8_t, 6> m_src_mac;
-    uint16_t m_ethertype;
-    const uint8_t* m_payload;
-    size_t m_payload_len;
     bool m_valid;
 
-    std::string MacToString(const std::array<uint8_t, 6>& mac) const;
+    static std::string MacToString(const uint8_t* mac);
 };
 
 } // namespace libpkt
@@ -0,0 +1,57 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+namespace libpkt {
+
+// Single-threaded epoll reactor. Coroutines park on a file descriptor with
+// Watch() and are resumed from Run()/RunOnce() once it becomes readable.
+// Run one loop per thread to spread many capture tasks over a few threads.
+class EventLoop {
+  public:
+    EventLoop();
+    ~EventLoop();
+
+    bool IsValid() const;
+
+    // Resume `handle` once `fd` is readable (one-shot).
+    bool Watch(int fd, std::coroutine_handle<> handle);
+
+    // Wait up to `timeoutMs` (-1 = forever) and resume ready coroutines.
+    // Returns the number of coroutines resumed.
+    size_t RunOnce(int timeoutMs = -1);
+    void Run();
+
+    // Thread-safe: wakes the loop and makes Run() return.
+    void Stop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+  private:
+    int m_epollFd;
+    int m_wakeFd;
+    bool m_running;
+};
+
+// Fire-and-forget coroutine type: starts eagerly and frees itself on completion.
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace libpkt
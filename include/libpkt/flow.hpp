@@ -0,0 +1,37 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libpkt {
+
+// IPv4 5-tuple in host byte order. Ports are zero for protocols other than
+// TCP and UDP.
+struct FlowKey {
+    uint32_t src_ip = 0;
+    uint32_t dst_ip = 0;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+    uint8_t protocol = 0;
+
+    FlowKey Reversed() const { return {dst_ip, src_ip, dst_port, src_port, protocol}; }
+
+    bool operator==(const FlowKey&) const = default;
+};
+
+// 64-bit hash of all five fields, for hash tables and sketches.
+uint64_t HashFlowKey(const FlowKey& key);
+
+// Extract the 5-tuple of an IPv4 Ethernet frame. Ports are zero for
+// protocols without them and for fragments. Returns false if the frame does
+// not carry a valid IPv4 header.
+bool ExtractFlowKey(const uint8_t* frame, size_t length, FlowKey& key);
+
+} // namespace libpkt
@@ -0,0 +1,83 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libpkt {
+
+// Append-only character buffer for formatting without streams or locales.
+// It only grows when a record does not fit, so a buffer that is cleared and
+// reused stops allocating once it has seen its largest record.
+class TextBuffer {
+  public:
+    explicit TextBuffer(size_t capacity = 256) : m_data(capacity), m_size(0) {}
+
+    TextBuffer& Append(std::string_view s) {
+        std::memcpy(Reserve(s.size()), s.data(), s.size());
+        m_size += s.size();
+        return *this;
+    }
+    TextBuffer& Append(char c) {
+        *Reserve(1) = c;
+        ++m_size;
+        return *this;
+    }
+    TextBuffer& AppendUInt(uint64_t value) {
+        char* p = Reserve(20);
+        m_size = std::to_chars(p, p + 20, value).ptr - m_data.data();
+        return *this;
+    }
+    TextBuffer& AppendInt(int64_t value) {
+        char* p = Reserve(20);
+        m_size = std::to_chars(p, p + 20, value).ptr - m_data.data();
+        return *this;
+    }
+    // Lower-case hex, zero-padded to at least `width` digits.
+    TextBuffer& AppendHex(uint64_t value, int width = 0);
+    TextBuffer& AppendIPv4(uint32_t hostOrder);
+    TextBuffer& AppendIPv4(const uint8_t* networkOrder);
+    // aa:bb:cc:dd:ee:ff
+    TextBuffer& AppendMAC(const uint8_t* mac);
+    // Seconds since the epoch with nanoseconds: 1700000000.000000123
+    TextBuffer& AppendTimestamp(uint64_t ns);
+    // Quoted and escaped as a JSON string.
+    TextBuffer& AppendJSONString(std::string_view s);
+
+    // Room for at least `n` more characters at the end; commit them with
+    // Commit(). Pointers from earlier calls are invalidated.
+    char* Reserve(size_t n) {
+        if (m_size + n > m_data.size())
+            Grow(n);
+        return m_data.data() + m_size;
+    }
+    void Commit(size_t n) { m_size += n; }
+
+    const char* Data() const { return m_data.data(); }
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_data.size(); }
+    std::string_view View() const { return {m_data.data(), m_size}; }
+    std::string String() const { return std::string(m_data.data(), m_size); }
+    void Clear() { m_size = 0; }
+    // Shrink to `size` characters (no-op if already shorter).
+    void Truncate(size_t size) { m_size = size < m_size ? size : m_size; }
+
+  private:
+    void Grow(size_t n);
+
+    std::vector<char> m_data;
+    size_t m_size;
+};
+
+} // namespace libpkt
@@ -0,0 +1,60 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sys/socket.h>
+#include <vector>
+
+namespace libpkt {
+
+// Non-owning view of a captured frame.
+struct FrameView {
+    const uint8_t* data;
+    size_t length;
+    uint64_t timestamp_ns; // CLOCK_REALTIME, 0 if unknown
+};
+
+// Reusable set of receive buffers filled by Interface::ReceiveBatch().
+// Frames stay valid until the next receive into the same batch.
+class PacketBatch {
+  public:
+    static constexpr size_t DefaultCapacity = 64;
+    static constexpr size_t DefaultSnapLen = 2048;
+
+    explicit PacketBatch(size_t capacity = DefaultCapacity, size_t snapLen = DefaultSnapLen);
+
+    size_t Capacity() const { return m_frames.size(); }
+    size_t SnapLen() const { return m_snapLen; }
+    size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+    void Clear() { m_size = 0; }
+
+    const FrameView& operator[](size_t i) const { return m_frames[i]; }
+    std::span<const FrameView> Frames() const { return {m_frames.data(), m_size}; }
+    const FrameView* begin() const { return m_frames.data(); }
+    const FrameView* end() const { return m_frames.data() + m_size; }
+
+    PacketBatch(const PacketBatch&) = delete;
+    PacketBatch& operator=(const PacketBatch&) = delete;
+
+  private:
+    friend class Interface;
+
+    size_t m_snapLen;
+    size_t m_size;
+    std::vector<uint8_t> m_storage;
+    std::vector<uint8_t> m_control;
+    std::vector<FrameView> m_frames;
+    std::vector<struct iovec> m_iov;
+    std::vector<struct mmsghdr> m_msgs;
+};
+
+} // namespace libpkt
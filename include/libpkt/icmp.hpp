@@ -7,11 +7,50 @@
  */
 #pragma once
 
+#include "flow.hpp"
+#include "packet.hpp"
+
 #include <cstdint>
 #include <string>
 
 namespace libpkt::icmp {
-class Packet {
+enum Type : uint8_t {
+    EchoReply = 0,
+    DestinationUnreachable = 3,
+    SourceQuench = 4,
+    Redirect = 5,
+    EchoRequest = 8,
+    TimeExceeded = 11,
+    ParameterProblem = 12,
+    TimestampRequest = 13,
+    TimestampReply = 14,
+};
+
+// Destination Unreachable codes (RFC 792, RFC 1122, RFC 1812).
+enum UnreachableCode : uint8_t {
+    NetUnreachable = 0,
+    HostUnreachable = 1,
+    ProtocolUnreachable = 2,
+    PortUnreachable = 3,
+    FragmentationNeeded = 4,
+    SourceRouteFailed = 5,
+    AdministrativelyProhibited = 13,
+};
+
+// The start of the datagram that caused an error, as its sender emitted it.
+struct Quoted {
+    FlowKey flow; // ports are zero unless TCP or UDP
+    uint16_t ip_id;
+    uint16_t total_length;
+    uint8_t ttl; // TTL left when the error was generated
+    bool has_l4; // the first 8 bytes of the transport header are present
+    uint32_t tcp_seq;
+    uint8_t icmp_type; // quoted ICMP message, e.g. an echo request
+    uint16_t icmp_id;
+    uint16_t icmp_seq;
+};
+
+class Packet : public libpkt::Packet {
   public:
     static constexpr size_t MinHeaderSize = 8;
 
@@ -23,11 +62,28 @@ class Packet {
     uint8_t Code() const;
     uint16_t Checksum() const;
 
+    bool IsEcho() const;  // echo request or reply
+    bool IsError() const; // unreachable, quench, redirect, time exceeded, parameter problem
+    // Echo and timestamp messages.
+    uint16_t Identifier() const;
+    uint16_t Sequence() const;
+    // Timestamp request/reply times, in ms since midnight UT (RFC 792).
+    bool GetTimestamps(uint32_t& originate, uint32_t& receive, uint32_t& transmit) const;
+    // Fragmentation needed: the next-hop MTU (RFC 1191), 0 if absent.
+    uint16_t NextHopMTU() const;
+    // Redirect: the gateway to use, host byte order.
+    uint32_t Gateway() const;
+
+    // Everything after the 8-byte header.
+    const uint8_t* Payload() const;
+    size_t PayloadLength() const;
+    // Error messages: decode the quoted IPv4 header and transport ports.
+    bool ParseQuoted(Quoted& out) const;
+
     std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
 
   private:
-    const uint8_t* m_data;
-    size_t m_length;
     bool m_valid;
 };
 } // namespace libpkt::icmp
@@ -0,0 +1,87 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+#include "icmp.hpp"
+#include "latency.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libpkt::icmp {
+
+// Passive ping latency: pairs each echo request with the reply carrying the
+// same identifier and sequence number from the addressed host, and records
+// the time between them as seen at the capture point. Outstanding requests
+// live in a fixed-size table; requests unanswered after `timeout_ns` are
+// counted as lost, and an ICMP error quoting a pending request (e.g. host
+// unreachable) settles it as failed.
+class EchoTracker {
+  public:
+    // `key` is requester -> responder with the identifier in src_port and
+    // the sequence number in dst_port.
+    using SampleSink = void (*)(const FlowKey& key, uint64_t rtt_ns, void* context);
+
+    struct Config {
+        size_t capacity = 1 << 14; // outstanding requests, rounded up to a power of two
+        uint64_t timeout_ns = 10'000'000'000;
+        SampleSink sink = nullptr;
+        void* context = nullptr;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t replies = 0;
+        uint64_t unmatched = 0;  // replies without a pending request
+        uint64_t duplicates = 0; // request seen again while pending
+        uint64_t errors = 0;     // ICMP errors quoting a pending request
+        uint64_t timeouts = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit EchoTracker(const Config& config);
+    EchoTracker() : EchoTracker(Config{}) {}
+
+    // Decode an Ethernet frame; returns false for anything but ICMP/IPv4,
+    // and for non-first fragments, which carry no ICMP header.
+    bool Update(const FrameView& frame);
+    // `src` and `dst` of the carrying IPv4 header, host byte order.
+    void Update(uint32_t src, uint32_t dst, const Packet& icmp, uint64_t timestamp_ns);
+
+    // Drop requests older than timeout_ns, examining at most `budget` slots.
+    void Expire(uint64_t now_ns, size_t budget = 1024);
+
+    const LatencyHistogram& Histogram() const { return m_histogram; }
+    const Stats& GetStats() const { return m_stats; }
+    size_t Size() const { return m_size; }
+
+  private:
+    struct Request {
+        FlowKey key;
+        uint64_t hash;
+        uint64_t sent_ns;
+        bool used;
+    };
+
+    size_t Home(uint64_t hash) const { return hash & (m_slots.size() - 1); }
+    Request* Find(const FlowKey& key, uint64_t hash);
+    void Insert(const FlowKey& key, uint64_t hash, uint64_t timestamp_ns);
+    void Erase(size_t slot);
+
+    Config m_config;
+    Stats m_stats;
+    std::vector<Request> m_slots;
+    size_t m_size;
+    size_t m_hand;
+    LatencyHistogram m_histogram;
+};
+
+} // namespace libpkt::icmp
@@ -7,27 +7,129 @@
  */
 #pragma once
 
+#include "event_loop.hpp"
+#include "frame.hpp"
+
+#include <coroutine>
 #include <cstdint>
+#include <span>
 #include <string>
 
 namespace libpkt {
 class Interface {
   public:
+    // Socket and thread tuning applied by Open(). Every option is best
+    // effort unless `strict` is set; GetReport() tells which took effect.
+    struct Config {
+        static constexpr int InterfaceNode = -2;
+
+        // Receive buffer bytes, 0 keeps the default. SO_RCVBUFFORCE when
+        // permitted (CAP_NET_ADMIN), else SO_RCVBUF, capped by rmem_max.
+        int rcvbuf = 0;
+        int busy_poll_us = 0;          // SO_BUSY_POLL: spin in blocking receives
+        bool prefer_busy_poll = false; // SO_PREFER_BUSY_POLL (Linux 5.11)
+        int busy_poll_budget = 0;      // SO_BUSY_POLL_BUDGET, 0 keeps the default
+        bool promiscuous = false;      // PACKET_MR_PROMISC membership, dropped on Close()
+        bool ignore_outgoing = false;  // PACKET_IGNORE_OUTGOING (Linux 4.20)
+        int cpu = -1;                  // pin the thread calling Open() to this CPU
+        // Prefer this NUMA node for later allocations of the thread calling
+        // Open(), e.g. its PacketBatch. InterfaceNode picks the NIC's node,
+        // or that of `cpu` for virtual devices; -1 leaves the policy alone.
+        int numa_node = -1;
+        // Fail Open() if a requested option did not take effect; the thread's
+        // CPU affinity and memory policy are then left as they were.
+        bool strict = false;
+    };
+
+    enum Option : uint32_t {
+        RcvBuf = 1 << 0,
+        BusyPoll = 1 << 1,
+        PreferBusyPoll = 1 << 2,
+        BusyPollBudget = 1 << 3,
+        Promiscuous = 1 << 4,
+        IgnoreOutgoing = 1 << 5,
+        CpuAffinity = 1 << 6,
+        NumaPolicy = 1 << 7,
+    };
+
+    // What Open() asked for and what the kernel confirmed (read back with
+    // getsockopt() where it can be).
+    struct Report {
+        uint32_t requested = 0; // Option bits
+        uint32_t applied = 0;
+        int rcvbuf = 0;             // effective size as the kernel reports it (doubled)
+        bool rcvbuf_forced = false; // set with SO_RCVBUFFORCE
+        int busy_poll_us = 0;
+        int cpu = -1;
+        int numa_node = -1;
+
+        bool Applied(Option option) const { return (applied & option) != 0; }
+        uint32_t Failed() const { return requested & ~applied; }
+        // "rcvbuf=8388608(forced) busy_poll=50us cpu=0 numa=0 failed=prefer_busy_poll"
+        std::string Summary() const;
+    };
+
     explicit Interface(const std::string& ifaceName);
+    Interface(const std::string& ifaceName, const Config& config);
     ~Interface();
 
-    bool Open();
+    bool Open(bool nonBlocking = false);
     void Close();
     bool IsOpen() const;
 
+    bool SetNonBlocking(bool enable);
+    int Fd() const { return m_sockFd; }
+    const Report& GetReport() const { return m_report; }
+
     ssize_t Receive(uint8_t* buffer, size_t length);
+
+    // Fill `batch` with as many frames as are queued (at least one on a
+    // blocking socket). Returns the frame count, 0 if nothing is queued on a
+    // non-blocking socket, or -1 on error.
+    ssize_t ReceiveBatch(PacketBatch& batch);
+
+    // Transmit one complete Ethernet frame; returns the bytes sent or -1.
+    ssize_t Send(const uint8_t* data, size_t length);
+
+    // Transmit frames with as few sendmmsg() calls as possible. Returns how
+    // many leading frames the kernel accepted, 0 if the first would block on
+    // a non-blocking socket, or -1 if the first failed (errno is kept).
+    ssize_t SendBatch(std::span<const FrameView> frames);
+
     std::string Name() const { return m_ifaceName; }
 
+    // Awaitable returned by NextBatch(): drains the socket into the batch,
+    // parking the coroutine on the event loop while nothing is queued.
+    class BatchAwaiter {
+      public:
+        BatchAwaiter(Interface& iface, EventLoop& loop, PacketBatch& batch)
+            : m_iface(iface), m_loop(loop), m_batch(batch), m_result(0) {}
+
+        bool await_ready();
+        bool await_suspend(std::coroutine_handle<> handle);
+        ssize_t await_resume();
+
+      private:
+        Interface& m_iface;
+        EventLoop& m_loop;
+        PacketBatch& m_batch;
+        ssize_t m_result;
+    };
+
+    // co_await iface.NextBatch(loop, batch) -> frame count (0 after a spurious
+    // wake-up), or -1 on error.
+    // The interface should be opened non-blocking.
+    BatchAwaiter NextBatch(EventLoop& loop, PacketBatch& batch) { return {*this, loop, batch}; }
+
     Interface(const Interface&) = delete;
     Interface& operator=(const Interface&) = delete;
 
   private:
+    void Configure(int ifindex);
+
     std::string m_ifaceName;
+    Config m_config;
+    Report m_report;
     int m_sockFd;
 };
-} // namespace libpkt
\ No newline at end of file
+} // namespace libpkt
@@ -7,13 +7,14 @@
  */
 #pragma once
 
+#include "packet.hpp"
 #include "protocol.hpp"
 
 #include <cstdint>
 #include <string>
 
 namespace libpkt {
-class IPv4Packet {
+class IPv4Packet : public Packet {
   public:
     static constexpr size_t MinHeaderSize = 20;
 
@@ -27,15 +28,25 @@ class IPv4Packet {
     uint8_t ProtocolRaw() const;
     Protocol GetProtocol() const;
 
+    // Offset of this fragment in its datagram, in bytes.
+    uint16_t FragmentOffset() const;
+    // Part of a fragmented datagram (more-fragments set or a non-zero
+    // offset). Only the first fragment carries the transport header.
+    bool IsFragment() const;
+
     std::string SrcAddress() const;
     std::string DstAddress() const;
+    // Addresses in host byte order.
+    uint32_t SrcAddressRaw() const;
+    uint32_t DstAddressRaw() const;
 
     const uint8_t* Payload() const;
     size_t PayloadLength() const;
 
+    std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
+
   private:
-    const uint8_t* m_data;
-    size_t m_length;
     bool m_valid;
 
     static std::string IPToString(uint32_t ip);
@@ -0,0 +1,72 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace libpkt {
+
+// Log-linear latency histogram: 16 linear sub-buckets per power of two, so any
+// recorded value is reported within 1/16 (6.25%) of its true value, from 1 ns
+// up to the full uint64_t range, in a fixed 8 KiB array. Recording is a
+// count-leading-zeros and an increment.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr size_t BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+    LatencyHistogram() { Reset(); }
+
+    void Record(uint64_t ns) {
+        ++m_counts[BucketIndex(ns)];
+        ++m_count;
+        m_sum += ns;
+        if (ns < m_min)
+            m_min = ns;
+        if (ns > m_max)
+            m_max = ns;
+    }
+
+    uint64_t Count() const { return m_count; }
+    uint64_t Min() const { return m_count ? m_min : 0; }
+    uint64_t Max() const { return m_max; }
+    uint64_t Mean() const { return m_count ? m_sum / m_count : 0; }
+
+    // Value at quantile q in [0, 1]: the upper bound of the bucket holding it,
+    // clamped to the observed min/max.
+    uint64_t Percentile(double q) const;
+
+    void Merge(const LatencyHistogram& other);
+    void Reset();
+
+    static size_t BucketIndex(uint64_t ns) {
+        if (ns < (1u << SubBucketBits))
+            return static_cast<size_t>(ns);
+        unsigned exponent = 63 - __builtin_clzll(ns);
+        unsigned shift = exponent - SubBucketBits;
+        return ((exponent - SubBucketBits + 1) << SubBucketBits) |
+               ((ns >> shift) & ((1u << SubBucketBits) - 1));
+    }
+    static uint64_t BucketLowerBound(size_t index);
+    uint64_t BucketCountAt(size_t index) const { return m_counts[index]; }
+
+    // "count=... min=... p50=... p90=... p99=... max=..." in microseconds.
+    std::string Summary() const;
+
+  private:
+    std::array<uint64_t, BucketCount> m_counts;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+};
+
+} // namespace libpkt
@@ -0,0 +1,85 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "arp.hpp"
+#include "ethernet.hpp"
+#include "format.hpp"
+#include "icmp.hpp"
+#include "ipv4.hpp"
+#include "tcp.hpp"
+#include "udp.hpp"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace libpkt {
+
+// Closed set of protocol layers. Every alternative is a trivially copyable
+// view, so a decoded stack can live in a plain array and be dispatched with
+// std::visit instead of virtual calls. std::monostate marks an empty slot.
+using Layer = std::variant<std::monostate, EthernetFrame, IPv4Packet, arp::Packet, icmp::Packet,
+                           tcp::Packet, udp::Packet>;
+
+static_assert(std::is_trivially_copyable_v<EthernetFrame>);
+static_assert(std::is_trivially_copyable_v<IPv4Packet>);
+static_assert(std::is_trivially_copyable_v<arp::Packet>);
+static_assert(std::is_trivially_copyable_v<icmp::Packet>);
+static_assert(std::is_trivially_copyable_v<tcp::Packet>);
+static_assert(std::is_trivially_copyable_v<udp::Packet>);
+static_assert(std::is_trivially_copyable_v<Layer>);
+
+// Maximum number of layers DecodeLayers() can produce (L2, L3, L4).
+inline constexpr size_t MaxLayers = 3;
+
+// Decode an Ethernet frame into `out`, outermost layer first, stopping at the
+// first invalid or unsupported layer; a non-first IPv4 fragment ends at the
+// IPv4 layer. Returns the number of layers written.
+size_t DecodeLayers(const uint8_t* frame, size_t length, Layer (&out)[MaxLayers]);
+
+template <typename Visitor> decltype(auto) Visit(Visitor&& visitor, const Layer& layer) {
+    return std::visit(std::forward<Visitor>(visitor), layer);
+}
+
+inline bool IsValid(const Layer& layer) {
+    return Visit(
+        [](const auto& l) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(l)>, std::monostate>)
+                return false;
+            else
+                return l.IsValid();
+        },
+        layer);
+}
+
+inline std::string Summary(const Layer& layer) {
+    return Visit(
+        [](const auto& l) -> std::string {
+            if constexpr (std::is_same_v<std::decay_t<decltype(l)>, std::monostate>)
+                return "Empty Layer";
+            else
+                return l.Summary();
+        },
+        layer);
+}
+
+inline void AppendSummary(TextBuffer& out, const Layer& layer) {
+    Visit(
+        [&out](const auto& l) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(l)>, std::monostate>)
+                out.Append("Empty Layer");
+            else
+                l.AppendSummary(out);
+        },
+        layer);
+}
+
+} // namespace libpkt
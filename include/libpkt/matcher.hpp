@@ -0,0 +1,119 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace libpkt::match {
+
+// Called for every match; `end` is the offset just past the last matched
+// byte, counted from the start of the stream (or buffer).
+using MatchSink = void (*)(uint32_t pattern, uint64_t end, void* context);
+
+// Position of one stream in the automaton. Keep one per flow direction, e.g.
+// next to the flow's other state; it is small and trivially copyable.
+struct StreamState {
+    uint32_t state = 0;
+    uint64_t offset = 0;
+};
+
+// Multi-pattern exact byte matcher (Aho-Corasick). Patterns are compiled
+// into a DFA over byte equivalence classes while it fits in
+// Config::max_dfa_bytes, otherwise into a sparse automaton with failure
+// links. For small sets, while no match is in progress, a Teddy-style
+// prefilter (nibble lookup tables over the first three bytes of every
+// pattern, 32 positions per step with AVX2) skips ahead to the next position
+// where a pattern can start; it switches itself off for the rest of a scan
+// if candidates turn out to be too dense to pay for.
+//
+// All matches are reported, including overlapping ones. A compiled Matcher
+// is immutable and may be shared between threads.
+class Matcher {
+  public:
+    struct Config {
+        size_t max_dfa_bytes = 64 << 20;
+        // Eight fingerprint buckets saturate quickly; past a few dozen
+        // patterns nearly every position becomes a candidate.
+        size_t prefilter_max_patterns = 64;
+    };
+
+    explicit Matcher(const Config& config);
+    Matcher() : Matcher(Config{}) {}
+
+    // Returns the pattern id (ids count up from 0), or -1 for an empty
+    // pattern or once compiled.
+    int Add(const uint8_t* pattern, size_t length);
+    int Add(std::string_view pattern) {
+        return Add(reinterpret_cast<const uint8_t*>(pattern.data()), pattern.size());
+    }
+    bool Compile();
+
+    // Matches within `data` alone. Returns the number of matches.
+    size_t Scan(const uint8_t* data, size_t length, MatchSink sink, void* context) const;
+    // Continue `stream` with the next chunk, so matches may span chunks.
+    size_t Scan(StreamState& stream, const uint8_t* data, size_t length, MatchSink sink,
+                void* context) const;
+
+    // Anything with Payload()/PayloadLength(), e.g. tcp::Packet.
+    template <typename Packet>
+    size_t ScanPayload(StreamState& stream, const Packet& packet, MatchSink sink,
+                       void* context) const {
+        return Scan(stream, packet.Payload(), packet.PayloadLength(), sink, context);
+    }
+
+    size_t PatternCount() const { return m_patternLengths.size(); }
+    size_t PatternLength(uint32_t id) const { return m_patternLengths[id]; }
+    size_t StateCount() const { return m_fail.size(); }
+    bool UsesDFA() const { return !m_dfa.empty(); }
+    bool UsesPrefilter() const { return m_prefilterBytes != 0; }
+
+  private:
+    template <bool DFA>
+    size_t Run(StreamState& stream, const uint8_t* data, size_t length, MatchSink sink,
+               void* context) const;
+    uint32_t NextNFA(uint32_t state, uint8_t byte) const;
+    size_t Report(uint32_t state, uint64_t end, MatchSink sink, void* context) const;
+    // Next position >= pos where a pattern may start, or `length`.
+    size_t Prefilter(const uint8_t* data, size_t pos, size_t length) const;
+
+    Config m_config;
+    bool m_compiled;
+
+    // Patterns, concatenated, until Compile().
+    std::vector<uint8_t> m_patternBytes;
+    std::vector<uint32_t> m_patternOffsets;
+    std::vector<uint32_t> m_patternLengths;
+
+    // Automaton with failure links (always built; the DFA is derived from
+    // it): sparse edges, plus complete rows for the shallowest states.
+    std::vector<uint32_t> m_fail;
+    std::vector<uint32_t> m_edgeBegin; // state -> first edge, StateCount() + 1 entries
+    std::vector<uint8_t> m_edgeBytes;  // sorted per state
+    std::vector<uint32_t> m_edgeTargets;
+    std::vector<uint32_t> m_denseRow; // state -> row of m_dense, or UINT32_MAX
+    std::vector<uint32_t> m_dense;    // complete 256-entry rows, depth <= 1
+    std::vector<uint32_t> m_outputBegin; // state -> first output, including inherited
+    std::vector<uint32_t> m_outputs;
+
+    // DFA over byte classes: entries are target * m_classCount, with the
+    // top bit set when the target state has outputs.
+    uint16_t m_classes[256];
+    uint32_t m_classCount;
+    std::vector<uint32_t> m_dfa;
+
+    // Teddy tables: bit b of lo/hi[k][nibble] set if some pattern in bucket
+    // b has that nibble at byte k. 0 disables the prefilter.
+    size_t m_prefilterBytes;
+    alignas(32) uint8_t m_teddyLo[3][32];
+    alignas(32) uint8_t m_teddyHi[3][32];
+};
+
+} // namespace libpkt::match
@@ -0,0 +1,118 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "arp.hpp"
+#include "frame.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace libpkt::arp {
+
+struct Neighbor {
+    uint32_t ip; // host byte order
+    uint8_t mac[6];
+    uint64_t first_seen_ns; // when the current MAC was first seen
+    uint64_t last_seen_ns;
+    uint32_t changes; // MAC changes since the entry was created
+};
+
+// IPv4 -> MAC table learned from the sender fields of ARP requests, replies
+// and gratuitous announcements (probes from 0.0.0.0 are ignored).
+//
+// Lookups never take a lock: each slot is a seqlock, so a reader retries
+// only if it raced with an update of that very slot, and a table-wide
+// sequence number makes readers retry while entries are being moved by a
+// removal. Updates and Expire() serialize on a mutex that readers never
+// touch. A MAC change is reported as a Conflict when the old binding was
+// still being seen within `conflict_window_ns` (two stations claiming one
+// address, the signature of ARP spoofing) and as Changed otherwise.
+class NeighborCache {
+  public:
+    enum class Event : uint8_t { New, Changed, Conflict, Removed };
+
+    // `previous` is the replaced MAC for Changed and Conflict, else nullptr.
+    // Called with the update lock held; must not update the cache.
+    using EventSink = void (*)(Event event, const Neighbor& neighbor, const uint8_t* previous,
+                               void* context);
+
+    struct Config {
+        size_t capacity = 4096; // rounded up to a power of two
+        uint64_t max_age_ns = 1'200'000'000'000;
+        uint64_t conflict_window_ns = 60'000'000'000;
+        EventSink sink = nullptr;
+        void* context = nullptr;
+    };
+
+    struct Stats {
+        uint64_t updates = 0; // refreshes of an unchanged binding
+        uint64_t inserts = 0;
+        uint64_t changes = 0;
+        uint64_t conflicts = 0;
+        uint64_t expired = 0;
+        uint64_t evictions = 0; // removed to make room
+        uint64_t ignored = 0;   // probes, non-Ethernet/IPv4, bad sender MAC
+    };
+
+    explicit NeighborCache(const Config& config);
+    NeighborCache() : NeighborCache(Config{}) {}
+
+    // Learn from an ARP packet or an Ethernet frame carrying one; false if
+    // nothing was learned.
+    bool Learn(const Packet& arp, uint64_t now_ns);
+    bool Learn(const FrameView& frame);
+    // Record that `ip` is at `mac`; false for unusable bindings.
+    bool Update(uint32_t ip, const uint8_t* mac, uint64_t now_ns);
+
+    // Safe to call from any number of threads concurrently with updates.
+    bool Lookup(uint32_t ip, Neighbor& out) const;
+    bool Lookup(uint32_t ip, uint8_t* mac) const;
+
+    // Remove entries not seen for max_age_ns, examining at most `budget`
+    // slots per call; returns how many were removed.
+    size_t Expire(uint64_t now_ns, size_t budget = 1024);
+
+    size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+    Stats GetStats() const;
+
+    NeighborCache(const NeighborCache&) = delete;
+    NeighborCache& operator=(const NeighborCache&) = delete;
+
+  private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0}; // odd while being written
+        std::atomic<uint32_t> ip{0};  // 0 marks an empty slot
+        std::atomic<uint64_t> mac{0}; // low 48 bits, first octet lowest
+        std::atomic<uint64_t> first_ns{0};
+        std::atomic<uint64_t> last_ns{0};
+        std::atomic<uint32_t> changes{0};
+    };
+
+    size_t Home(uint32_t ip) const;
+    // Consistent copy of a slot; false if it is empty.
+    bool Read(const Slot& slot, Neighbor& out) const;
+    void Write(Slot& slot, const Neighbor& value);
+    void Erase(size_t slot);
+    void Emit(Event event, const Neighbor& neighbor, const uint8_t* previous);
+
+    Config m_config;
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    std::atomic<uint32_t> m_layout; // odd while a removal moves entries
+    std::atomic<size_t> m_size;
+
+    mutable std::mutex m_mutex; // serializes writers
+    Stats m_stats;
+    size_t m_hand;
+};
+
+} // namespace libpkt::arp
@@ -0,0 +1,173 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace libpkt::netflow {
+
+enum class Format : uint16_t { NetFlowV9 = 9, IPFIX = 10 };
+
+struct FlowRecord {
+    FlowKey key;
+    uint64_t first_ns = 0; // CLOCK_REALTIME of first/last packet
+    uint64_t last_ns = 0;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint8_t tcp_flags = 0; // OR of all TCP flags seen
+};
+
+// Receives finished records; same callback style as DecoderRegistry.
+using RecordSink = void (*)(const FlowRecord& record, void* context);
+
+// Fixed-capacity flow cache. Flows are exported when idle for longer than
+// the idle timeout, every active timeout while still running, and early when
+// the table is under pressure. Time is taken from packet timestamps, so
+// replayed captures age flows exactly like live traffic.
+class FlowTable {
+  public:
+    struct Config {
+        size_t capacity = 1 << 16; // rounded up to a power of two
+        uint64_t active_timeout_ns = 60'000'000'000;
+        uint64_t idle_timeout_ns = 15'000'000'000;
+    };
+
+    FlowTable(const Config& config, RecordSink sink, void* context);
+
+    void Update(const FlowKey& key, uint64_t timestamp_ns, uint32_t bytes, uint8_t tcpFlags);
+    // Decode an Ethernet frame; non-IPv4 frames are ignored.
+    bool Update(const FrameView& frame);
+
+    // Export idle flows, examining at most `budget` slots from where the
+    // previous call stopped so the cost per call stays bounded.
+    void Expire(uint64_t now_ns, size_t budget = 1024);
+
+    // Export and remove every flow.
+    void FlushAll();
+
+    size_t Size() const { return m_size; }
+    size_t Capacity() const { return m_slots.size(); }
+
+  private:
+    struct Slot {
+        FlowRecord record;
+        uint64_t hash;
+        bool used;
+    };
+
+    size_t Home(uint64_t hash) const { return hash & (m_slots.size() - 1); }
+    void Emit(const FlowRecord& record) { m_sink(record, m_context); }
+    void Erase(size_t slot);
+
+    Config m_config;
+    RecordSink m_sink;
+    void* m_context;
+    std::vector<Slot> m_slots;
+    size_t m_size;
+    size_t m_hand;
+};
+
+// Encodes flow records as IPFIX (RFC 7011) or NetFlow v9 (RFC 3954)
+// messages, packs as many records as fit into each datagram and sends full
+// datagrams in batches, to a UDP collector or (IPFIX) appended to a file. The
+// template set is repeated periodically so collectors can join at any time.
+class Exporter {
+  public:
+    struct Config {
+        Format format = Format::IPFIX;
+        uint32_t observation_domain = 0;
+        size_t max_datagram = 1400;
+        size_t batch = 16;                     // datagrams per sendmmsg()
+        uint32_t template_refresh_messages = 64;
+        uint64_t template_refresh_ns = 30'000'000'000;
+    };
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t messages = 0;
+        uint64_t send_errors = 0;
+    };
+
+    static constexpr uint16_t TemplateId = 256;
+
+    explicit Exporter(const Config& config);
+    Exporter() : Exporter(Config{}) {}
+    ~Exporter();
+
+    // `host` may be any IPv4/IPv6 address or name.
+    bool OpenUDP(const std::string& host, uint16_t port);
+    // IPFIX only: messages are appended back to back (RFC 5655) and split
+    // again by their length field. A NetFlow v9 header has no length, so a
+    // v9 file could not be read back; OpenFile() refuses it (EINVAL).
+    bool OpenFile(const std::string& path);
+    void Close();
+
+    void Export(const FlowRecord& record);
+    // Finish the current message and send everything queued.
+    bool Flush();
+
+    const Stats& GetStats() const { return m_stats; }
+
+    // RecordSink adapter: FlowTable(config, &Exporter::Sink, &exporter).
+    static void Sink(const FlowRecord& record, void* exporter) {
+        static_cast<Exporter*>(exporter)->Export(record);
+    }
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+  private:
+    void BeginMessage(uint64_t now_ns);
+    void FinishMessage();
+    bool SendQueued();
+
+    Config m_config;
+    int m_fd;
+    bool m_isFile;
+    Stats m_stats;
+    uint32_t m_sequence;
+    uint64_t m_startNs;
+    uint64_t m_lastTemplateNs;
+    uint32_t m_messagesSinceTemplate;
+
+    std::vector<std::vector<uint8_t>> m_queue; // finished datagrams
+    size_t m_queued;
+    std::vector<uint8_t>* m_current; // message being filled, or nullptr
+    size_t m_dataSetOffset;          // start of the open data set, 0 if none
+    uint16_t m_recordsInMessage;
+};
+
+// Decodes IPFIX and NetFlow v9 messages into FlowRecords, learning templates
+// as they arrive. Unknown fields are skipped; records for templates not seen
+// yet are dropped.
+class Collector {
+  public:
+    // Returns the number of records decoded, or -1 for a malformed message.
+    int Feed(const uint8_t* data, size_t length, RecordSink sink, void* context);
+
+    size_t TemplateCount() const { return m_templates.size(); }
+
+  private:
+    struct Field {
+        uint16_t id;
+        uint16_t length;
+    };
+    using TemplateKey = std::pair<uint32_t, uint16_t>; // domain, template id
+
+    std::map<TemplateKey, std::vector<Field>> m_templates;
+};
+
+} // namespace libpkt::netflow
@@ -0,0 +1,116 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "format.hpp"
+#include "frame.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace libpkt::output {
+
+enum class Format : uint8_t {
+    Text, // timestamp, then the layer summaries joined by " | "
+    JSON, // one object per line
+    CSV,  // fixed columns, see CSVHeader
+};
+
+inline constexpr std::string_view CSVHeader = "ts,len,src_mac,dst_mac,ethertype,src_ip,dst_ip,"
+                                              "proto,src_port,dst_port,tcp_flags,icmp_type,"
+                                              "icmp_code\n";
+
+// Append one newline-terminated record describing `frame`. JSON omits the
+// fields a frame does not have; CSV leaves those columns empty. A non-first
+// IPv4 fragment has addresses and protocol but no ports, flags or ICMP type;
+// JSON gives its "frag_offset" instead.
+void AppendFrame(TextBuffer& out, Format format, const FrameView& frame);
+
+// Writes formatted records to a file descriptor through a few large buffers,
+// so the per-packet cost is formatting into memory and the write() cost is
+// paid once per buffer. In async mode full buffers are written by a
+// background thread; when all buffers are in flight the producer waits.
+// Write(), WriteRaw(), Flush() and GetStats() must be called from one thread.
+class Sink {
+  public:
+    struct Config {
+        Format format = Format::Text;
+        size_t buffer_size = 1 << 20;
+        bool async = false;
+        size_t buffers = 4; // async only
+        bool csv_header = true;
+    };
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t bytes = 0;  // written to the descriptor
+        uint64_t writes = 0; // write() calls
+        uint64_t write_errors = 0;
+        uint64_t stalls = 0; // producer waited for a free buffer
+    };
+
+    explicit Sink(const Config& config);
+    Sink() : Sink(Config{}) {}
+    ~Sink();
+
+    // Create or truncate `path`.
+    bool Open(const std::string& path);
+    // Write to an existing descriptor, e.g. STDOUT_FILENO; it is not closed.
+    bool Attach(int fd);
+    void Close();
+    bool IsOpen() const { return m_fd >= 0; }
+
+    void Write(const FrameView& frame);
+    // A record formatted by the caller, including its trailing newline.
+    void WriteRaw(std::string_view record);
+    // Write out everything buffered so far; false if any write failed.
+    bool Flush();
+
+    Stats GetStats() const;
+
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+
+  private:
+    // Longest record AppendFrame() can produce, with room to spare.
+    static constexpr size_t MaxFrameRecord = 512;
+
+    void Start(int fd, bool owned);
+    void Reserve(size_t n);
+    void Submit();
+    void WriteAll(const TextBuffer& buffer, Stats& stats) const;
+    void WriterLoop();
+
+    Config m_config;
+    int m_fd;
+    bool m_owned;
+    Stats m_stats;
+
+    std::vector<TextBuffer> m_buffers;
+    size_t m_current;
+
+    // Async state, guarded by m_mutex.
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready; // a buffer was queued, or stop
+    std::condition_variable m_done;  // a buffer was written
+    std::vector<size_t> m_free;
+    std::vector<size_t> m_queue; // ring of full buffer indices
+    size_t m_queueHead;
+    size_t m_queued;
+    bool m_writing;
+    bool m_stop;
+    std::thread m_writer;
+};
+
+} // namespace libpkt::output
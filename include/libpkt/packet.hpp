@@ -12,13 +12,20 @@
 #include <string>
 
 namespace libpkt {
+class TextBuffer;
+
+// Common non-owning view shared by all protocol layers. It is deliberately
+// non-virtual so that every layer stays trivially copyable and can be kept in
+// contiguous arrays; closed-set polymorphism lives in layer.hpp.
+//
+// Each layer's AppendSummary(TextBuffer&) writes the same text as Summary()
+// into a caller-owned buffer, for output paths that must not allocate.
 class Packet {
   public:
     Packet(const uint8_t* data, size_t length);
-    virtual ~Packet();
     const uint8_t* Data() const;
     size_t Length() const;
-    virtual std::string Summary() const;
+    std::string Summary() const;
 
   protected:
     const uint8_t* m_data;
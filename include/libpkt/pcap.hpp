@@ -0,0 +1,64 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libpkt {
+
+// Reader for classic libpcap files (micro- or nanosecond resolution, either
+// byte order). The file is memory-mapped, so returned frames point straight
+// into the mapping and stay valid until Close().
+class PcapReader {
+  public:
+    static constexpr uint32_t LinkTypeEthernet = 1;
+
+    PcapReader() = default;
+    ~PcapReader();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_base != nullptr; }
+
+    uint32_t LinkType() const { return m_linkType; }
+    uint32_t SnapLen() const { return m_snapLen; }
+
+    // Next record, false at end of file or on a truncated record.
+    bool Next(FrameView& frame);
+    // Wire length of the record last returned by Next(); larger than its
+    // captured length if the capture was truncated by a snap length.
+    uint32_t OriginalLength() const { return m_originalLength; }
+
+    // Append up to `max` frames to `out` (cleared first); returns the count.
+    size_t ReadBatch(std::vector<FrameView>& out, size_t max);
+
+    // Restart from the first record.
+    void Rewind();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+  private:
+    uint32_t Read32(const uint8_t* p) const;
+
+    const uint8_t* m_base = nullptr;
+    size_t m_size = 0;
+    size_t m_offset = 0;
+    bool m_swapped = false;
+    bool m_nanosecond = false;
+    uint32_t m_linkType = 0;
+    uint32_t m_snapLen = 0;
+    uint32_t m_originalLength = 0;
+};
+
+} // namespace libpkt
@@ -1,6 +1,7 @@
 // protocol.hpp
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
 
@@ -22,6 +23,48 @@ enum class Protocol : uint8_t {
     Unknown = 255
 };
 
+namespace detail {
+struct ProtocolInfo {
+    Protocol protocol;
+    const char* name;
+};
+
+inline constexpr ProtocolInfo KnownProtocols[] = {
+    {Protocol::HOPOPT, "HOPOPT"}, {Protocol::ICMP, "ICMP"},     {Protocol::IGMP, "IGMP"},
+    {Protocol::TCP, "TCP"},       {Protocol::UDP, "UDP"},       {Protocol::GRE, "GRE"},
+    {Protocol::ESP, "ESP"},       {Protocol::AH, "AH"},         {Protocol::EIGRP, "EIGRP"},
+    {Protocol::OSPF, "OSPF"},     {Protocol::SCTP, "SCTP"},     {Protocol::ICMPv6, "ICMPv6"},
+};
+
+// Dense 256-entry tables indexed by the raw protocol number.
+constexpr std::array<Protocol, 256> MakeProtocolTable() {
+    std::array<Protocol, 256> table{};
+    table.fill(Protocol::Unknown);
+    for (const auto& info : KnownProtocols)
+        table[static_cast<uint8_t>(info.protocol)] = info.protocol;
+    return table;
+}
+
+constexpr std::array<const char*, 256> MakeProtocolNameTable() {
+    std::array<const char*, 256> table{};
+    table.fill("Unknown");
+    for (const auto& info : KnownProtocols)
+        table[static_cast<uint8_t>(info.protocol)] = info.name;
+    return table;
+}
+
+inline constexpr std::array<Protocol, 256> ProtocolTable = MakeProtocolTable();
+inline constexpr std::array<const char*, 256> ProtocolNameTable = MakeProtocolNameTable();
+} // namespace detail
+
+constexpr Protocol ToProtocol(uint8_t raw) {
+    return detail::ProtocolTable[raw];
+}
+
+constexpr const char* ProtocolName(Protocol proto) {
+    return detail::ProtocolNameTable[static_cast<uint8_t>(proto)];
+}
+
 std::string ProtocolToString(Protocol proto);
 
 } // namespace libpkt
@@ -0,0 +1,122 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libpkt {
+
+// User decoder: receives the payload of the layer it was registered on
+// (e.g. the Ethernet payload for an EtherType) plus its registration context.
+using Decoder = void (*)(const uint8_t* data, size_t length, void* context);
+
+struct DecoderEntry {
+    Decoder decoder = nullptr;
+    void* context = nullptr;
+};
+
+// Collision-free hash table for 16-bit keys (EtherTypes, ports), built with
+// hash-and-displace: keys are split into small buckets and each bucket gets a
+// displacement that places all of its keys in free slots. A lookup is two
+// hashes, two loads and one compare, independent of the number of keys.
+class PerfectHash16 {
+  public:
+    // Returns false for more than 65535 keys, or if no perfect hash was found
+    // (practically never).
+    bool Build(const std::vector<uint16_t>& keys);
+
+    // Index of `key` in the vector passed to Build(), or -1.
+    int Find(uint16_t key) const {
+        if (m_table.empty())
+            return -1;
+        uint32_t displacement = m_displacements[Mix(key) & m_bucketMask];
+        uint32_t slot = m_table[Mix(key + displacement) >> m_shift];
+        return (slot & 0xFFFF) == key ? static_cast<int>(slot >> 16) - 1 : -1;
+    }
+
+  private:
+    // MurmurHash3 finalizer.
+    static constexpr uint32_t Mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x85EBCA6Bu;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35u;
+        x ^= x >> 16;
+        return x;
+    }
+
+    std::vector<uint32_t> m_table; // key | (index + 1) << 16, 0 = empty
+    std::vector<uint32_t> m_displacements;
+    uint32_t m_bucketMask = 0;
+    uint32_t m_shift = 31;
+};
+
+// Maps EtherTypes, IP protocol numbers and TCP/UDP ports to decoders.
+// Registration allocates; after Compile() dispatch is allocation-free and
+// resolves each layer with a single table lookup.
+class DecoderRegistry {
+  public:
+    bool RegisterEtherType(uint16_t ethertype, Decoder decoder, void* context = nullptr);
+    bool RegisterIPProtocol(uint8_t protocol, Decoder decoder, void* context = nullptr);
+    bool RegisterTCPPort(uint16_t port, Decoder decoder, void* context = nullptr);
+    bool RegisterUDPPort(uint16_t port, Decoder decoder, void* context = nullptr);
+
+    // Rebuild the lookup tables; call after (re-)registering decoders.
+    bool Compile();
+
+    const DecoderEntry* FindEtherType(uint16_t ethertype) const {
+        return Find(m_etherHash, m_etherEntries, ethertype);
+    }
+    const DecoderEntry* FindIPProtocol(uint8_t protocol) const {
+        return m_ipEntries[protocol].decoder ? &m_ipEntries[protocol] : nullptr;
+    }
+    const DecoderEntry* FindTCPPort(uint16_t port) const {
+        return Find(m_tcpHash, m_tcpEntries, port);
+    }
+    const DecoderEntry* FindUDPPort(uint16_t port) const {
+        return Find(m_udpHash, m_udpEntries, port);
+    }
+
+    // Walk an Ethernet frame down to the most specific registered decoder:
+    // EtherType first, then for IPv4 the TCP/UDP destination and source
+    // port, then the IP protocol. Returns false if no decoder matched.
+    bool Dispatch(const uint8_t* frame, size_t length) const;
+    bool DispatchIPv4(const uint8_t* data, size_t length) const;
+
+  private:
+    struct Registration {
+        uint16_t key;
+        DecoderEntry entry;
+    };
+
+    static bool Upsert(std::vector<Registration>& list, uint16_t key, DecoderEntry entry);
+    static bool Build(const std::vector<Registration>& list, PerfectHash16& hash,
+                      std::vector<DecoderEntry>& entries);
+    static const DecoderEntry* Find(const PerfectHash16& hash,
+                                    const std::vector<DecoderEntry>& entries, uint16_t key) {
+        int idx = hash.Find(key);
+        return idx < 0 ? nullptr : &entries[idx];
+    }
+
+    std::vector<Registration> m_etherRegs;
+    std::vector<Registration> m_tcpRegs;
+    std::vector<Registration> m_udpRegs;
+
+    PerfectHash16 m_etherHash;
+    PerfectHash16 m_tcpHash;
+    PerfectHash16 m_udpHash;
+    std::vector<DecoderEntry> m_etherEntries;
+    std::vector<DecoderEntry> m_tcpEntries;
+    std::vector<DecoderEntry> m_udpEntries;
+    std::array<DecoderEntry, 256> m_ipEntries{};
+};
+
+} // namespace libpkt
@@ -0,0 +1,113 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+#include "interface.hpp"
+#include "latency.hpp"
+#include "pcap.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libpkt {
+
+// Transmits the frames of an Ethernet pcap file on an interface, straight
+// from the file mapping. Every frame gets a deadline from the chosen mode;
+// the pacing loop sleeps until shortly before the next deadline and spins
+// the rest of the way, then hands all frames already due (or due within
+// `batch_window_ns`) to the kernel in one sendmmsg() call.
+//
+// Timing error is the distance between a frame's deadline and the moment its
+// batch was handed to the kernel; it is not recorded at top speed.
+class Replayer {
+  public:
+    enum class Mode : uint8_t {
+        Timed,      // original gaps divided by `speed`
+        PacketRate, // `packet_rate` frames per second
+        BitRate,    // `bit_rate` bits per second of frame data as captured
+        TopSpeed,   // as fast as the socket accepts
+    };
+
+    struct Config {
+        Mode mode = Mode::Timed;
+        double speed = 1.0;
+        double packet_rate = 0;
+        double bit_rate = 0;
+        uint64_t max_gap_ns = 0; // Timed: cap on idle gaps in the capture, 0 for none
+        uint32_t loops = 1;      // 0 repeats until Stop()
+        size_t batch_size = 32;
+        uint64_t batch_window_ns = 20'000;
+        uint64_t spin_ns = 50'000; // busy-wait this close to a deadline
+    };
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t send_calls = 0;
+        uint64_t retries = 0;     // sends repeated after ENOBUFS or EAGAIN
+        uint64_t errors = 0;      // frames the kernel refused, e.g. over the MTU
+        uint64_t elapsed_ns = 0;  // start to the last send
+        uint64_t schedule_ns = 0; // start to the last deadline
+
+        double PacketRate() const { return Rate(packets, elapsed_ns); }
+        double BitRate() const { return Rate(bytes * 8, elapsed_ns); }
+        // What the schedule asked for; 0 at top speed.
+        double TargetPacketRate() const { return Rate(packets, schedule_ns); }
+        double TargetBitRate() const { return Rate(bytes * 8, schedule_ns); }
+
+      private:
+        static double Rate(uint64_t count, uint64_t ns) { return ns ? count * 1e9 / ns : 0; }
+    };
+
+    Replayer(Interface& iface, const Config& config);
+    explicit Replayer(Interface& iface) : Replayer(iface, Config{}) {}
+
+    // Replay the whole capture `loops` times. False if the file is not an
+    // Ethernet capture or the socket failed; Stats cover what was sent.
+    bool Run(PcapReader& reader);
+    bool Run(const std::string& path);
+
+    // Make Run() return after the batch in flight. Safe from other threads
+    // and from signal handlers.
+    void Stop() { m_stop.store(true, std::memory_order_relaxed); }
+
+    const Stats& GetStats() const { return m_stats; }
+    const LatencyHistogram& TimingError() const { return m_timingError; }
+
+    Replayer(const Replayer&) = delete;
+    Replayer& operator=(const Replayer&) = delete;
+
+  private:
+    // Next frame in replay order and its deadline relative to the start.
+    bool Next(PcapReader& reader, FrameView& frame, uint64_t& at);
+    void WaitUntil(uint64_t deadline);
+    bool Transmit(uint64_t start);
+
+    Interface& m_iface;
+    Config m_config;
+    Stats m_stats;
+    LatencyHistogram m_timingError;
+    std::atomic<bool> m_stop;
+
+    // Schedule state.
+    uint32_t m_loop;
+    bool m_loopStart;
+    uint64_t m_index;
+    uint64_t m_bits;
+    uint64_t m_prevTs;
+    uint64_t m_at;
+
+    std::vector<FrameView> m_batch;
+    std::vector<uint64_t> m_deadlines;
+};
+
+} // namespace libpkt
@@ -0,0 +1,190 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace libpkt::ring {
+
+// Single-producer, multi-consumer frame ring in shared memory, so one
+// capture process can feed any number of analysis processes without the
+// kernel copying every frame into one socket queue per process.
+//
+// The ring lives in a memfd (optionally hugetlb-backed) or in a file under a
+// tmpfs/hugetlbfs mount. Consumers attach by path, each claiming a cursor
+// slot, and read frames in place. Frames are variable-length records,
+// 8-byte aligned; a record never wraps, the producer pads to the end of the
+// ring instead.
+//
+// With Policy::Overwrite the producer never waits: a consumer that falls a
+// whole ring behind is overrun, skips to the newest frame and counts the
+// frames it lost. With Policy::Backpressure the producer waits for the
+// slowest attached consumer. Under either policy, consumers whose process
+// exited without detaching are detached automatically: by the producer now
+// and then, and by a consumer that finds every slot taken.
+
+enum class Policy : uint32_t { Overwrite, Backpressure };
+
+// Observable state of one attached consumer, shared with the producer.
+struct ConsumerStatus {
+    pid_t pid;
+    uint64_t lag_bytes; // written but not yet released by the consumer
+    uint64_t frames;
+    uint64_t overruns;  // times the producer lapped the consumer
+    uint64_t lost;      // frames skipped because of overruns
+};
+
+namespace detail {
+struct Header;
+struct Slot;
+} // namespace detail
+
+class Producer {
+  public:
+    struct Config {
+        size_t size = 64 << 20; // frame area, rounded up to a power of two
+        uint32_t max_consumers = 16;
+        Policy policy = Policy::Overwrite;
+        bool huge_pages = false; // memfd only: MFD_HUGETLB, falls back to normal pages
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t oversize = 0; // frames larger than a quarter of the ring, dropped
+        uint64_t waits = 0;    // writes that had to wait for a consumer
+        uint64_t reaped = 0;   // consumers detached after their process exited
+    };
+
+    explicit Producer(const Config& config);
+    Producer() : Producer(Config{}) {}
+    ~Producer();
+
+    // Create the ring in an anonymous memfd (empty `path`) or in the file at
+    // `path`, which is replaced if it exists and removed again by Close().
+    bool Create(const std::string& path = {});
+    // Mark the ring closed so consumers see end of stream, and unmap it.
+    void Close();
+    bool IsOpen() const { return m_header != nullptr; }
+
+    // Path consumers pass to Consumer::Attach(); for a memfd this is the
+    // /proc/<pid>/fd entry of this process.
+    const std::string& Path() const { return m_path; }
+    bool HugePages() const { return m_hugePages; }
+
+    // Copy frames into the ring and publish them; false if a frame was
+    // dropped as oversize. Under backpressure this blocks while full.
+    bool Write(const FrameView& frame);
+    bool Write(std::span<const FrameView> frames);
+
+    const Stats& GetStats() const { return m_stats; }
+    // Attached consumers whose process is still alive.
+    std::vector<ConsumerStatus> Consumers() const;
+
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
+
+  private:
+    bool Map();
+    bool Append(const FrameView& frame);
+    void Publish();
+    uint64_t MinCursor() const;
+    void WaitForSpace(uint64_t end);
+    void Reap();
+
+    Config m_config;
+    Stats m_stats;
+    std::string m_path;
+    bool m_unlink;
+    bool m_hugePages;
+    int m_fd;
+    void* m_map;
+    size_t m_mapSize;
+    detail::Header* m_header;
+    detail::Slot* m_slots;
+    uint8_t* m_data;
+    uint64_t m_mask;
+    uint64_t m_head;  // local copy, published by Publish()
+    uint64_t m_limit; // cursor bound from the last check of the consumers
+    uint64_t m_seq;
+    uint64_t m_publishes;
+    uint64_t m_lastReapNs;
+};
+
+class Consumer {
+  public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t overruns = 0;
+        uint64_t lost = 0;
+    };
+
+    Consumer();
+    ~Consumer();
+
+    // Map the ring and claim a cursor, starting at the newest frame. False if
+    // the path is not a ring or all consumer slots are taken by live
+    // consumers.
+    bool Attach(const std::string& path);
+    void Detach();
+    bool IsAttached() const { return m_header != nullptr; }
+
+    // Next frame, or false if none is ready. The view points into the ring
+    // and is released (may be overwritten) by the next call to Next() or
+    // NextBatch().
+    bool Next(FrameView& frame);
+    // Up to `max` frames into `out` (cleared first), released together by the
+    // next call.
+    size_t NextBatch(std::vector<FrameView>& out, size_t max);
+
+    // With Policy::Overwrite, whether the frames returned by the last call
+    // are still intact; check after processing them to detect a lap.
+    bool Intact() const;
+
+    // Block until a frame is ready, the producer closes the ring, or
+    // `timeoutMs` passes (-1 waits forever). True if a frame is ready.
+    bool Wait(int timeoutMs);
+    // The producer has closed the ring and every frame has been read.
+    bool Finished() const;
+
+    uint64_t Lag() const; // bytes written but not yet consumed
+    const Stats& GetStats() const { return m_stats; }
+
+    Consumer(const Consumer&) = delete;
+    Consumer& operator=(const Consumer&) = delete;
+
+  private:
+    // `first`: nothing has been handed out since the last release.
+    bool Read(FrameView& frame, bool first);
+    void Release();
+    // Consistent snapshot of the head position and its sequence number.
+    void Head(uint64_t& pos, uint64_t& seq) const;
+
+    int m_fd; // kept open: it holds the slot lock
+    void* m_map;
+    size_t m_mapSize;
+    detail::Header* m_header;
+    detail::Slot* m_slot;
+    const uint8_t* m_data;
+    uint64_t m_size;
+    uint64_t m_pos;   // next record to read
+    uint64_t m_first; // start of the frames handed out by the last call
+    uint64_t m_expected; // sequence number of the record at m_pos
+    Stats m_stats;
+};
+
+} // namespace libpkt::ring
@@ -0,0 +1,66 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace libpkt::rss {
+
+inline constexpr size_t KeySize = 40;
+
+// Microsoft's reference RSS key, used by most NIC drivers by default.
+inline constexpr std::array<uint8_t, KeySize> DefaultKey = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+    0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+    0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa};
+
+// A key with a 16-bit period makes Toeplitz symmetric: swapping source and
+// destination (addresses and ports) yields the same hash.
+inline constexpr std::array<uint8_t, KeySize> SymmetricKey = {
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+    0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a};
+
+// Toeplitz hash with one precomputed 256-entry table per input byte, so each
+// input byte costs a single lookup and XOR.
+class Toeplitz {
+  public:
+    // Longest input a 40-byte key can hash (IPv6 4-tuple).
+    static constexpr size_t MaxInput = KeySize - 4;
+
+    explicit Toeplitz(std::span<const uint8_t, KeySize> key = DefaultKey);
+
+    uint32_t Hash(const uint8_t* input, size_t length) const;
+
+    // NIC-compatible hash of the IPv4 2-tuple, or 4-tuple if `withPorts`.
+    uint32_t Hash(const FlowKey& key, bool withPorts = true) const;
+
+  private:
+    std::vector<std::array<uint32_t, 256>> m_tables;
+};
+
+// Fast non-cryptographic hash with Hash(key) == Hash(key.Reversed()).
+uint32_t SymmetricHash(const FlowKey& key);
+
+// Hashes computed straight from Ethernet frames; 0 for non-IPv4 frames.
+uint32_t HashFrame(const Toeplitz& toeplitz, const uint8_t* frame, size_t length);
+uint32_t SymmetricHashFrame(const uint8_t* frame, size_t length);
+
+// Batch variants: out[i] receives the hash of frames[i]. Headers are decoded
+// with simd::ParseHeaders. Ports are included for TCP and UDP only.
+void HashBatch(const Toeplitz& toeplitz, std::span<const FrameView> frames, uint32_t* out);
+void SymmetricHashBatch(std::span<const FrameView> frames, uint32_t* out);
+
+} // namespace libpkt::rss
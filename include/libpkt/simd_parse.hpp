@@ -0,0 +1,50 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libpkt::simd {
+
+inline constexpr size_t MaxLanes = 16;
+
+enum class Level : uint8_t { Scalar, AVX2, AVX512 };
+
+// Header fields of up to MaxLanes frames, one lane per frame. A field is zero
+// unless its layer's bit is set in the matching lane mask. Values are
+// identical to what EthernetFrame, IPv4Packet, tcp::Packet and udp::Packet
+// report for the same frame.
+struct HeaderLanes {
+    alignas(64) uint32_t src_ip[MaxLanes]; // host byte order
+    alignas(64) uint32_t dst_ip[MaxLanes];
+    alignas(32) uint16_t ethertype[MaxLanes];
+    alignas(32) uint16_t src_port[MaxLanes];
+    alignas(32) uint16_t dst_port[MaxLanes];
+    alignas(16) uint8_t ihl[MaxLanes]; // 32-bit words
+    alignas(16) uint8_t protocol[MaxLanes];
+    alignas(16) uint8_t tcp_flags[MaxLanes];
+
+    uint32_t ethernet_valid; // bit i = lane i
+    uint32_t ipv4_valid;
+    uint32_t tcp_valid;
+    uint32_t udp_valid;
+};
+
+// Best level supported by the running CPU (AVX-512 needs F, VL and BW).
+Level DetectLevel();
+
+// Parse `count` (<= MaxLanes) frames with the best available kernel.
+void ParseHeaders(const FrameView* frames, size_t count, HeaderLanes& out);
+
+// Same with an explicit kernel; falls back to scalar if unsupported.
+void ParseHeaders(Level level, const FrameView* frames, size_t count, HeaderLanes& out);
+
+} // namespace libpkt::simd
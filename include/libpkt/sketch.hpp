@@ -0,0 +1,157 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libpkt::sketch {
+
+// Which FlowKey fields identify an item.
+enum Fields : uint8_t {
+    SrcIP = 1 << 0,
+    DstIP = 1 << 1,
+    SrcPort = 1 << 2,
+    DstPort = 1 << 3,
+    Proto = 1 << 4,
+    FiveTuple = SrcIP | DstIP | SrcPort | DstPort | Proto,
+};
+
+// `key` with every field not in `fields` zeroed.
+FlowKey Project(const FlowKey& key, uint8_t fields);
+
+// 64-bit hash of a (projected) key.
+uint64_t HashKey(const FlowKey& key);
+
+// Count-min sketch: Estimate() never underestimates and, with probability
+// 1 - 2^-depth, overestimates by at most 2N/width for a stream of total N.
+class CountMin {
+  public:
+    CountMin(size_t width, size_t depth);
+
+    void Add(uint64_t hash, uint64_t count = 1);
+    uint64_t Estimate(uint64_t hash) const;
+    uint64_t Total() const { return m_total; }
+
+    // Both sketches must have the same dimensions.
+    bool Merge(const CountMin& other);
+    void Reset();
+
+  private:
+    size_t m_width;
+    size_t m_depth;
+    uint64_t m_total;
+    std::vector<uint64_t> m_counters; // depth rows of width counters
+};
+
+// Space-saving top-k: tracks at most `capacity` keys. Every key with true
+// count > N/capacity is present, and count - error <= true count <= count.
+class SpaceSaving {
+  public:
+    struct Entry {
+        FlowKey key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    explicit SpaceSaving(size_t capacity);
+
+    void Add(const FlowKey& key, uint64_t hash, uint64_t count = 1);
+
+    // Tracked entries, highest count first (allocates; not for the hot path).
+    std::vector<Entry> Top() const;
+    size_t Capacity() const { return m_capacity; }
+
+    void Merge(const SpaceSaving& other);
+    void Reset();
+
+  private:
+    // Counts live in the heap nodes so sifting never chases entry indices.
+    struct HeapNode {
+        uint64_t count;
+        uint32_t entry;
+    };
+
+    void SiftDown(size_t pos);
+    void Place(size_t pos, HeapNode node);
+    size_t FindSlot(const FlowKey& key, uint64_t hash) const;
+    void EraseSlot(size_t slot);
+    void InsertSlot(uint64_t hash, uint32_t entry);
+
+    size_t m_capacity;
+    std::vector<FlowKey> m_keys; // per entry
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint64_t> m_errors;
+    std::vector<HeapNode> m_heap;    // min-heap by count
+    std::vector<uint32_t> m_heapPos; // entry -> heap position
+    std::vector<uint32_t> m_index;   // open addressing: entry + 1, 0 = empty
+    size_t m_indexMask;
+};
+
+// HyperLogLog distinct counter with 2^precision one-byte registers
+// (standard error ~1.04 / sqrt(2^precision)).
+class HyperLogLog {
+  public:
+    explicit HyperLogLog(uint8_t precision = 12);
+
+    void Add(uint64_t hash);
+    double Estimate() const;
+
+    bool Merge(const HyperLogLog& other);
+    void Reset();
+
+  private:
+    uint8_t m_precision;
+    std::vector<uint8_t> m_registers;
+};
+
+// Per-thread traffic summary: packet/byte heavy hitters and a distinct
+// counter, each keyed on its own set of fields. Memory is fixed at
+// construction; instances with the same Config can be merged.
+class TrafficSketch {
+  public:
+    struct Config {
+        uint8_t heavy_fields = SrcIP;
+        uint8_t distinct_fields = DstIP | DstPort;
+        size_t cm_width = 4096;
+        size_t cm_depth = 4;
+        size_t top_k = 64;
+        uint8_t hll_precision = 12;
+    };
+
+    explicit TrafficSketch(const Config& config);
+    TrafficSketch() : TrafficSketch(Config{}) {}
+
+    void Update(const FlowKey& key, uint32_t bytes);
+    // Decode an Ethernet frame; non-IPv4 frames are ignored.
+    bool Update(const uint8_t* frame, size_t length);
+
+    uint64_t EstimatePackets(const FlowKey& key) const;
+    uint64_t EstimateBytes(const FlowKey& key) const;
+    // Heavy hitters by bytes.
+    std::vector<SpaceSaving::Entry> TopTalkers() const { return m_top.Top(); }
+    double DistinctCount() const { return m_distinct.Estimate(); }
+    uint64_t Packets() const { return m_packets.Total(); }
+
+    const Config& GetConfig() const { return m_config; }
+
+    bool Merge(const TrafficSketch& other);
+    void Reset();
+
+  private:
+    Config m_config;
+    CountMin m_packets;
+    CountMin m_bytes;
+    SpaceSaving m_top;
+    HyperLogLog m_distinct;
+};
+
+} // namespace libpkt::sketch
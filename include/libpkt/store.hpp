@@ -0,0 +1,154 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace libpkt::store {
+
+// A store is a directory of numbered segments. Each segment is a plain
+// nanosecond pcap file (00000001.pcap) readable by any tool, plus a sidecar
+// index (00000001.idx) written when the segment is sealed:
+//
+//   - the file offset of every packet,
+//   - time buckets giving the packet range that can hold a given instant,
+//   - sorted per-host and per-flow posting lists of packet numbers,
+//   - a bloom filter over all hosts and flows of the segment.
+//
+// Queries map only the segments whose time span overlaps and whose bloom
+// filter admits the key, and then read just the listed packets.
+
+class Writer {
+  public:
+    struct Config {
+        uint64_t segment_bytes = 256ull << 20; // at most 4 GiB
+        uint64_t bucket_ns = 100'000'000;      // widened for sparse segments
+        size_t write_buffer = 4 << 20;
+        uint32_t bloom_bits_per_key = 10;
+    };
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t bytes = 0; // segment bytes, headers included
+        uint64_t segments = 0;
+        uint64_t index_bytes = 0;
+        uint64_t write_errors = 0;
+    };
+
+    explicit Writer(const Config& config);
+    Writer() : Writer(Config{}) {}
+    ~Writer();
+
+    // Create `directory` if needed; numbering continues after any segments
+    // already there.
+    bool Open(const std::string& directory);
+    // Seal the open segment.
+    void Close();
+
+    // Store a frame; `wire_length` is its length before any truncation
+    // (the pcap orig_len). A failed write drops, from segment and index alike,
+    // every packet that had not reached the file yet.
+    bool Append(const FrameView& frame, size_t wire_length);
+    bool Append(const FrameView& frame) { return Append(frame, frame.length); }
+    // Finish the open segment now and write its index; the next Append()
+    // starts a new one. A segment left without packets is removed.
+    bool Seal();
+
+    const Stats& GetStats() const { return m_stats; }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+  private:
+    bool StartSegment();
+    bool FlushBuffer();
+    void Rollback();
+    void Abandon();
+    bool WriteIndex();
+
+    Config m_config;
+    std::string m_directory;
+    uint32_t m_nextSegment;
+    int m_fd; // open segment, -1 if none
+    uint64_t m_segmentBytes;
+    Stats m_stats;
+    std::vector<uint8_t> m_buffer;
+    size_t m_buffered;
+    size_t m_flushedPackets; // packets of the open segment already on disk
+
+    // Index of the open segment.
+    std::vector<uint64_t> m_timestamps;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_hostPostings; // host << 32 | packet
+    std::vector<std::pair<uint64_t, uint32_t>> m_flowPostings;
+};
+
+// Packets matching every condition set. Hosts and flows match in either
+// direction; times are inclusive.
+struct Query {
+    uint64_t from_ns = 0;
+    uint64_t to_ns = UINT64_MAX;
+    bool has_host = false;
+    uint32_t host = 0; // host byte order
+    bool has_flow = false;
+    FlowKey flow;
+};
+
+class Reader {
+  public:
+    using Visitor = void (*)(const FrameView& frame, void* context);
+
+    struct Stats {
+        uint64_t segments = 0;
+        uint64_t skipped_time = 0;  // segment outside the time range
+        uint64_t skipped_bloom = 0; // key rejected by the bloom filter
+        uint64_t candidates = 0;    // packets examined
+        uint64_t matches = 0;
+    };
+
+    Reader() = default;
+    ~Reader();
+
+    // Map every sealed segment of `directory`. Segments still being written
+    // have no index yet and are left out.
+    bool Open(const std::string& directory);
+    void Close();
+
+    size_t SegmentCount() const { return m_segments.size(); }
+
+    // Visit the matching packets in store order; returns how many matched.
+    size_t Run(const Query& query, Visitor visitor, void* context);
+
+    const Stats& GetStats() const { return m_stats; }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+  private:
+    struct Segment {
+        const uint8_t* index;
+        size_t index_size;
+        const uint8_t* data; // the pcap file
+        size_t data_size;
+    };
+
+    size_t RunSegment(const Segment& segment, const Query& query, Visitor visitor,
+                      void* context);
+
+    std::vector<Segment> m_segments;
+    Stats m_stats;
+};
+
+} // namespace libpkt::store
@@ -14,10 +14,85 @@
 
 namespace libpkt::tcp {
 
+enum Flag : uint8_t {
+    FIN = 0x01,
+    SYN = 0x02,
+    RST = 0x04,
+    PSH = 0x08,
+    ACK = 0x10,
+    URG = 0x20,
+    ECE = 0x40,
+    CWR = 0x80,
+};
+
+enum class OptionKind : uint8_t {
+    End = 0,
+    NOP = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+    Timestamp = 8,
+};
+
+// One option; `data` points into the packet and excludes kind and length.
+struct Option {
+    OptionKind kind;
+    uint8_t length;
+    const uint8_t* data;
+};
+
+// Walks the options area without allocating. Iteration stops at End, at the
+// end of the area, or at the first malformed option.
+class OptionIterator {
+  public:
+    OptionIterator() : m_pos(nullptr), m_end(nullptr), m_current{} {}
+    OptionIterator(const uint8_t* begin, const uint8_t* end);
+
+    const Option& operator*() const { return m_current; }
+    const Option* operator->() const { return &m_current; }
+    OptionIterator& operator++();
+    bool operator==(const OptionIterator& other) const { return m_pos == other.m_pos; }
+
+  private:
+    void Load();
+
+    const uint8_t* m_pos; // start of the current option, nullptr when done
+    const uint8_t* m_end;
+    Option m_current;
+};
+
+// Range over an options area, usable in a range-for.
+class Options {
+  public:
+    Options(const uint8_t* begin, const uint8_t* end) : m_begin(begin), m_end(end) {}
+
+    OptionIterator begin() const { return OptionIterator(m_begin, m_end); }
+    OptionIterator end() const { return OptionIterator(); }
+    const uint8_t* Data() const { return m_begin; }
+    size_t Size() const { return m_end - m_begin; }
+
+  private:
+    const uint8_t* m_begin;
+    const uint8_t* m_end;
+};
+
+// The options most analyses care about, decoded in one pass.
+struct ParsedOptions {
+    uint16_t mss = 0;
+    uint8_t window_scale = 0;
+    bool has_window_scale = false;
+    bool sack_permitted = false;
+    bool has_timestamp = false;
+    uint32_t ts_val = 0;
+    uint32_t ts_ecr = 0;
+    uint8_t sack_blocks = 0; // up to 4 left/right edge pairs
+    uint32_t sack[4][2] = {};
+};
+
 class Packet : public libpkt::Packet {
   public:
     Packet(const uint8_t* data, size_t length);
-    ~Packet() override;
 
     uint16_t SrcPort() const;
     uint16_t DstPort() const;
@@ -26,12 +101,24 @@ class Packet : public libpkt::Packet {
     uint8_t DataOffset() const;
     uint8_t Flags() const;
     uint16_t Window() const;
+
+    // Options area (between the fixed header and the data offset).
+    Options GetOptions() const;
+    ParsedOptions ParseOptions() const;
+    // Timestamp option only, with a fast path for the usual NOP,NOP,TS layout.
+    bool GetTimestamp(uint32_t& tsVal, uint32_t& tsEcr) const;
+
+    const uint8_t* Payload() const;
+    size_t PayloadLength() const;
     bool IsValid() const;
 
-    std::string Summary() const override;
+    std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
 
   private:
     bool m_valid;
+
+    size_t PayloadOffset() const;
 };
 
 } // namespace libpkt::tcp
@@ -0,0 +1,129 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#pragma once
+
+#include "flow.hpp"
+#include "frame.hpp"
+#include "latency.hpp"
+#include "tcp.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libpkt::tcp {
+
+// Passive RTT measurement from a capture point between two TCP endpoints.
+// Every sample is the time from a packet passing the capture point to the
+// packet acknowledging it passing back, i.e. the round trip to the far side:
+//
+//  - HandshakeServer: SYN -> SYN/ACK (capture point to responder and back)
+//  - HandshakeClient: SYN/ACK -> ACK (capture point to initiator and back)
+//  - Data:            segment end sequence -> first ACK covering it
+//  - Timestamp:       TSval first seen -> first TSecr echoing it
+//
+// Retransmitted SYNs, SYN/ACKs and segments invalidate the samples they
+// would make ambiguous (Karn's rule). State lives in a fixed-size table and
+// each connection keeps at most 4 outstanding marks per direction.
+class RttTracker {
+  public:
+    enum class Sample : uint8_t { HandshakeServer, HandshakeClient, Data, Timestamp };
+    static constexpr size_t SampleKinds = 4;
+
+    // `key` has the lower (address, port) endpoint as source.
+    using SampleSink = void (*)(const FlowKey& key, Sample kind, uint64_t rtt_ns, void* context);
+
+    struct Config {
+        size_t capacity = 1 << 16; // connections, rounded up to a power of two
+        uint64_t idle_timeout_ns = 120'000'000'000;
+        SampleSink sink = nullptr; // optional, called for every sample
+        void* context = nullptr;
+    };
+
+    struct Stats {
+        uint64_t connections = 0;
+        uint64_t evictions = 0;
+        uint64_t karn_discards = 0;
+        uint64_t clock_discards = 0; // samples whose timestamps went backwards
+    };
+
+    explicit RttTracker(const Config& config);
+    RttTracker() : RttTracker(Config{}) {}
+
+    // Decode an Ethernet frame; returns false for non-TCP/IPv4 frames.
+    bool Update(const FrameView& frame);
+    void Update(const FlowKey& key, const Packet& tcp, size_t payloadLength, uint64_t timestamp_ns);
+
+    // Drop idle connections, examining at most `budget` slots per call.
+    void Expire(uint64_t now_ns, size_t budget = 1024);
+
+    const LatencyHistogram& Histogram(Sample kind) const {
+        return m_histograms[static_cast<size_t>(kind)];
+    }
+    const Stats& GetStats() const { return m_stats; }
+    size_t Size() const { return m_size; }
+
+  private:
+    static constexpr size_t Pending = 4;
+
+    struct Mark {
+        uint32_t value; // end sequence number or TSval
+        uint64_t ns;
+    };
+
+    // Small FIFO of outstanding marks, oldest first.
+    struct Queue {
+        Mark marks[Pending];
+        uint8_t head;
+        uint8_t count;
+
+        void Push(uint32_t value, uint64_t ns);
+        // Pop every mark with value <= v (mod 2^32); returns the newest one.
+        bool Acknowledge(uint32_t v, bool exact, Mark& out);
+    };
+
+    struct Direction {
+        Queue data;
+        Queue timestamps;
+        uint32_t next_seq; // highest sequence sent + 1
+        uint32_t last_tsval;
+        bool seq_valid;
+        bool ts_valid;
+        bool fin;
+    };
+
+    enum Handshake : uint8_t { None, SynSeen, SynAckSeen, Done };
+
+    struct Connection {
+        FlowKey key; // canonical orientation: lower endpoint first
+        uint64_t hash;
+        uint64_t last_ns;
+        uint64_t syn_ns;    // 0 once retransmitted
+        uint64_t synack_ns; // 0 once retransmitted
+        uint32_t client_isn;
+        uint32_t server_isn;
+        Handshake handshake;
+        uint8_t client_dir;
+        bool used;
+        Direction dirs[2];
+    };
+
+    size_t Home(uint64_t hash) const { return hash & (m_slots.size() - 1); }
+    Connection* Find(const FlowKey& key, uint64_t hash, bool create);
+    void Erase(size_t slot);
+    void Emit(const Connection& conn, Sample kind, uint64_t sent_ns, uint64_t now_ns);
+
+    Config m_config;
+    Stats m_stats;
+    std::vector<Connection> m_slots;
+    size_t m_size;
+    size_t m_hand;
+    LatencyHistogram m_histograms[SampleKinds];
+};
+
+} // namespace libpkt::tcp
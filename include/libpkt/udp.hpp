@@ -16,14 +16,18 @@ namespace libpkt::udp {
 class Packet : public libpkt::Packet {
   public:
     Packet(const uint8_t* data, size_t length);
-    ~Packet() override;
 
     uint16_t SrcPort() const;
     uint16_t DstPort() const;
+    uint16_t DatagramLength() const;
+
+    const uint8_t* Payload() const;
+    size_t PayloadLength() const;
 
     bool IsValid() const;
 
-    std::string Summary() const override;
+    std::string Summary() const;
+    void AppendSummary(TextBuffer& out) const;
 
   private:
     bool m_valid;
@@ -13,4 +13,11 @@
 namespace libpkt::checksum {
 // Compute IP checksum (RFC 1071)
 uint16_t IPChecksum(const uint8_t* data, size_t length);
+
+// Incrementally update a checksum field, as stored in the packet, after
+// `length` bytes it covers changed from `before` to `after` (RFC 1624).
+// `length` must be even and the bytes start at an even offset of the
+// checksummed data.
+uint16_t UpdateChecksum(uint16_t checksum, const uint8_t* before, const uint8_t* after,
+                        size_t length);
 } // namespace libpkt::checksum
@@ -0,0 +1,495 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/anonymize.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/protocol.hpp"
+#include "libpkt/utils/checksum.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/random.h>
+#include <vector>
+
+namespace libpkt {
+namespace {
+constexpr uint16_t EtherTypeQinQ = 0x88A8;
+constexpr size_t IPv6HeaderSize = 40;
+
+// PRF domains, so IPv4 prefixes, IPv6 prefixes and MACs never share inputs.
+constexpr uint64_t Domain4 = 4;
+constexpr uint64_t Domain6 = 6;
+constexpr uint64_t DomainMAC = 0xEE;
+
+constexpr uint64_t Golden = 0x9E3779B97F4A7C15ull;
+
+uint64_t Rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+void SipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1;
+    v1 = Rotl(v1, 13);
+    v1 ^= v0;
+    v0 = Rotl(v0, 32);
+    v2 += v3;
+    v3 = Rotl(v3, 16);
+    v3 ^= v2;
+    v0 += v3;
+    v3 = Rotl(v3, 21);
+    v3 ^= v0;
+    v2 += v1;
+    v1 = Rotl(v1, 17);
+    v1 ^= v2;
+    v2 = Rotl(v2, 32);
+}
+
+uint64_t Load64BE(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = v << 8 | p[i];
+    return v;
+}
+
+void Store64BE(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i, v >>= 8)
+        p[i] = static_cast<uint8_t>(v);
+}
+
+// The first `bits` bits of a 64-bit word, the rest cleared.
+uint64_t Prefix(uint64_t word, unsigned bits) {
+    return bits == 0 ? 0 : word & ~(~0ull >> bits);
+}
+
+void FixChecksum(uint8_t* field, const uint8_t* before, const uint8_t* after, size_t length) {
+    uint16_t sum;
+    std::memcpy(&sum, field, 2);
+    sum = checksum::UpdateChecksum(sum, before, after, length);
+    std::memcpy(field, &sum, 2);
+}
+
+// UDP keeps 0 for "no checksum" and sends a computed 0 as 0xFFFF.
+void FixUDPChecksum(uint8_t* field, const uint8_t* before, const uint8_t* after,
+                    size_t length) {
+    if (field[0] == 0 && field[1] == 0)
+        return;
+    FixChecksum(field, before, after, length);
+    if (field[0] == 0 && field[1] == 0)
+        field[0] = field[1] = 0xFF;
+}
+
+// Where the payload starts in a TCP segment, UDP datagram or ICMP message
+// of `length` bytes at `l4`.
+size_t TransportHeader(uint8_t protocol, const uint8_t* l4, size_t length) {
+    switch (static_cast<Protocol>(protocol)) {
+    case Protocol::TCP:
+        return length >= 20 ? std::clamp<size_t>((l4[12] >> 4) * 4, 20, length) : length;
+    case Protocol::UDP:
+    case Protocol::ICMP:
+    case Protocol::ICMPv6:
+        return std::min<size_t>(8, length);
+    default:
+        return 0;
+    }
+}
+
+// ICMPv4 errors quote the offending datagram.
+bool IsICMPError(uint8_t type) {
+    return type == 3 || type == 4 || type == 5 || type == 11 || type == 12;
+}
+
+// ICMPv6 neighbor discovery: offset of the first option, 0 if not ND.
+size_t NDOptions(uint8_t type) {
+    switch (type) {
+    case 133: // router solicitation
+        return 8;
+    case 134: // router advertisement
+        return 16;
+    case 135: // neighbor solicitation
+    case 136: // neighbor advertisement
+        return 24;
+    case 137: // redirect
+        return 40;
+    default:
+        return 0;
+    }
+}
+} // namespace
+
+struct Anonymizer::Entry4 {
+    uint32_t in;
+    uint32_t out;
+    bool used;
+};
+
+// Addresses are 48 bits; `in` has bit 63 set once the entry is used.
+struct Anonymizer::EntryMAC {
+    uint64_t in;
+    uint64_t out;
+};
+
+struct Anonymizer::Entry6 {
+    uint8_t in[16];
+    uint8_t out[16];
+    bool used;
+};
+
+Anonymizer::Anonymizer(const Config& config) : m_config(config), m_key(config.key) {
+    if (std::all_of(m_key.begin(), m_key.end(), [](uint8_t b) { return b == 0; })) {
+        size_t filled = 0;
+        while (filled < m_key.size()) {
+            ssize_t n = getrandom(m_key.data() + filled, m_key.size() - filled, 0);
+            if (n > 0)
+                filled += n;
+        }
+    }
+    std::memcpy(&m_k0, m_key.data(), 8);
+    std::memcpy(&m_k1, m_key.data() + 8, 8);
+
+    // Flip bits for every prefix shorter than 16 bits, as a heap-ordered
+    // tree: node (1 << length) | prefix.
+    auto build = [this](uint64_t domain, unsigned width) {
+        std::vector<uint8_t> flips(1 << 16);
+        for (unsigned length = 0; length < 16; ++length) {
+            for (uint64_t p = 0; p < (1u << length); ++p) {
+                uint64_t word = length == 0 ? 0 : p << (width - length);
+                flips[(1u << length) | p] = Prf(domain | length << 8, word, 0) & 1;
+            }
+        }
+        auto table = std::make_unique<uint16_t[]>(1 << 16);
+        for (uint32_t v = 0; v < (1u << 16); ++v) {
+            uint32_t out = 0;
+            for (unsigned i = 0; i < 16; ++i) {
+                uint32_t bit = (v >> (15 - i)) & 1;
+                out |= (bit ^ flips[(1u << i) | (v >> (16 - i))]) << (15 - i);
+            }
+            table[v] = static_cast<uint16_t>(out);
+        }
+        return table;
+    };
+    m_top4 = build(Domain4, 32);
+    m_top6 = build(Domain6, 64);
+
+    size_t entries = 1;
+    while (entries < m_config.cache_size)
+        entries <<= 1;
+    m_cache4 = std::make_unique<Entry4[]>(entries);
+    m_cache6 = std::make_unique<Entry6[]>(entries);
+    m_cacheMAC = std::make_unique<EntryMAC[]>(entries);
+    m_cacheMask = entries - 1;
+}
+
+Anonymizer::~Anonymizer() = default;
+
+// SipHash-2-4 of three 64-bit words.
+uint64_t Anonymizer::Prf(uint64_t a, uint64_t b, uint64_t c) const {
+    uint64_t v0 = m_k0 ^ 0x736F6D6570736575ull;
+    uint64_t v1 = m_k1 ^ 0x646F72616E646F6Dull;
+    uint64_t v2 = m_k0 ^ 0x6C7967656E657261ull;
+    uint64_t v3 = m_k1 ^ 0x7465646279746573ull;
+    for (uint64_t m : {a, b, c, uint64_t(24) << 56}) {
+        v3 ^= m;
+        SipRound(v0, v1, v2, v3);
+        SipRound(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    v2 ^= 0xFF;
+    for (int i = 0; i < 4; ++i)
+        SipRound(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint32_t Anonymizer::AnonymizeIPv4(uint32_t address) {
+    Entry4& entry = m_cache4[(address * Golden >> 32) & m_cacheMask];
+    if (entry.used && entry.in == address)
+        return entry.out;
+    ++m_stats.cache_misses;
+
+    uint32_t out = static_cast<uint32_t>(m_top4[address >> 16]) << 16;
+    for (unsigned i = 16; i < 32; ++i) {
+        uint64_t prefix = Prefix(static_cast<uint64_t>(address) << 32, i) >> 32;
+        uint32_t flip = Prf(Domain4 | i << 8, prefix, 0) & 1;
+        out |= (((address >> (31 - i)) & 1) ^ flip) << (31 - i);
+    }
+    entry = {address, out, true};
+    return out;
+}
+
+void Anonymizer::AnonymizeIPv6(const uint8_t* address, uint8_t* out) {
+    const uint64_t hi = Load64BE(address);
+    const uint64_t lo = Load64BE(address + 8);
+    Entry6& entry = m_cache6[((hi ^ lo * Golden) * Golden >> 32) & m_cacheMask];
+    if (entry.used && std::memcmp(entry.in, address, 16) == 0) {
+        std::memcpy(out, entry.out, 16);
+        return;
+    }
+    ++m_stats.cache_misses;
+
+    uint64_t outHi = static_cast<uint64_t>(m_top6[hi >> 48]) << 48;
+    uint64_t outLo = 0;
+    for (unsigned i = 16; i < 64; ++i) {
+        uint64_t flip = Prf(Domain6 | i << 8, Prefix(hi, i), 0) & 1;
+        outHi |= (((hi >> (63 - i)) & 1) ^ flip) << (63 - i);
+    }
+    for (unsigned i = 64; i < 128; ++i) {
+        uint64_t flip = Prf(Domain6 | i << 8, hi, Prefix(lo, i - 64)) & 1;
+        outLo |= (((lo >> (127 - i)) & 1) ^ flip) << (127 - i);
+    }
+    std::memcpy(entry.in, address, 16);
+    Store64BE(entry.out, outHi);
+    Store64BE(entry.out + 8, outLo);
+    entry.used = true;
+    std::memcpy(out, entry.out, 16);
+}
+
+void Anonymizer::ScrambleMAC(const uint8_t* mac, uint8_t* out) {
+    uint64_t value = 0;
+    for (int i = 0; i < 6; ++i)
+        value = value << 8 | mac[i];
+    EntryMAC& entry = m_cacheMAC[(value * Golden >> 32) & m_cacheMask];
+    if (entry.in != (value | 1ull << 63)) {
+        uint64_t scrambled = Prf(DomainMAC, value, 0) & 0xFFFFFFFFFFFFull;
+        if (value == 0 || value == 0xFFFFFFFFFFFFull) {
+            scrambled = value; // unset and broadcast stay as they are
+        } else if (m_config.keep_oui) {
+            scrambled = (value & 0xFFFFFF000000ull) | (scrambled & 0xFFFFFF);
+        } else {
+            // Keep the group bit, mark the address locally administered.
+            scrambled = (scrambled & ~(3ull << 40)) | (value & 1ull << 40) | 2ull << 40;
+        }
+        entry = {value | 1ull << 63, scrambled};
+    }
+    for (int i = 5; i >= 0; --i)
+        out[i] = static_cast<uint8_t>(entry.out >> (8 * (5 - i)));
+}
+
+void Anonymizer::Address4(uint8_t* p) {
+    uint32_t address = static_cast<uint32_t>(p[0]) << 24 | p[1] << 16 | p[2] << 8 | p[3];
+    address = AnonymizeIPv4(address);
+    p[0] = static_cast<uint8_t>(address >> 24);
+    p[1] = static_cast<uint8_t>(address >> 16);
+    p[2] = static_cast<uint8_t>(address >> 8);
+    p[3] = static_cast<uint8_t>(address);
+}
+
+size_t Anonymizer::Truncate(size_t payloadStart, size_t length) {
+    if (m_config.max_payload == SIZE_MAX || payloadStart >= length ||
+        length - payloadStart <= m_config.max_payload)
+        return length;
+    ++m_stats.truncated;
+    return payloadStart + m_config.max_payload;
+}
+
+size_t Anonymizer::Rewrite(uint8_t* frame, size_t length) {
+    ++m_stats.frames;
+    if (length < EthernetFrame::HeaderSize)
+        return length;
+    if (m_config.macs) {
+        ScrambleMAC(frame, frame);
+        ScrambleMAC(frame + 6, frame + 6);
+    }
+
+    size_t offset = 12;
+    uint16_t type = static_cast<uint16_t>(frame[12] << 8 | frame[13]);
+    while ((type == static_cast<uint16_t>(EtherType::VLAN) || type == EtherTypeQinQ) &&
+           offset + 6 <= length) {
+        offset += 4;
+        type = static_cast<uint16_t>(frame[offset] << 8 | frame[offset + 1]);
+    }
+    offset += 2;
+
+    switch (static_cast<EtherType>(type)) {
+    case EtherType::IPv4:
+        return RewriteIPv4(frame, offset, length);
+    case EtherType::IPv6:
+        return RewriteIPv6(frame, offset, length);
+    case EtherType::ARP:
+        RewriteARP(frame, offset, length);
+        return length;
+    default:
+        return length;
+    }
+}
+
+size_t Anonymizer::RewriteIPv4(uint8_t* frame, size_t offset, size_t length) {
+    IPv4Packet ip(frame + offset, length - offset);
+    if (!ip.IsValid())
+        return length;
+    ++m_stats.ipv4;
+
+    uint8_t* h = frame + offset;
+    const size_t header = ip.HeaderLength();
+    const size_t end = std::min<size_t>(std::max<size_t>(ip.TotalLength(), header),
+                                        length - offset);
+    uint8_t before[8];
+    std::memcpy(before, h + 12, 8);
+    if (m_config.addresses) {
+        Address4(h + 12);
+        Address4(h + 16);
+        FixChecksum(h + 10, before, h + 12, 8);
+    }
+
+    // Later fragments carry no transport header.
+    const bool first = (h[6] & 0x1F) == 0 && h[7] == 0;
+    uint8_t* l4 = h + header;
+    const size_t l4Length = end - header;
+    if (!first)
+        return Truncate(offset + header, length);
+
+    const uint8_t protocol = ip.ProtocolRaw();
+    size_t payload = TransportHeader(protocol, l4, l4Length);
+    switch (static_cast<Protocol>(protocol)) {
+    case Protocol::TCP:
+        if (m_config.addresses && l4Length >= 18)
+            FixChecksum(l4 + 16, before, h + 12, 8);
+        break;
+    case Protocol::UDP:
+        if (m_config.addresses && l4Length >= 8)
+            FixUDPChecksum(l4 + 6, before, h + 12, 8);
+        break;
+    case Protocol::ICMP: {
+        if (l4Length < 8 + 20 || !IsICMPError(l4[0]))
+            break;
+        // The quoted header: addresses, its checksum, then the ICMP checksum
+        // over all ten changed bytes.
+        uint8_t* quoted = l4 + 8;
+        const size_t quotedHeader = (quoted[0] & 0x0F) * 4;
+        if ((quoted[0] >> 4) != 4 || quotedHeader < 20 || l4Length < 8 + quotedHeader)
+            break;
+        payload = std::min(l4Length, 8 + quotedHeader + 8);
+        if (!m_config.addresses)
+            break;
+        uint8_t quotedBefore[10];
+        std::memcpy(quotedBefore, quoted + 10, 10);
+        Address4(quoted + 12);
+        Address4(quoted + 16);
+        FixChecksum(quoted + 10, quotedBefore + 2, quoted + 12, 8);
+        FixChecksum(l4 + 2, quotedBefore, quoted + 10, 10);
+        break;
+    }
+    default:
+        break;
+    }
+    return Truncate(offset + header + payload, length);
+}
+
+size_t Anonymizer::RewriteIPv6(uint8_t* frame, size_t offset, size_t length) {
+    uint8_t* h = frame + offset;
+    if (length - offset < IPv6HeaderSize || (h[0] >> 4) != 6)
+        return length;
+    ++m_stats.ipv6;
+
+    uint8_t before[32];
+    std::memcpy(before, h + 8, 32);
+    if (m_config.addresses) {
+        AnonymizeIPv6(h + 8, h + 8);
+        AnonymizeIPv6(h + 24, h + 24);
+    }
+    // A zero payload length is a jumbogram; take what was captured.
+    const size_t declared = static_cast<size_t>(h[4] << 8 | h[5]);
+    const size_t end = declared == 0 ? length - offset
+                                     : std::min(IPv6HeaderSize + declared, length - offset);
+
+    // Step over hop-by-hop, routing, fragment and destination options.
+    uint8_t next = h[6];
+    size_t pos = IPv6HeaderSize;
+    while ((next == 0 || next == 43 || next == 44 || next == 60) && pos + 8 <= end) {
+        const uint8_t current = next;
+        next = h[pos];
+        if (current == 44) {
+            if ((h[pos + 2] << 8 | (h[pos + 3] & 0xF8)) != 0)
+                return Truncate(offset + pos + 8, length); // later fragment
+            pos += 8;
+        } else {
+            pos += (h[pos + 1] + 1) * 8;
+        }
+    }
+    if (pos > end)
+        return length;
+
+    uint8_t* l4 = h + pos;
+    const size_t l4Length = end - pos;
+    size_t payload = TransportHeader(next, l4, l4Length);
+    if (!m_config.addresses)
+        return Truncate(offset + pos + payload, length);
+
+    switch (static_cast<Protocol>(next)) {
+    case Protocol::TCP:
+        if (l4Length >= 18)
+            FixChecksum(l4 + 16, before, h + 8, 32);
+        break;
+    case Protocol::UDP:
+        if (l4Length >= 8)
+            FixUDPChecksum(l4 + 6, before, h + 8, 32);
+        break;
+    case Protocol::ICMPv6: {
+        if (l4Length < 8)
+            break;
+        FixChecksum(l4 + 2, before, h + 8, 32);
+        const uint8_t type = l4[0];
+        if (type < 128) {
+            // Error: the quoted packet's addresses.
+            payload = std::min(l4Length, 8 + IPv6HeaderSize + 8);
+            if (l4Length >= 8 + IPv6HeaderSize) {
+                uint8_t* quoted = l4 + 8 + 8;
+                uint8_t quotedBefore[32];
+                std::memcpy(quotedBefore, quoted, 32);
+                AnonymizeIPv6(quoted, quoted);
+                AnonymizeIPv6(quoted + 16, quoted + 16);
+                FixChecksum(l4 + 2, quotedBefore, quoted, 32);
+            }
+        } else if (size_t options = NDOptions(type)) {
+            // Neighbor discovery: target (and redirect destination)
+            // addresses and link-layer address options.
+            payload = l4Length;
+            for (size_t at = 8; at + 16 <= std::min(options, l4Length); at += 16) {
+                uint8_t target[16];
+                std::memcpy(target, l4 + at, 16);
+                AnonymizeIPv6(l4 + at, l4 + at);
+                FixChecksum(l4 + 2, target, l4 + at, 16);
+            }
+            for (size_t at = options; m_config.macs && at + 8 <= l4Length;) {
+                const size_t size = l4[at + 1] * 8;
+                if (size == 0)
+                    break;
+                if ((l4[at] == 1 || l4[at] == 2) && size == 8) {
+                    uint8_t mac[6];
+                    std::memcpy(mac, l4 + at + 2, 6);
+                    ScrambleMAC(mac, l4 + at + 2);
+                    FixChecksum(l4 + 2, mac, l4 + at + 2, 6);
+                }
+                at += size;
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return Truncate(offset + pos + payload, length);
+}
+
+void Anonymizer::RewriteARP(uint8_t* frame, size_t offset, size_t length) {
+    uint8_t* p = frame + offset;
+    // Ethernet/IPv4 only: hardware type 1, protocol 0x0800, sizes 6 and 4.
+    if (length - offset < 28 || p[0] != 0 || p[1] != 1 || p[2] != 0x08 || p[3] != 0x00 ||
+        p[4] != 6 || p[5] != 4)
+        return;
+    ++m_stats.arp;
+    if (m_config.macs) {
+        ScrambleMAC(p + 8, p + 8);
+        ScrambleMAC(p + 18, p + 18);
+    }
+    if (m_config.addresses) {
+        Address4(p + 14);
+        Address4(p + 24);
+    }
+}
+
+} // namespace libpkt
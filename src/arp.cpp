@@ -7,9 +7,10 @@
  */
 #include "libpkt/arp.hpp"
 
+#include "libpkt/format.hpp"
+
 #include <arpa/inet.h>
-#include <iomanip>
-#include <sstream>
+#include <cstring>
 
 namespace libpkt::arp {
 #pragma pack(push, 1)
@@ -26,8 +27,7 @@ struct ArpHeader {
 };
 #pragma pack(pop)
 
-Packet::Packet(const uint8_t* data, size_t length)
-    : m_data(data), m_length(length), m_valid(false) {
+Packet::Packet(const uint8_t* data, size_t length) : libpkt::Packet(data, length), m_valid(false) {
     if (length >= sizeof(ArpHeader)) {
         m_valid = true;
     }
@@ -73,19 +73,15 @@ uint16_t Packet::Opcode() const {
 }
 
 std::string Packet::MACToString(const uint8_t* mac) const {
-    std::ostringstream oss;
-    for (int i = 0; i < 6; ++i) {
-        if (i)
-            oss << ":";
-        oss << std::hex << std::setw(2) << std::setfill('0') << (int) mac[i];
-    }
-    return oss.str();
+    TextBuffer out(17);
+    out.AppendMAC(mac);
+    return out.String();
 }
 
 std::string Packet::IPToString(const uint8_t* ip) const {
-    char buf[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, ip, buf, sizeof(buf));
-    return std::string(buf);
+    TextBuffer out(15);
+    out.AppendIPv4(ip);
+    return out.String();
 }
 
 std::string Packet::SenderMAC() const {
@@ -116,12 +112,57 @@ std::string Packet::TargetIP() const {
     return IPToString(hdr->target_ip);
 }
 
-std::string Packet::Summary() const {
+const uint8_t* Packet::SenderMACRaw() const {
+    return m_valid ? reinterpret_cast<const ArpHeader*>(m_data)->sender_mac : nullptr;
+}
+
+uint32_t Packet::SenderIPRaw() const {
     if (!m_valid)
-        return "Invalid ARP Packet";
-    std::ostringstream oss;
-    oss << "ARP Packet: Opcode=" << Opcode() << ", Sender=" << SenderMAC() << "/" << SenderIP()
-        << ", Target=" << TargetMAC() << "/" << TargetIP();
-    return oss.str();
+        return 0;
+    uint32_t ip;
+    std::memcpy(&ip, reinterpret_cast<const ArpHeader*>(m_data)->sender_ip, sizeof(ip));
+    return ntohl(ip);
+}
+
+const uint8_t* Packet::TargetMACRaw() const {
+    return m_valid ? reinterpret_cast<const ArpHeader*>(m_data)->target_mac : nullptr;
+}
+
+uint32_t Packet::TargetIPRaw() const {
+    if (!m_valid)
+        return 0;
+    uint32_t ip;
+    std::memcpy(&ip, reinterpret_cast<const ArpHeader*>(m_data)->target_ip, sizeof(ip));
+    return ntohl(ip);
+}
+
+bool Packet::IsEthernetIPv4() const {
+    return HardwareType() == 1 && ProtocolType() == 0x0800 && HardwareSize() == 6 &&
+           ProtocolSize() == 4;
+}
+
+bool Packet::IsGratuitous() const {
+    return m_valid && SenderIPRaw() == TargetIPRaw();
+}
+
+bool Packet::IsProbe() const {
+    return m_valid && SenderIPRaw() == 0;
+}
+
+std::string Packet::Summary() const {
+    TextBuffer out(112);
+    AppendSummary(out);
+    return out.String();
+}
+
+void Packet::AppendSummary(TextBuffer& out) const {
+    if (!m_valid) {
+        out.Append("Invalid ARP Packet");
+        return;
+    }
+    auto hdr = reinterpret_cast<const ArpHeader*>(m_data);
+    out.Append("ARP Packet: Opcode=").AppendUInt(Opcode());
+    out.Append(", Sender=").AppendMAC(hdr->sender_mac).Append('/').AppendIPv4(hdr->sender_ip);
+    out.Append(", Target=").AppendMAC(hdr->target_mac).Append('/').AppendIPv4(hdr->target_ip);
 }
 } // namespace libpkt::arp
@@ -0,0 +1,458 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/classify.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libpkt::l7 {
+namespace {
+constexpr uint8_t ContentHandshake = 22;
+constexpr uint8_t HandshakeClientHello = 1;
+constexpr uint16_t ExtServerName = 0;
+constexpr uint16_t ExtALPN = 16;
+constexpr uint16_t ExtSupportedVersions = 43;
+constexpr uint16_t ExtECH = 0xFE0D;
+
+constexpr uint8_t SYN = 0x02;
+constexpr uint8_t RST = 0x04;
+
+constexpr std::string_view Methods[] = {
+    "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH", "CONNECT", "TRACE",
+};
+
+uint16_t Read16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+std::string_view View(const uint8_t* p, size_t length) {
+    return {reinterpret_cast<const char*>(p), length};
+}
+
+// RFC 8701 reserved values, sprinkled into lists by clients.
+bool IsGrease(uint16_t value) {
+    return (value & 0x0F0F) == 0x0A0A && (value >> 8) == (value & 0xFF);
+}
+
+bool SeqLT(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+bool Wanted(uint16_t type) {
+    return type == ExtServerName || type == ExtALPN || type == ExtSupportedVersions;
+}
+
+// One complete extension body.
+void Extension(uint16_t type, const uint8_t* p, size_t length, Result& out) {
+    switch (type) {
+    case ExtServerName: {
+        // server_name_list: (name_type, 16-bit length, name)*; the first host_name.
+        if (length < 2)
+            return;
+        const size_t end = std::min<size_t>(2 + Read16(p), length);
+        for (size_t pos = 2; pos + 3 <= end;) {
+            const size_t name = Read16(p + pos + 1);
+            if (name > end - pos - 3)
+                return;
+            if (p[pos] == 0 && name != 0) {
+                out.sni = View(p + pos + 3, name);
+                return;
+            }
+            pos += 3 + name;
+        }
+        return;
+    }
+    case ExtALPN: {
+        // protocol_name_list: (8-bit length, name)*.
+        if (length < 2)
+            return;
+        const size_t end = std::min<size_t>(2 + Read16(p), length);
+        for (size_t pos = 2; pos < end;) {
+            const size_t name = p[pos];
+            if (name == 0 || name > end - pos - 1)
+                return;
+            if (out.alpn_count < Result::MaxALPN)
+                out.alpn[out.alpn_count++] = View(p + pos + 1, name);
+            pos += 1 + name;
+        }
+        return;
+    }
+    case ExtSupportedVersions: {
+        if (length < 1)
+            return;
+        const size_t end = std::min<size_t>(1 + p[0], length);
+        for (size_t pos = 1; pos + 2 <= end; pos += 2) {
+            const uint16_t version = Read16(p + pos);
+            if (!IsGrease(version))
+                out.tls_version = std::max(out.tls_version, version);
+        }
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+// Walk the next `length` bytes of an extensions block, of which `c.left`
+// remain. False if an extension overruns the block.
+bool Walk(Continuation& c, const uint8_t* data, size_t length, Result& out) {
+    const size_t avail = std::min<size_t>(length, c.left);
+    size_t pos = 0;
+    if (c.skip != 0) {
+        const size_t take = std::min<size_t>(c.skip, avail);
+        if (c.collecting) {
+            std::memcpy(c.partial + c.partial_length, data, take);
+            c.partial_length = static_cast<uint8_t>(c.partial_length + take);
+        }
+        pos = take;
+        c.skip -= static_cast<uint32_t>(take);
+        if (c.skip == 0 && c.collecting) {
+            c.collecting = false;
+            Extension(c.type, c.partial, c.partial_length, out);
+        }
+    }
+    while (pos < avail) {
+        // The 4-byte header may itself be split.
+        const size_t need = 4 - c.head_length;
+        if (avail - pos < need) {
+            std::memcpy(c.head + c.head_length, data + pos, avail - pos);
+            c.head_length = static_cast<uint8_t>(c.head_length + avail - pos);
+            pos = avail;
+            break;
+        }
+        std::memcpy(c.head + c.head_length, data + pos, need);
+        c.head_length = 0;
+        pos += need;
+        const uint16_t type = Read16(c.head);
+        const size_t extension = Read16(c.head + 2);
+        // ECH is told by its type alone, so it counts even when its body,
+        // often large, is cut by the segment.
+        if (type == ExtECH)
+            out.ech = true;
+        if (extension > c.left - pos) {
+            c.left = 0;
+            c.skip = 0;
+            return false;
+        }
+        if (extension <= avail - pos) {
+            Extension(type, data + pos, extension, out);
+            pos += extension;
+            continue;
+        }
+        // Cut by the end of the segment: keep the fields we want if they
+        // fit, skip anything else.
+        const size_t seen = avail - pos;
+        c.skip = static_cast<uint32_t>(extension - seen);
+        c.collecting = Wanted(type) && extension <= sizeof(c.partial);
+        if (c.collecting) {
+            c.type = type;
+            std::memcpy(c.partial, data + pos, seen);
+            c.partial_length = static_cast<uint8_t>(seen);
+        }
+        pos = avail;
+    }
+    c.left -= static_cast<uint32_t>(avail);
+    return true;
+}
+
+bool ParseClientHello(const uint8_t* data, size_t length, Result& out, Continuation* resume) {
+    // Record header (type, version 3.x, length), then the handshake header.
+    if (length < 6 || data[0] != ContentHandshake || data[1] != 3 || data[2] > 4 ||
+        data[5] != HandshakeClientHello)
+        return false;
+    out.kind = Kind::TLS;
+    if (length < 9)
+        return true;
+    const size_t record = Read16(data + 3);
+    const size_t end = 9 + (static_cast<size_t>(data[6]) << 16 | Read16(data + 7));
+    // A ClientHello fragmented over several records is followed within the
+    // first one only.
+    const bool oneRecord = end <= 5 + record;
+    const size_t limit = std::min(length, oneRecord ? end : 5 + record);
+
+    // legacy_version, random, session_id, cipher_suites, compression_methods.
+    size_t pos = 9;
+    if (limit < pos + 2)
+        return true;
+    out.tls_version = Read16(data + pos);
+    pos += 2 + 32;
+    if (limit < pos + 1 || data[pos] > 32)
+        return true;
+    pos += 1 + data[pos];
+    if (limit < pos + 2)
+        return true;
+    pos += 2 + Read16(data + pos);
+    if (limit < pos + 1)
+        return true;
+    pos += 1 + data[pos];
+    if (pos >= end) {
+        out.complete = pos == end && limit == end; // no extensions at all
+        return true;
+    }
+    if (limit < pos + 2 || end < pos + 2)
+        return true;
+    const size_t extensions = Read16(data + pos);
+    pos += 2;
+    if (extensions > end - pos)
+        return true;
+
+    Continuation local;
+    Continuation& c = resume != nullptr ? *resume : local;
+    c = Continuation{};
+    c.left = static_cast<uint32_t>(extensions);
+    const bool ok = Walk(c, data + pos, limit - pos, out);
+    out.complete = ok && c.left == 0;
+    if (!oneRecord)
+        c.left = 0;
+    return true;
+}
+
+bool ParseRequest(const uint8_t* data, size_t length, Result& out) {
+    // A known method and a space within the first 8 bytes.
+    size_t space = 0;
+    while (space < length && space < 8 && data[space] != ' ')
+        ++space;
+    if (space == length || data[space] != ' ')
+        return false;
+    const std::string_view method = View(data, space);
+    if (std::find(std::begin(Methods), std::end(Methods), method) == std::end(Methods))
+        return false;
+    out.kind = Kind::HTTP;
+    out.method = method;
+
+    size_t pos = space + 1;
+    size_t end = pos;
+    while (end < length && data[end] != ' ' && data[end] != '\r' && data[end] != '\n')
+        ++end;
+    if (end == length || data[end] != ' ' || end == pos)
+        return true;
+    out.target = View(data + pos, end - pos);
+    pos = end + 1;
+    if (length - pos < 8)
+        return true;
+    if (std::memcmp(data + pos, "HTTP/1.", 7) != 0 ||
+        (data[pos + 7] != '0' && data[pos + 7] != '1')) {
+        out = Result{};
+        return false;
+    }
+    out.http_version = static_cast<uint8_t>(10 + (data[pos + 7] - '0'));
+    pos += 8;
+
+    // Header lines up to the empty one; CRLF or bare LF.
+    const void* newline = std::memchr(data + pos, '\n', length - pos);
+    while (newline != nullptr) {
+        pos = static_cast<const uint8_t*>(newline) - data + 1;
+        newline = std::memchr(data + pos, '\n', length - pos);
+        if (newline == nullptr)
+            break;
+        const size_t eol = static_cast<const uint8_t*>(newline) - data;
+        size_t last = eol > pos && data[eol - 1] == '\r' ? eol - 1 : eol;
+        if (last == pos) {
+            out.complete = true;
+            break;
+        }
+        if (out.host.empty() && last - pos >= 5 && (data[pos] | 0x20) == 'h' &&
+            (data[pos + 1] | 0x20) == 'o' && (data[pos + 2] | 0x20) == 's' &&
+            (data[pos + 3] | 0x20) == 't' && data[pos + 4] == ':') {
+            size_t value = pos + 5;
+            while (value < last && (data[value] == ' ' || data[value] == '\t'))
+                ++value;
+            while (last > value && (data[last - 1] == ' ' || data[last - 1] == '\t'))
+                --last;
+            out.host = View(data + value, last - value);
+        }
+    }
+    return true;
+}
+} // namespace
+
+Kind Parse(const uint8_t* data, size_t length, Result& out, Continuation* resume) {
+    out = Result{};
+    if (resume != nullptr)
+        resume->left = 0;
+    if (length == 0)
+        return Kind::Unknown;
+    if (data[0] == ContentHandshake) {
+        ParseClientHello(data, length, out, resume);
+        return out.kind;
+    }
+    ParseRequest(data, length, out);
+    return out.kind;
+}
+
+bool Resume(Continuation& resume, const uint8_t* data, size_t length, Result& out) {
+    out = Result{};
+    if (resume.left == 0)
+        return false;
+    out.kind = Kind::TLS;
+    out.complete = Walk(resume, data, length, out) && resume.left == 0;
+    return true;
+}
+
+Classifier::Classifier(const Config& config) : m_config(config), m_size(0), m_hand(0) {
+    size_t capacity = 16;
+    while (capacity < config.capacity)
+        capacity <<= 1;
+    m_slots.assign(capacity, Connection{});
+    m_pending.resize(config.pending);
+    for (size_t i = config.pending; i > 0; --i)
+        m_free.push_back(static_cast<uint32_t>(i - 1));
+}
+
+bool Classifier::Update(const FrameView& frame, Result& out) {
+    EthernetFrame eth(frame.data, frame.length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    // Only the first fragment of a datagram carries the TCP header.
+    if (!ip.IsValid() || ip.GetProtocol() != Protocol::TCP || ip.FragmentOffset() != 0)
+        return false;
+    tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+    if (!tcp.IsValid())
+        return false;
+
+    FlowKey key{ip.SrcAddressRaw(), ip.DstAddressRaw(), tcp.SrcPort(), tcp.DstPort(),
+                ip.ProtocolRaw()};
+    return Update(key, tcp, frame.timestamp_ns, out);
+}
+
+bool Classifier::Update(const FlowKey& key, const tcp::Packet& tcp, uint64_t timestamp_ns,
+                        Result& out) {
+    const bool swap = key.src_ip > key.dst_ip ||
+                      (key.src_ip == key.dst_ip && key.src_port > key.dst_port);
+    const FlowKey canonical = swap ? key.Reversed() : key;
+    const uint8_t d = swap ? 1 : 0;
+    const uint64_t hash = HashFlowKey(canonical);
+
+    // A new connection on the same 4-tuple, or the end of this one.
+    if (tcp.Flags() & (SYN | RST)) {
+        if (Connection* conn = Find(canonical, hash, false))
+            Erase(conn - m_slots.data());
+    }
+    const size_t length = tcp.PayloadLength();
+    if (length == 0 || (tcp.Flags() & RST))
+        return false;
+    ++m_stats.segments;
+
+    Connection* conn = Find(canonical, hash, true);
+    conn->last_ns = timestamp_ns;
+    if (conn->segments == 0) {
+        Continuation resume;
+        const Kind kind = Parse(tcp.Payload(), length, out, &resume);
+        ++(kind == Kind::TLS ? m_stats.tls : kind == Kind::HTTP ? m_stats.http : m_stats.unknown);
+        conn->segments = 1;
+        conn->dir = d;
+        conn->next_seq = tcp.SeqNum() + static_cast<uint32_t>(length);
+        if (resume.left != 0 && m_config.max_segments > 1 && !m_free.empty()) {
+            conn->pending = m_free.back();
+            m_free.pop_back();
+            m_pending[conn->pending] = resume;
+        }
+        return true;
+    }
+
+    // Classified: the short circuit. A ClientHello still in progress takes
+    // only its next in-order segment; a gap ends it.
+    if (conn->pending == NotPending || d != conn->dir || tcp.SeqNum() != conn->next_seq) {
+        if (conn->pending != NotPending && d == conn->dir &&
+            !SeqLT(tcp.SeqNum(), conn->next_seq))
+            Release(*conn);
+        ++m_stats.skipped;
+        return false;
+    }
+    ++m_stats.resumed;
+    Continuation& resume = m_pending[conn->pending];
+    Resume(resume, tcp.Payload(), length, out);
+    conn->next_seq += static_cast<uint32_t>(length);
+    if (resume.left == 0 || ++conn->segments == m_config.max_segments)
+        Release(*conn);
+    return true;
+}
+
+void Classifier::Release(Connection& conn) {
+    if (conn.pending != NotPending) {
+        m_free.push_back(conn.pending);
+        conn.pending = NotPending;
+    }
+}
+
+Classifier::Connection* Classifier::Find(const FlowKey& key, uint64_t hash, bool create) {
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = Home(hash);
+    while (m_slots[slot].used) {
+        if (m_slots[slot].hash == hash && m_slots[slot].key == key)
+            return &m_slots[slot];
+        slot = (slot + 1) & mask;
+    }
+    if (!create)
+        return nullptr;
+
+    // Past 3/4 load, make room by dropping a connection from this probe run.
+    if (m_size >= m_slots.size() / 4 * 3) {
+        size_t victim = Home(hash);
+        while (!m_slots[victim].used)
+            victim = (victim + 1) & mask;
+        Erase(victim);
+        ++m_stats.evictions;
+        slot = Home(hash);
+        while (m_slots[slot].used)
+            slot = (slot + 1) & mask;
+    }
+
+    Connection& conn = m_slots[slot];
+    conn = Connection{};
+    conn.key = key;
+    conn.hash = hash;
+    conn.pending = NotPending;
+    conn.used = true;
+    ++m_size;
+    return &conn;
+}
+
+// Linear-probing removal with backward shift.
+void Classifier::Erase(size_t slot) {
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slot;
+    size_t next = slot;
+    Release(m_slots[slot]);
+    for (;;) {
+        m_slots[hole].used = false;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (!m_slots[next].used) {
+                --m_size;
+                return;
+            }
+            size_t home = Home(m_slots[next].hash);
+            bool between = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!between)
+                break;
+        }
+        m_slots[hole] = m_slots[next];
+        hole = next;
+    }
+}
+
+void Classifier::Expire(uint64_t now_ns, size_t budget) {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t n = 0; n < budget && m_size != 0; ++n) {
+        const Connection& conn = m_slots[m_hand];
+        if (conn.used && now_ns > conn.last_ns &&
+            now_ns - conn.last_ns >= m_config.idle_timeout_ns) {
+            Erase(m_hand);
+            continue;
+        }
+        m_hand = (m_hand + 1) & mask;
+    }
+}
+
+} // namespace libpkt::l7
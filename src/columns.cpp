@@ -0,0 +1,97 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/columns.hpp"
+
+#include "libpkt/simd_parse.hpp"
+
+#include <algorithm>
+
+namespace libpkt {
+namespace {
+constexpr size_t PrefetchDistance = 8;
+
+size_t Words(size_t bits) {
+    return (bits + 63) / 64;
+}
+} // namespace
+
+void ColumnBatch::Reserve(size_t capacity) {
+    timestamp_ns.reserve(capacity);
+    length.reserve(capacity);
+    ethertype.reserve(capacity);
+    ip_protocol.reserve(capacity);
+    src_ip.reserve(capacity);
+    dst_ip.reserve(capacity);
+    src_port.reserve(capacity);
+    dst_port.reserve(capacity);
+    tcp_flags.reserve(capacity);
+    ethernet_valid.reserve(Words(capacity));
+    ipv4_valid.reserve(Words(capacity));
+    l4_valid.reserve(Words(capacity));
+}
+
+void ColumnBatch::Resize(size_t count) {
+    timestamp_ns.resize(count);
+    length.resize(count);
+    ethertype.resize(count);
+    ip_protocol.resize(count);
+    src_ip.resize(count);
+    dst_ip.resize(count);
+    src_port.resize(count);
+    dst_port.resize(count);
+    tcp_flags.resize(count);
+    ethernet_valid.assign(Words(count), 0);
+    ipv4_valid.assign(Words(count), 0);
+    l4_valid.assign(Words(count), 0);
+}
+
+size_t DecodeBatch(std::span<const FrameView> frames, ColumnBatch& out) {
+    const size_t count = frames.size();
+    out.Resize(count);
+
+    for (size_t i = 0; i < std::min(count, PrefetchDistance); ++i)
+        __builtin_prefetch(frames[i].data);
+
+    size_t ipv4Count = 0;
+    simd::HeaderLanes lanes;
+    for (size_t base = 0; base < count; base += simd::MaxLanes) {
+        const size_t n = std::min(simd::MaxLanes, count - base);
+        for (size_t k = 0; k < n; ++k) {
+            size_t ahead = base + k + PrefetchDistance;
+            if (ahead < count) {
+                // Ethernet + IPv4 + L4 headers span the first one or two cache lines.
+                __builtin_prefetch(frames[ahead].data);
+                __builtin_prefetch(frames[ahead].data + 63);
+            }
+        }
+
+        simd::ParseHeaders(frames.data() + base, n, lanes);
+
+        for (size_t k = 0; k < n; ++k) {
+            out.timestamp_ns[base + k] = frames[base + k].timestamp_ns;
+            out.length[base + k] = static_cast<uint32_t>(frames[base + k].length);
+        }
+        std::copy_n(lanes.ethertype, n, out.ethertype.begin() + base);
+        std::copy_n(lanes.protocol, n, out.ip_protocol.begin() + base);
+        std::copy_n(lanes.src_ip, n, out.src_ip.begin() + base);
+        std::copy_n(lanes.dst_ip, n, out.dst_ip.begin() + base);
+        std::copy_n(lanes.src_port, n, out.src_port.begin() + base);
+        std::copy_n(lanes.dst_port, n, out.dst_port.begin() + base);
+        std::copy_n(lanes.tcp_flags, n, out.tcp_flags.begin() + base);
+
+        // MaxLanes divides 64, so a chunk never straddles two bitmap words.
+        const size_t word = base >> 6;
+        const unsigned shift = base & 63;
+        out.ethernet_valid[word] |= uint64_t{lanes.ethernet_valid} << shift;
+        out.ipv4_valid[word] |= uint64_t{lanes.ipv4_valid} << shift;
+        out.l4_valid[word] |= uint64_t{lanes.tcp_valid | lanes.udp_valid} << shift;
+        ipv4Count += __builtin_popcount(lanes.ipv4_valid);
+    }
+    return ipv4Count;
+}
+} // namespace libpkt
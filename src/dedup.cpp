@@ -0,0 +1,151 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/dedup.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libpkt {
+namespace {
+// Times are kept in ~1 us ticks so an entry fits in 8 bytes.
+constexpr unsigned TickShift = 10;
+constexpr uint16_t EtherTypeQinQ = 0x88A8;
+
+constexpr uint64_t P0 = 0xA0761D6478BD642Full;
+constexpr uint64_t P1 = 0xE7037ED1A0B428DBull;
+constexpr uint64_t P2 = 0x8EBC6AF09C88C6E3ull;
+
+uint64_t Mix(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+uint64_t Read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+// 16 bytes per 64x64->128 multiply, chained through `seed`.
+uint64_t HashBytes(const uint8_t* data, size_t length, uint64_t seed) {
+    seed ^= Mix(seed ^ P0, length ^ P1);
+    for (; length >= 16; data += 16, length -= 16)
+        seed ^= Mix(Read64(data) ^ P1, Read64(data + 8) ^ P2 ^ seed);
+    uint8_t tail[16] = {};
+    std::memcpy(tail, data, length);
+    return Mix(Read64(tail) ^ P1 ^ length, Read64(tail + 8) ^ seed);
+}
+} // namespace
+
+Deduplicator::Deduplicator(const Config& config) : m_config(config) {
+    size_t buckets = 1;
+    while (buckets * 8 < m_config.capacity)
+        buckets <<= 1;
+    m_buckets = std::make_unique<Bucket[]>(buckets);
+    m_mask = buckets - 1;
+    uint64_t window = (m_config.window_ns + (1u << TickShift) - 1) >> TickShift;
+    m_windowTicks = static_cast<uint32_t>(std::min<uint64_t>(window, INT32_MAX));
+}
+
+uint64_t Deduplicator::Hash(const uint8_t* frame, size_t length) {
+    if (length < EthernetFrame::HeaderSize)
+        return HashBytes(frame, length, 0);
+
+    // Step over 802.1Q/802.1ad tags: mirrored copies often differ in tagging.
+    size_t offset = 12;
+    uint16_t type = static_cast<uint16_t>(frame[12] << 8 | frame[13]);
+    while ((type == static_cast<uint16_t>(EtherType::VLAN) || type == EtherTypeQinQ) &&
+           offset + 6 <= length) {
+        offset += 4;
+        type = static_cast<uint16_t>(frame[offset] << 8 | frame[offset + 1]);
+    }
+    offset += 2;
+
+    if (type == static_cast<uint16_t>(EtherType::IPv4)) {
+        IPv4Packet ip(frame + offset, length - offset);
+        if (ip.IsValid()) {
+            const size_t header = ip.HeaderLength();
+            // Ethernet padding past the total length is not part of the packet.
+            size_t end = std::max<size_t>(ip.TotalLength(), header);
+            end = std::min(end, length - offset);
+            uint8_t masked[60];
+            std::memcpy(masked, frame + offset, header);
+            masked[8] = 0;  // TTL
+            masked[10] = 0; // header checksum
+            masked[11] = 0;
+            uint64_t seed = HashBytes(masked, header, type);
+            return HashBytes(frame + offset + header, end - header, seed);
+        }
+    }
+
+    uint8_t head[EthernetFrame::HeaderSize];
+    std::memcpy(head, frame, 12);
+    head[12] = static_cast<uint8_t>(type >> 8);
+    head[13] = static_cast<uint8_t>(type);
+    uint64_t seed = HashBytes(head, sizeof(head), 0);
+    return HashBytes(frame + offset, length - offset, seed);
+}
+
+bool Deduplicator::IsDuplicate(const FrameView& frame) {
+    return IsDuplicate(Hash(frame.data, frame.length), frame.timestamp_ns);
+}
+
+bool Deduplicator::IsDuplicate(uint64_t hash, uint64_t timestamp_ns) {
+    // Bucket from the low bits, tag from the high ones.
+    Bucket& bucket = m_buckets[hash & m_mask];
+    const uint32_t tag = static_cast<uint32_t>(hash >> 32) | 1;
+    const uint32_t now = static_cast<uint32_t>(timestamp_ns >> TickShift);
+    ++m_stats.frames;
+
+    // Ages are signed: copies from different taps may arrive out of order.
+    int victim = 0;
+    int64_t oldest = INT64_MIN;
+    for (int i = 0; i < 8; ++i) {
+        int64_t age = static_cast<int32_t>(now - bucket.ticks[i]);
+        if (bucket.tags[i] == tag) {
+            if (age <= m_windowTicks && -age <= m_windowTicks) {
+                ++m_stats.duplicates;
+                return true;
+            }
+            bucket.ticks[i] = now;
+            return false;
+        }
+        if (bucket.tags[i] == 0)
+            age = INT64_MAX;
+        if (age > oldest) {
+            oldest = age;
+            victim = i;
+        }
+    }
+    if (bucket.tags[victim] != 0 && oldest <= m_windowTicks)
+        ++m_stats.evictions;
+    bucket.tags[victim] = tag;
+    bucket.ticks[victim] = now;
+    return false;
+}
+
+size_t Deduplicator::Filter(std::vector<FrameView>& frames) {
+    size_t kept = 0;
+    for (const FrameView& frame : frames) {
+        if (!IsDuplicate(frame))
+            frames[kept++] = frame;
+    }
+    size_t removed = frames.size() - kept;
+    frames.resize(kept);
+    return removed;
+}
+
+void Deduplicator::Clear() {
+    std::fill_n(m_buckets.get(), m_mask + 1, Bucket{});
+    m_stats = {};
+}
+
+} // namespace libpkt
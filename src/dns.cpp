@@ -0,0 +1,338 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/dns.hpp"
+#include "libpkt/format.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libpkt::dns {
+namespace {
+constexpr size_t MaxPointerHops = 32;
+constexpr size_t MaxWireLength = 255; // RFC 1035, including the root label
+
+uint16_t Read16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+// Extra characters needed to print a label byte: 0, 1 for "\\." and "\\\\",
+// 3 for "\\DDD".
+size_t NeedsEscape(uint8_t c) {
+    if (c <= 0x20 || c >= 0x7F)
+        return 3;
+    return c == '.' || c == '\\';
+}
+
+// True if no label byte needs escaping, checking eight bytes per step.
+// False positives only cost a trip through the per-byte path.
+bool IsPlain(const uint8_t* label, size_t length) {
+    constexpr uint64_t Ones = 0x0101010101010101ull;
+    constexpr uint64_t Highs = 0x8080808080808080ull;
+    auto hasZero = [](uint64_t w) { return (w - Ones) & ~w & Highs; };
+    for (size_t i = 0; i < length; i += 8) {
+        uint64_t w = 0x6161616161616161ull; // pad short tails with 'a'
+        std::memcpy(&w, label + i, std::min<size_t>(8, length - i));
+        uint64_t low = (w - Ones * 0x21) & ~w & Highs; // some byte < 0x21
+        uint64_t high = ((w + Ones) | w) & Highs;      // some byte >= 0x7F
+        if (low | high | hasZero(w ^ (Ones * '.')) | hasZero(w ^ (Ones * '\\')))
+            return false;
+    }
+    return true;
+}
+
+// Offset just past the name at `offset`, or -1. Does not follow pointers.
+ssize_t SkipName(const uint8_t* data, size_t length, size_t offset) {
+    size_t pos = offset;
+    while (pos < length) {
+        uint8_t b = data[pos];
+        if (b == 0)
+            return static_cast<ssize_t>(pos + 1);
+        if ((b & 0xC0) == 0xC0)
+            return pos + 2 <= length ? static_cast<ssize_t>(pos + 2) : -1;
+        if (b & 0xC0)
+            return -1; // extended label types are obsolete
+        pos += 1 + b;
+        if (pos - offset > MaxWireLength)
+            return -1;
+    }
+    return -1;
+}
+} // namespace
+
+ssize_t DecodeName(const uint8_t* message, size_t length, size_t offset, char* out,
+                   size_t capacity) {
+    size_t pos = offset;
+    size_t limit = offset; // pointers must land before the run being read
+    size_t hops = 0;
+    size_t used = 0;
+    size_t wire = 0;
+    for (;;) {
+        if (pos >= length)
+            return -1;
+        uint8_t b = message[pos];
+        if ((b & 0xC0) == 0xC0) {
+            if (pos + 1 >= length)
+                return -1;
+            size_t target = static_cast<size_t>(b & 0x3F) << 8 | message[pos + 1];
+            if (target >= limit || ++hops > MaxPointerHops)
+                return -1;
+            pos = limit = target;
+            continue;
+        }
+        if (b & 0xC0)
+            return -1;
+        if (b == 0)
+            break;
+        if (pos + 1 + b > length)
+            return -1;
+        wire += 1 + b;
+        if (wire > MaxWireLength - 1)
+            return -1;
+        if (used != 0) {
+            if (used + 1 >= capacity)
+                return -1;
+            out[used++] = '.';
+        }
+        const uint8_t* label = message + pos + 1;
+        if (IsPlain(label, b)) {
+            if (used + b >= capacity)
+                return -1;
+            std::memcpy(out + used, label, b);
+            used += b;
+        } else {
+            for (size_t i = 0; i < b; ++i) {
+                uint8_t c = label[i];
+                size_t escaped = NeedsEscape(c);
+                if (used + 1 + escaped >= capacity)
+                    return -1;
+                if (escaped == 0) {
+                    out[used++] = static_cast<char>(c);
+                } else if (escaped == 1) {
+                    out[used++] = '\\';
+                    out[used++] = static_cast<char>(c);
+                } else {
+                    out[used++] = '\\';
+                    out[used++] = static_cast<char>('0' + c / 100);
+                    out[used++] = static_cast<char>('0' + c / 10 % 10);
+                    out[used++] = static_cast<char>('0' + c % 10);
+                }
+            }
+        }
+        pos += 1 + b;
+    }
+
+    if (used == 0) {
+        if (capacity < 2)
+            return -1;
+        out[used++] = '.';
+    } else if (capacity < used + 1) {
+        return -1;
+    }
+    out[used] = '\0';
+    return static_cast<ssize_t>(used);
+}
+
+Packet::Packet(const uint8_t* data, size_t length)
+    : libpkt::Packet(data, std::min<size_t>(length, 65535)), m_valid(false) {
+    if (length >= HeaderSize) {
+        m_valid = true;
+    }
+}
+
+bool Packet::IsValid() const {
+    return m_valid;
+}
+
+uint16_t Packet::Field(size_t offset) const {
+    if (!m_valid)
+        return 0;
+    return Read16(m_data + offset);
+}
+
+uint16_t Packet::Id() const {
+    return Field(0);
+}
+
+bool Packet::IsResponse() const {
+    return Field(2) & 0x8000;
+}
+
+uint8_t Packet::Opcode() const {
+    return (Field(2) >> 11) & 0x0F;
+}
+
+bool Packet::Authoritative() const {
+    return Field(2) & 0x0400;
+}
+
+bool Packet::Truncated() const {
+    return Field(2) & 0x0200;
+}
+
+bool Packet::RecursionDesired() const {
+    return Field(2) & 0x0100;
+}
+
+bool Packet::RecursionAvailable() const {
+    return Field(2) & 0x0080;
+}
+
+RCode Packet::GetRCode() const {
+    return static_cast<RCode>(Field(2) & 0x0F);
+}
+
+uint16_t Packet::QuestionCount() const {
+    return Field(4);
+}
+
+uint16_t Packet::AnswerCount() const {
+    return Field(6);
+}
+
+uint16_t Packet::AuthorityCount() const {
+    return Field(8);
+}
+
+uint16_t Packet::AdditionalCount() const {
+    return Field(10);
+}
+
+ssize_t Packet::Name(uint16_t offset, char* out, size_t capacity) const {
+    if (!m_valid)
+        return -1;
+    return DecodeName(m_data, m_length, offset, out, capacity);
+}
+
+bool Packet::FirstQuestion(Record& question) const {
+    if (QuestionCount() == 0)
+        return false;
+    Reader reader(*this);
+    return reader.Next(question);
+}
+
+ssize_t Packet::QueryName(char* out, size_t capacity) const {
+    Record question;
+    if (!FirstQuestion(question))
+        return -1;
+    return Name(question.name_offset, out, capacity);
+}
+
+uint16_t Packet::QueryType() const {
+    Record question;
+    return FirstQuestion(question) ? question.type : 0;
+}
+
+size_t Packet::AnswerIPv4(uint8_t (*out)[4], size_t max) const {
+    size_t count = 0;
+    Reader reader(*this);
+    Record rr;
+    while (count < max && reader.Next(rr) && rr.section <= Section::Answer) {
+        if (rr.section == Section::Answer && rr.type == static_cast<uint16_t>(Type::A) &&
+            rr.rdata_length == 4)
+            std::memcpy(out[count++], rr.rdata, 4);
+    }
+    return count;
+}
+
+size_t Packet::AnswerIPv6(uint8_t (*out)[16], size_t max) const {
+    size_t count = 0;
+    Reader reader(*this);
+    Record rr;
+    while (count < max && reader.Next(rr) && rr.section <= Section::Answer) {
+        if (rr.section == Section::Answer && rr.type == static_cast<uint16_t>(Type::AAAA) &&
+            rr.rdata_length == 16)
+            std::memcpy(out[count++], rr.rdata, 16);
+    }
+    return count;
+}
+
+std::string Packet::Summary() const {
+    TextBuffer out(128);
+    AppendSummary(out);
+    return out.String();
+}
+
+void Packet::AppendSummary(TextBuffer& out) const {
+    if (!m_valid) {
+        out.Append("Invalid DNS Packet");
+        return;
+    }
+    out.Append(IsResponse() ? "DNS Response: Id=" : "DNS Query: Id=").AppendUInt(Id());
+    out.Append(", QName=");
+    ssize_t length = QueryName(out.Reserve(MaxNameLength), MaxNameLength);
+    if (length < 0)
+        out.Append('?');
+    else
+        out.Commit(length);
+    out.Append(", QType=").AppendUInt(QueryType());
+    if (IsResponse()) {
+        out.Append(", RCode=").AppendUInt(static_cast<uint8_t>(GetRCode()));
+        out.Append(", Answers=").AppendUInt(AnswerCount());
+    }
+}
+
+Packet::Reader::Reader(const Packet& packet)
+    : m_data(packet.m_data), m_length(packet.m_length), m_offset(Packet::HeaderSize),
+      m_remaining{packet.QuestionCount(), packet.AnswerCount(), packet.AuthorityCount(),
+                  packet.AdditionalCount()},
+      m_section(0), m_malformed(false) {
+    if (!packet.IsValid())
+        m_section = 4;
+}
+
+bool Packet::Reader::Next(Record& record) {
+    while (m_section < 4 && m_remaining[m_section] == 0)
+        ++m_section;
+    if (m_section == 4 || m_malformed)
+        return false;
+
+    ssize_t end = SkipName(m_data, m_length, m_offset);
+    if (end < 0) {
+        m_malformed = true;
+        return false;
+    }
+    size_t pos = static_cast<size_t>(end);
+    record.section = static_cast<Section>(m_section);
+    record.name_offset = static_cast<uint16_t>(m_offset);
+
+    if (record.section == Section::Question) {
+        if (pos + 4 > m_length) {
+            m_malformed = true;
+            return false;
+        }
+        record.type = Read16(m_data + pos);
+        record.rclass = Read16(m_data + pos + 2);
+        record.ttl = 0;
+        record.rdata = nullptr;
+        record.rdata_length = 0;
+        pos += 4;
+    } else {
+        if (pos + 10 > m_length) {
+            m_malformed = true;
+            return false;
+        }
+        record.type = Read16(m_data + pos);
+        record.rclass = Read16(m_data + pos + 2);
+        record.ttl = static_cast<uint32_t>(Read16(m_data + pos + 4)) << 16 |
+                     Read16(m_data + pos + 6);
+        record.rdata_length = Read16(m_data + pos + 8);
+        pos += 10;
+        if (pos + record.rdata_length > m_length) {
+            m_malformed = true;
+            return false;
+        }
+        record.rdata = m_data + pos;
+        pos += record.rdata_length;
+    }
+
+    m_offset = pos;
+    --m_remaining[m_section];
+    return true;
+}
+
+} // namespace libpkt::dns
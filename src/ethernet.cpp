@@ -7,70 +7,61 @@
  */
 #include "libpkt/ethernet.hpp"
 
-#include <cstring>
-#include <iomanip>
-#include <sstream>
+#include "libpkt/format.hpp"
 
 namespace libpkt {
-EthernetFrame::EthernetFrame(const uint8_t* data, size_t length) {
-    if (length < HeaderSize) {
-        m_valid = false;
-        return;
-    }
-    std::memcpy(m_dst_mac.data(), data, 6);
-    std::memcpy(m_src_mac.data(), data + 6, 6);
-    m_ethertype = (static_cast<uint16_t>(data[12]) << 8) | data[13];
-    m_payload = data + HeaderSize;
-    m_payload_len = length - HeaderSize;
-    m_valid = true;
-}
+EthernetFrame::EthernetFrame(const uint8_t* data, size_t length)
+    : Packet(data, length), m_valid(length >= HeaderSize) {}
 
 bool EthernetFrame::IsValid() const {
     return m_valid;
 }
 
-std::string EthernetFrame::MacToString(const std::array<uint8_t, 6>& mac) const {
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < mac.size(); ++i) {
-        oss << std::setw(2) << static_cast<int>(mac[i]);
-        if (i != mac.size() - 1)
-            oss << ":";
-    }
-    return oss.str();
+std::string EthernetFrame::MacToString(const uint8_t* mac) {
+    TextBuffer out(17);
+    out.AppendMAC(mac);
+    return out.String();
 }
 
 std::string EthernetFrame::SrcMac() const {
-    return MacToString(m_src_mac);
+    return m_valid ? MacToString(m_data + 6) : std::string();
 }
 
 std::string EthernetFrame::DstMac() const {
-    return MacToString(m_dst_mac);
+    return m_valid ? MacToString(m_data) : std::string();
+}
+
+uint16_t EthernetFrame::EthertypeRaw() const {
+    if (!m_valid)
+        return 0;
+    return (static_cast<uint16_t>(m_data[12]) << 8) | m_data[13];
 }
 
 EtherType EthernetFrame::Ethertype() const {
-    switch (m_ethertype) {
-    case 0x0800:
-        return EtherType::IPv4;
-    case 0x0806:
-        return EtherType::ARP;
-    case 0x0842:
-        return EtherType::WOL;
-    case 0x86DD:
-        return EtherType::IPv6;
-    case 0x8100:
-        return EtherType::VLAN;
-    case 0x88CC:
-        return EtherType::LLDP;
-    default:
-        return EtherType::Unknown;
-    }
+    return ToEtherType(EthertypeRaw());
 }
+
 const uint8_t* EthernetFrame::Payload() const {
-    return m_payload;
+    return m_valid ? m_data + HeaderSize : nullptr;
 }
 
 size_t EthernetFrame::PayloadLength() const {
-    return m_payload_len;
+    return m_valid ? m_length - HeaderSize : 0;
+}
+
+std::string EthernetFrame::Summary() const {
+    TextBuffer out(80);
+    AppendSummary(out);
+    return out.String();
+}
+
+void EthernetFrame::AppendSummary(TextBuffer& out) const {
+    if (!m_valid) {
+        out.Append("Invalid Ethernet Frame");
+        return;
+    }
+    out.Append("Ethernet Frame: Src=").AppendMAC(m_data + 6);
+    out.Append(", Dst=").AppendMAC(m_data);
+    out.Append(", EtherType=0x").AppendHex(EthertypeRaw(), 4);
 }
 } // namespace libpkt
@@ -0,0 +1,89 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/event_loop.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace libpkt {
+namespace {
+constexpr int MaxEvents = 64;
+}
+
+EventLoop::EventLoop()
+    : m_epollFd(epoll_create1(EPOLL_CLOEXEC)), m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      m_running(false) {
+    if (m_epollFd < 0 || m_wakeFd < 0)
+        return;
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; // wake-up marker
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+}
+
+EventLoop::~EventLoop() {
+    if (m_wakeFd >= 0)
+        ::close(m_wakeFd);
+    if (m_epollFd >= 0)
+        ::close(m_epollFd);
+}
+
+bool EventLoop::IsValid() const {
+    return m_epollFd >= 0 && m_wakeFd >= 0;
+}
+
+bool EventLoop::Watch(int fd, std::coroutine_handle<> handle) {
+    if (!IsValid() || fd < 0)
+        return false;
+    struct epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = handle.address();
+    // Re-arm a descriptor that was watched before, register it otherwise.
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) == 0)
+        return true;
+    return errno == ENOENT && epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+size_t EventLoop::RunOnce(int timeoutMs) {
+    struct epoll_event events[MaxEvents];
+    int n = epoll_wait(m_epollFd, events, MaxEvents, timeoutMs);
+    if (n <= 0)
+        return 0;
+
+    size_t resumed = 0;
+    for (int i = 0; i < n; ++i) {
+        if (events[i].data.ptr == nullptr) {
+            uint64_t value;
+            while (::read(m_wakeFd, &value, sizeof(value)) > 0) {
+            }
+            m_running = false;
+            continue;
+        }
+        std::coroutine_handle<>::from_address(events[i].data.ptr).resume();
+        ++resumed;
+    }
+    return resumed;
+}
+
+void EventLoop::Run() {
+    if (!IsValid())
+        return;
+    m_running = true;
+    while (m_running) {
+        RunOnce(-1);
+    }
+}
+
+void EventLoop::Stop() {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t r = ::write(m_wakeFd, &one, sizeof(one));
+}
+} // namespace libpkt
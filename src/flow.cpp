@@ -0,0 +1,58 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/flow.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+namespace libpkt {
+uint64_t HashFlowKey(const FlowKey& key) {
+    auto mix = [](uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDull;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ull;
+        x ^= x >> 33;
+        return x;
+    };
+    uint64_t a = (static_cast<uint64_t>(key.src_ip) << 32) | key.dst_ip;
+    uint64_t b = (static_cast<uint64_t>(key.src_port) << 24) |
+                 (static_cast<uint64_t>(key.dst_port) << 8) | key.protocol;
+    return mix(mix(a) ^ b);
+}
+
+bool ExtractFlowKey(const uint8_t* frame, size_t length, FlowKey& key) {
+    EthernetFrame eth(frame, length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    if (!ip.IsValid())
+        return false;
+
+    key = {};
+    key.src_ip = ip.SrcAddressRaw();
+    key.dst_ip = ip.DstAddressRaw();
+    key.protocol = ip.ProtocolRaw();
+
+    // Fragments keep ports at zero so that all of a datagram shares a key.
+    if (ip.IsFragment())
+        return true;
+    if (ip.GetProtocol() == Protocol::TCP) {
+        tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+        key.src_port = tcp.SrcPort();
+        key.dst_port = tcp.DstPort();
+    } else if (ip.GetProtocol() == Protocol::UDP) {
+        udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        key.src_port = udp.SrcPort();
+        key.dst_port = udp.DstPort();
+    }
+    return true;
+}
+} // namespace libpkt
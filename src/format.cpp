@@ -0,0 +1,94 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/format.hpp"
+
+#include <algorithm>
+
+namespace libpkt {
+namespace {
+constexpr char HexDigits[] = "0123456789abcdef";
+} // namespace
+
+void TextBuffer::Grow(size_t n) {
+    m_data.resize(std::max(m_data.size() * 2, m_size + n));
+}
+
+TextBuffer& TextBuffer::AppendHex(uint64_t value, int width) {
+    char* p = Reserve(16);
+    int digits = 1;
+    while (digits < 16 && (value >> (digits * 4)) != 0)
+        ++digits;
+    digits = std::max(digits, std::min(width, 16));
+    for (int i = digits - 1; i >= 0; --i) {
+        p[i] = HexDigits[value & 0xF];
+        value >>= 4;
+    }
+    m_size += digits;
+    return *this;
+}
+
+TextBuffer& TextBuffer::AppendIPv4(uint32_t hostOrder) {
+    char* start = Reserve(15);
+    char* p = start;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        p = std::to_chars(p, p + 3, (hostOrder >> shift) & 0xFF).ptr;
+        if (shift != 0)
+            *p++ = '.';
+    }
+    m_size += p - start;
+    return *this;
+}
+
+TextBuffer& TextBuffer::AppendIPv4(const uint8_t* networkOrder) {
+    return AppendIPv4(static_cast<uint32_t>(networkOrder[0]) << 24 |
+                      static_cast<uint32_t>(networkOrder[1]) << 16 |
+                      static_cast<uint32_t>(networkOrder[2]) << 8 | networkOrder[3]);
+}
+
+TextBuffer& TextBuffer::AppendMAC(const uint8_t* mac) {
+    char* p = Reserve(17);
+    for (int i = 0; i < 6; ++i) {
+        p[i * 3] = HexDigits[mac[i] >> 4];
+        p[i * 3 + 1] = HexDigits[mac[i] & 0xF];
+        if (i != 5)
+            p[i * 3 + 2] = ':';
+    }
+    m_size += 17;
+    return *this;
+}
+
+TextBuffer& TextBuffer::AppendTimestamp(uint64_t ns) {
+    AppendUInt(ns / 1000000000ull);
+    char* p = Reserve(10);
+    p[0] = '.';
+    uint64_t frac = ns % 1000000000ull;
+    for (int i = 9; i >= 1; --i) {
+        p[i] = static_cast<char>('0' + frac % 10);
+        frac /= 10;
+    }
+    m_size += 10;
+    return *this;
+}
+
+TextBuffer& TextBuffer::AppendJSONString(std::string_view s) {
+    Append('"');
+    for (char c : s) {
+        auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            Append('\\').Append(c);
+        } else if (u < 0x20) {
+            Append("\\u00");
+            AppendHex(u, 2);
+        } else {
+            Append(c);
+        }
+    }
+    return Append('"');
+}
+
+} // namespace libpkt
@@ -0,0 +1,31 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/frame.hpp"
+
+#include <ctime>
+
+namespace libpkt {
+namespace {
+constexpr size_t ControlSize = CMSG_SPACE(sizeof(struct timespec));
+}
+
+PacketBatch::PacketBatch(size_t capacity, size_t snapLen)
+    : m_snapLen(snapLen), m_size(0), m_storage(capacity * snapLen),
+      m_control(capacity * ControlSize), m_frames(capacity), m_iov(capacity), m_msgs(capacity) {
+    for (size_t i = 0; i < capacity; ++i) {
+        m_frames[i] = {m_storage.data() + i * snapLen, 0, 0};
+        m_iov[i].iov_base = m_storage.data() + i * snapLen;
+        m_iov[i].iov_len = snapLen;
+        m_msgs[i] = {};
+        m_msgs[i].msg_hdr.msg_iov = &m_iov[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+        m_msgs[i].msg_hdr.msg_control = m_control.data() + i * ControlSize;
+        m_msgs[i].msg_hdr.msg_controllen = ControlSize;
+    }
+}
+} // namespace libpkt
@@ -7,9 +7,11 @@
  */
 #include "libpkt/icmp.hpp"
 
+#include "libpkt/format.hpp"
+#include "libpkt/protocol.hpp"
+
 #include <arpa/inet.h>
-#include <iomanip>
-#include <sstream>
+#include <cstring>
 
 namespace libpkt::icmp {
 #pragma pack(push, 1)
@@ -21,8 +23,7 @@ struct IcmpHeader {
 };
 #pragma pack(pop)
 
-Packet::Packet(const uint8_t* data, size_t length)
-    : m_data(data), m_length(length), m_valid(false) {
+Packet::Packet(const uint8_t* data, size_t length) : libpkt::Packet(data, length), m_valid(false) {
     if (length >= sizeof(IcmpHeader)) {
         m_valid = true;
     }
@@ -53,11 +54,129 @@ uint16_t Packet::Checksum() const {
     return ntohs(hdr->checksum);
 }
 
-std::string Packet::Summary() const {
+namespace {
+uint16_t Load16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+uint32_t Load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+} // namespace
+
+bool Packet::IsEcho() const {
+    return m_valid && (Type() == EchoRequest || Type() == EchoReply);
+}
+
+bool Packet::IsError() const {
     if (!m_valid)
-        return "Invalid ICMP Packet";
-    std::ostringstream oss;
-    oss << "ICMP Packet: Type=" << (int) Type() << ", Code=" << (int) Code();
-    return oss.str();
+        return false;
+    switch (Type()) {
+    case DestinationUnreachable:
+    case SourceQuench:
+    case Redirect:
+    case TimeExceeded:
+    case ParameterProblem:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint16_t Packet::Identifier() const {
+    return m_valid ? Load16(m_data + 4) : 0;
+}
+
+uint16_t Packet::Sequence() const {
+    return m_valid ? Load16(m_data + 6) : 0;
+}
+
+bool Packet::GetTimestamps(uint32_t& originate, uint32_t& receive, uint32_t& transmit) const {
+    if (!m_valid || (Type() != TimestampRequest && Type() != TimestampReply) || m_length < 20)
+        return false;
+    originate = Load32(m_data + 8);
+    receive = Load32(m_data + 12);
+    transmit = Load32(m_data + 16);
+    return true;
+}
+
+uint16_t Packet::NextHopMTU() const {
+    if (!m_valid || Type() != DestinationUnreachable || Code() != FragmentationNeeded)
+        return 0;
+    return Load16(m_data + 6);
+}
+
+uint32_t Packet::Gateway() const {
+    return m_valid && Type() == Redirect ? Load32(m_data + 4) : 0;
+}
+
+const uint8_t* Packet::Payload() const {
+    return m_valid ? m_data + sizeof(IcmpHeader) : nullptr;
+}
+
+size_t Packet::PayloadLength() const {
+    return m_valid ? m_length - sizeof(IcmpHeader) : 0;
+}
+
+bool Packet::ParseQuoted(Quoted& out) const {
+    if (!IsError())
+        return false;
+    const uint8_t* ip = Payload();
+    size_t length = PayloadLength();
+    if (length < 20 || (ip[0] >> 4) != 4)
+        return false;
+    size_t ihl = (ip[0] & 0x0F) * 4;
+    if (ihl < 20 || ihl > length)
+        return false;
+
+    out = {};
+    out.total_length = Load16(ip + 2);
+    out.ip_id = Load16(ip + 4);
+    out.ttl = ip[8];
+    out.flow.protocol = ip[9];
+    out.flow.src_ip = Load32(ip + 12);
+    out.flow.dst_ip = Load32(ip + 16);
+
+    // RFC 792 guarantees 8 bytes of the original payload; RFC 1812 routers
+    // quote more. Only the first fragment carries the transport header.
+    const uint8_t* l4 = ip + ihl;
+    bool firstFragment = (Load16(ip + 6) & 0x1FFF) == 0;
+    out.has_l4 = firstFragment && length - ihl >= 8;
+    if (!out.has_l4)
+        return true;
+    switch (ToProtocol(out.flow.protocol)) {
+    case Protocol::TCP:
+        out.tcp_seq = Load32(l4 + 4);
+        [[fallthrough]];
+    case Protocol::UDP:
+        out.flow.src_port = Load16(l4);
+        out.flow.dst_port = Load16(l4 + 2);
+        break;
+    case Protocol::ICMP:
+        out.icmp_type = l4[0];
+        out.icmp_id = Load16(l4 + 4);
+        out.icmp_seq = Load16(l4 + 6);
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+std::string Packet::Summary() const {
+    TextBuffer out(40);
+    AppendSummary(out);
+    return out.String();
+}
+
+void Packet::AppendSummary(TextBuffer& out) const {
+    if (!m_valid) {
+        out.Append("Invalid ICMP Packet");
+        return;
+    }
+    out.Append("ICMP Packet: Type=").AppendUInt(Type());
+    out.Append(", Code=").AppendUInt(Code());
 }
 } // namespace libpkt::icmp
@@ -0,0 +1,144 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/icmp_echo.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+
+namespace libpkt::icmp {
+
+EchoTracker::EchoTracker(const Config& config) : m_config(config), m_size(0), m_hand(0) {
+    size_t capacity = 16;
+    while (capacity < config.capacity)
+        capacity <<= 1;
+    m_slots.assign(capacity, Request{});
+}
+
+bool EchoTracker::Update(const FrameView& frame) {
+    EthernetFrame eth(frame.data, frame.length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    // Only the first fragment of a datagram carries the ICMP header.
+    if (!ip.IsValid() || ip.GetProtocol() != Protocol::ICMP || ip.FragmentOffset() != 0)
+        return false;
+    Packet icmp(ip.Payload(), ip.PayloadLength());
+    if (!icmp.IsValid())
+        return false;
+    Update(ip.SrcAddressRaw(), ip.DstAddressRaw(), icmp, frame.timestamp_ns);
+    return true;
+}
+
+void EchoTracker::Update(uint32_t src, uint32_t dst, const Packet& icmp, uint64_t timestamp_ns) {
+    FlowKey key;
+    switch (icmp.Type()) {
+    case EchoRequest: {
+        key = {src, dst, icmp.Identifier(), icmp.Sequence(), 1};
+        uint64_t hash = HashFlowKey(key);
+        ++m_stats.requests;
+        if (Find(key, hash) != nullptr)
+            ++m_stats.duplicates; // keep the first copy's time
+        else
+            Insert(key, hash, timestamp_ns);
+        return;
+    }
+    case EchoReply: {
+        key = {dst, src, icmp.Identifier(), icmp.Sequence(), 1};
+        Request* request = Find(key, HashFlowKey(key));
+        if (request == nullptr) {
+            ++m_stats.unmatched;
+            return;
+        }
+        ++m_stats.replies;
+        uint64_t rtt = timestamp_ns > request->sent_ns ? timestamp_ns - request->sent_ns : 0;
+        Erase(request - m_slots.data());
+        m_histogram.Record(rtt);
+        if (m_config.sink != nullptr)
+            m_config.sink(key, rtt, m_config.context);
+        return;
+    }
+    default: {
+        Quoted quoted;
+        if (!icmp.ParseQuoted(quoted) || !quoted.has_l4 || quoted.icmp_type != EchoRequest ||
+            quoted.flow.protocol != static_cast<uint8_t>(Protocol::ICMP))
+            return;
+        key = {quoted.flow.src_ip, quoted.flow.dst_ip, quoted.icmp_id, quoted.icmp_seq, 1};
+        if (Request* request = Find(key, HashFlowKey(key))) {
+            Erase(request - m_slots.data());
+            ++m_stats.errors;
+        }
+        return;
+    }
+    }
+}
+
+EchoTracker::Request* EchoTracker::Find(const FlowKey& key, uint64_t hash) {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = Home(hash); m_slots[slot].used; slot = (slot + 1) & mask) {
+        if (m_slots[slot].hash == hash && m_slots[slot].key == key)
+            return &m_slots[slot];
+    }
+    return nullptr;
+}
+
+void EchoTracker::Insert(const FlowKey& key, uint64_t hash, uint64_t timestamp_ns) {
+    const size_t mask = m_slots.size() - 1;
+    // Past 3/4 load, make room by dropping a request from this probe run.
+    if (m_size >= m_slots.size() / 4 * 3) {
+        size_t victim = Home(hash);
+        while (!m_slots[victim].used)
+            victim = (victim + 1) & mask;
+        Erase(victim);
+        ++m_stats.evictions;
+    }
+    size_t slot = Home(hash);
+    while (m_slots[slot].used)
+        slot = (slot + 1) & mask;
+    m_slots[slot] = {key, hash, timestamp_ns, true};
+    ++m_size;
+}
+
+// Linear-probing removal with backward shift.
+void EchoTracker::Erase(size_t slot) {
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slot;
+    size_t next = slot;
+    for (;;) {
+        m_slots[hole].used = false;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (!m_slots[next].used) {
+                --m_size;
+                return;
+            }
+            size_t home = Home(m_slots[next].hash);
+            bool between = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!between)
+                break;
+        }
+        m_slots[hole] = m_slots[next];
+        hole = next;
+    }
+}
+
+void EchoTracker::Expire(uint64_t now_ns, size_t budget) {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t n = 0; n < budget && m_size != 0; ++n) {
+        const Request& request = m_slots[m_hand];
+        if (request.used && now_ns > request.sent_ns &&
+            now_ns - request.sent_ns >= m_config.timeout_ns) {
+            Erase(m_hand); // may pull a later request into this slot
+            ++m_stats.timeouts;
+            continue;
+        }
+        m_hand = (m_hand + 1) & mask;
+    }
+}
+
+} // namespace libpkt::icmp
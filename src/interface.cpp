@@ -7,25 +7,114 @@
  */
 #include "libpkt/interface.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <fcntl.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
+#include <linux/mempolicy.h>
 #include <net/if.h>
 #include <netinet/in.h>
+#include <sched.h>
 #include <stdexcept>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
+// Newer than some libc headers.
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+#ifndef PACKET_IGNORE_OUTGOING
+#define PACKET_IGNORE_OUTGOING 23
+#endif
+
 namespace libpkt {
-Interface::Interface(const std::string& ifaceName) : m_ifaceName(ifaceName), m_sockFd(-1) {}
+namespace {
+// Set an integer socket option and read it back; true if it now holds
+// `value`. Some (SO_BUSY_POLL_BUDGET) cannot be read; then setting is enough.
+bool SetOption(int fd, int level, int name, int value) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+        return false;
+    }
+    int current = 0;
+    socklen_t length = sizeof(current);
+    if (getsockopt(fd, level, name, &current, &length) < 0) {
+        return errno == ENOPROTOOPT;
+    }
+    return current == value;
+}
+
+// The NIC's NUMA node from sysfs; virtual devices have none, then the node
+// of the CPU the thread was pinned to, if any.
+int NumaNode(const std::string& ifaceName, bool pinned) {
+    int node = -1;
+    std::string path = "/sys/class/net/" + ifaceName + "/device/numa_node";
+    if (FILE* f = std::fopen(path.c_str(), "r")) {
+        if (std::fscanf(f, "%d", &node) != 1) {
+            node = -1;
+        }
+        std::fclose(f);
+    }
+    unsigned cpu, current;
+    if (node < 0 && pinned && syscall(SYS_getcpu, &cpu, &current, nullptr) == 0) {
+        node = static_cast<int>(current);
+    }
+    return node;
+}
+
+// The calling thread's CPU affinity and memory policy, which Configure()
+// changes; a strict Open() that fails puts them back.
+struct ThreadState {
+    static constexpr int MaskBits = 16 * 8 * sizeof(unsigned long);
+
+    bool hasAffinity = false;
+    cpu_set_t affinity;
+    bool hasPolicy = false;
+    int policy = 0;
+    unsigned long nodes[16] = {};
+
+    void Save(const Interface::Config& c) {
+        if (c.cpu >= 0) {
+            hasAffinity = sched_getaffinity(0, sizeof(affinity), &affinity) == 0;
+        }
+        if (c.numa_node != -1) {
+            hasPolicy =
+                syscall(SYS_get_mempolicy, &policy, nodes, MaskBits + 1, nullptr, 0) == 0;
+        }
+    }
+
+    void Restore() const {
+        if (hasAffinity) {
+            sched_setaffinity(0, sizeof(affinity), &affinity);
+        }
+        if (hasPolicy) {
+            syscall(SYS_set_mempolicy, policy, policy == MPOL_DEFAULT ? nullptr : nodes,
+                    MaskBits + 1);
+        }
+    }
+};
+} // namespace
+
+Interface::Interface(const std::string& ifaceName) : Interface(ifaceName, Config{}) {}
+
+Interface::Interface(const std::string& ifaceName, const Config& config)
+    : m_ifaceName(ifaceName), m_config(config), m_sockFd(-1) {}
 
 Interface::~Interface() {
     Close();
 }
 
-bool Interface::Open() {
-    m_sockFd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+bool Interface::Open(bool nonBlocking) {
+    int type = SOCK_RAW | (nonBlocking ? SOCK_NONBLOCK : 0);
+    m_sockFd = socket(AF_PACKET, type, htons(ETH_P_ALL));
     if (m_sockFd < 0) {
         return false;
     }
@@ -49,9 +138,152 @@ bool Interface::Open() {
         return false;
     }
 
+    // Kernel receive timestamps for ReceiveBatch(); not fatal if unsupported.
+    int on = 1;
+    setsockopt(m_sockFd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+    ThreadState saved;
+    if (m_config.strict) {
+        saved.Save(m_config);
+    }
+    Configure(sll.sll_ifindex);
+    if (m_config.strict && m_report.Failed() != 0) {
+        saved.Restore();
+        Close();
+        errno = EOPNOTSUPP;
+        return false;
+    }
     return true;
 }
 
+void Interface::Configure(int ifindex) {
+    const Config& c = m_config;
+    Report& r = m_report;
+    r = {};
+
+    if (c.rcvbuf > 0) {
+        r.requested |= RcvBuf;
+        // FORCE goes past rmem_max but needs CAP_NET_ADMIN.
+        r.rcvbuf_forced =
+            setsockopt(m_sockFd, SOL_SOCKET, SO_RCVBUFFORCE, &c.rcvbuf, sizeof(c.rcvbuf)) == 0;
+        if (!r.rcvbuf_forced) {
+            setsockopt(m_sockFd, SOL_SOCKET, SO_RCVBUF, &c.rcvbuf, sizeof(c.rcvbuf));
+        }
+        socklen_t length = sizeof(r.rcvbuf);
+        getsockopt(m_sockFd, SOL_SOCKET, SO_RCVBUF, &r.rcvbuf, &length);
+        if (r.rcvbuf / 2 >= c.rcvbuf) {
+            r.applied |= RcvBuf;
+        }
+    }
+    if (c.busy_poll_us > 0) {
+        r.requested |= BusyPoll;
+        if (SetOption(m_sockFd, SOL_SOCKET, SO_BUSY_POLL, c.busy_poll_us)) {
+            r.applied |= BusyPoll;
+            r.busy_poll_us = c.busy_poll_us;
+        }
+    }
+    if (c.prefer_busy_poll) {
+        r.requested |= PreferBusyPoll;
+        if (SetOption(m_sockFd, SOL_SOCKET, SO_PREFER_BUSY_POLL, 1)) {
+            r.applied |= PreferBusyPoll;
+        }
+    }
+    if (c.busy_poll_budget > 0) {
+        r.requested |= BusyPollBudget;
+        if (SetOption(m_sockFd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, c.busy_poll_budget)) {
+            r.applied |= BusyPollBudget;
+        }
+    }
+    if (c.promiscuous) {
+        // A membership rather than IFF_PROMISC: the kernel counts it and
+        // drops it with the socket, so nothing is left behind.
+        r.requested |= Promiscuous;
+        struct packet_mreq mreq{};
+        mreq.mr_ifindex = ifindex;
+        mreq.mr_type = PACKET_MR_PROMISC;
+        if (setsockopt(m_sockFd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0) {
+            r.applied |= Promiscuous;
+        }
+    }
+    if (c.ignore_outgoing) {
+        r.requested |= IgnoreOutgoing;
+        if (SetOption(m_sockFd, SOL_PACKET, PACKET_IGNORE_OUTGOING, 1)) {
+            r.applied |= IgnoreOutgoing;
+        }
+    }
+    if (c.cpu >= 0) {
+        r.requested |= CpuAffinity;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (c.cpu < CPU_SETSIZE) {
+            CPU_SET(c.cpu, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+                r.applied |= CpuAffinity;
+                r.cpu = c.cpu;
+            }
+        }
+    }
+    if (c.numa_node != -1) {
+        // MPOL_PREFERRED rather than BIND: a full node spills over instead
+        // of failing allocations.
+        r.requested |= NumaPolicy;
+        int node = c.numa_node == Config::InterfaceNode
+                       ? NumaNode(m_ifaceName, r.Applied(CpuAffinity))
+                       : c.numa_node;
+        constexpr int Bits = 8 * sizeof(unsigned long);
+        unsigned long mask[16] = {};
+        if (node >= 0 && node < 16 * Bits) {
+            mask[node / Bits] = 1ul << (node % Bits);
+            if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 16 * Bits + 1) == 0) {
+                r.applied |= NumaPolicy;
+                r.numa_node = node;
+            }
+        }
+    }
+}
+
+std::string Interface::Report::Summary() const {
+    static const char* const names[] = {
+        "rcvbuf",  "busy_poll",       "prefer_busy_poll", "busy_poll_budget",
+        "promisc", "ignore_outgoing", "cpu",              "numa",
+    };
+    std::string out;
+    auto add = [&out](const std::string& item) {
+        if (!out.empty()) {
+            out += ' ';
+        }
+        out += item;
+    };
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+        const Option option = static_cast<Option>(1u << bit);
+        if (!Applied(option)) {
+            continue;
+        }
+        std::string item = names[bit];
+        if (option == RcvBuf) {
+            item += "=" + std::to_string(rcvbuf) + (rcvbuf_forced ? "(forced)" : "");
+        } else if (option == BusyPoll) {
+            item += "=" + std::to_string(busy_poll_us) + "us";
+        } else if (option == CpuAffinity) {
+            item += "=" + std::to_string(cpu);
+        } else if (option == NumaPolicy) {
+            item += "=" + std::to_string(numa_node);
+        }
+        add(item);
+    }
+    std::string failed;
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+        if (Failed() & (1u << bit)) {
+            failed += failed.empty() ? "failed=" : ",";
+            failed += names[bit];
+        }
+    }
+    if (!failed.empty()) {
+        add(failed);
+    }
+    return out.empty() ? "defaults" : out;
+}
+
 void Interface::Close() {
     if (m_sockFd != -1) {
         ::close(m_sockFd);
@@ -69,4 +301,122 @@ ssize_t Interface::Receive(uint8_t* buffer, size_t length) {
     }
     return ::recv(m_sockFd, buffer, length, 0);
 }
+
+bool Interface::SetNonBlocking(bool enable) {
+    if (m_sockFd == -1) {
+        return false;
+    }
+    int flags = fcntl(m_sockFd, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(m_sockFd, F_SETFL, flags) == 0;
+}
+
+ssize_t Interface::ReceiveBatch(PacketBatch& batch) {
+    batch.m_size = 0;
+    if (m_sockFd == -1) {
+        return -1;
+    }
+
+    const size_t capacity = batch.Capacity();
+    const size_t controlSize = batch.m_control.size() / capacity;
+    for (size_t i = 0; i < capacity; ++i) {
+        batch.m_msgs[i].msg_hdr.msg_controllen = controlSize;
+    }
+
+    int n = ::recvmmsg(m_sockFd, batch.m_msgs.data(), static_cast<unsigned int>(capacity),
+                       MSG_WAITFORONE, nullptr);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    uint64_t fallback = 0;
+    for (int i = 0; i < n; ++i) {
+        struct msghdr& hdr = batch.m_msgs[i].msg_hdr;
+        uint64_t ts = 0;
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&hdr); c != nullptr; c = CMSG_NXTHDR(&hdr, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec tv;
+                std::memcpy(&tv, CMSG_DATA(c), sizeof(tv));
+                ts = static_cast<uint64_t>(tv.tv_sec) * 1000000000ull + tv.tv_nsec;
+            }
+        }
+        if (ts == 0) {
+            if (fallback == 0) {
+                struct timespec now;
+                clock_gettime(CLOCK_REALTIME, &now);
+                fallback = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+            }
+            ts = fallback;
+        }
+        batch.m_frames[i].length = batch.m_msgs[i].msg_len;
+        batch.m_frames[i].timestamp_ns = ts;
+    }
+    batch.m_size = static_cast<size_t>(n);
+    return n;
+}
+
+ssize_t Interface::Send(const uint8_t* data, size_t length) {
+    if (m_sockFd == -1) {
+        return -1;
+    }
+    return ::send(m_sockFd, data, length, 0);
+}
+
+ssize_t Interface::SendBatch(std::span<const FrameView> frames) {
+    if (m_sockFd == -1) {
+        return -1;
+    }
+
+    // The socket is bound to the interface, so no destination address is
+    // needed; frames go out exactly as given.
+    constexpr size_t Chunk = 64;
+    struct mmsghdr msgs[Chunk];
+    struct iovec iov[Chunk];
+    size_t sent = 0;
+    while (sent < frames.size()) {
+        const size_t count = std::min(Chunk, frames.size() - sent);
+        for (size_t i = 0; i < count; ++i) {
+            iov[i].iov_base = const_cast<uint8_t*>(frames[sent + i].data);
+            iov[i].iov_len = frames[sent + i].length;
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = ::sendmmsg(m_sockFd, msgs, static_cast<unsigned int>(count), 0);
+        if (n < 0) {
+            if (sent != 0) {
+                break;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        sent += static_cast<size_t>(n);
+        if (static_cast<size_t>(n) < count) {
+            break;
+        }
+    }
+    return static_cast<ssize_t>(sent);
+}
+
+bool Interface::BatchAwaiter::await_ready() {
+    m_result = m_iface.ReceiveBatch(m_batch);
+    return m_result != 0;
+}
+
+bool Interface::BatchAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    if (!m_loop.Watch(m_iface.Fd(), handle)) {
+        m_result = -1;
+        return false;
+    }
+    return true;
+}
+
+ssize_t Interface::BatchAwaiter::await_resume() {
+    if (m_result == 0) {
+        m_result = m_iface.ReceiveBatch(m_batch);
+    }
+    return m_result;
+}
 } // namespace libpkt
@@ -7,12 +7,12 @@
  */
 #include "libpkt/ipv4.hpp"
 
+#include "libpkt/format.hpp"
+
 #include <arpa/inet.h>
-#include <sstream>
 
 namespace libpkt {
-IPv4Packet::IPv4Packet(const uint8_t* data, size_t length)
-    : m_data(data), m_length(length), m_valid(false) {
+IPv4Packet::IPv4Packet(const uint8_t* data, size_t length) : Packet(data, length), m_valid(false) {
     if (length < MinHeaderSize)
         return;
 
@@ -52,33 +52,17 @@ uint8_t IPv4Packet::ProtocolRaw() const {
 Protocol IPv4Packet::GetProtocol() const {
     if (!IsValid())
         return Protocol::Unknown;
-    switch (ProtocolRaw()) {
-    case 0:
-        return Protocol::HOPOPT;
-    case 1:
-        return Protocol::ICMP;
-    case 2:
-        return Protocol::IGMP;
-    case 6:
-        return Protocol::TCP;
-    case 17:
-        return Protocol::UDP;
-    case 47:
-        return Protocol::GRE;
-    case 50:
-        return Protocol::ESP;
-    case 51:
-        return Protocol::AH;
-    case 88:
-        return Protocol::EIGRP;
-    case 89:
-        return Protocol::OSPF;
-    case 132:
-        return Protocol::SCTP;
-    default:
-        return Protocol::Unknown;
-    }
+    return ToProtocol(ProtocolRaw());
+}
+
+uint16_t IPv4Packet::FragmentOffset() const {
+    return static_cast<uint16_t>(((m_data[6] & 0x1F) << 8 | m_data[7]) * 8);
 }
+
+bool IPv4Packet::IsFragment() const {
+    return ((m_data[6] & 0x3F) | m_data[7]) != 0;
+}
+
 std::string IPv4Packet::SrcAddress() const {
     return IPToString(*reinterpret_cast<const uint32_t*>(m_data + 12));
 }
@@ -87,6 +71,14 @@ std::string IPv4Packet::DstAddress() const {
     return IPToString(*reinterpret_cast<const uint32_t*>(m_data + 16));
 }
 
+uint32_t IPv4Packet::SrcAddressRaw() const {
+    return ntohl(*reinterpret_cast<const uint32_t*>(m_data + 12));
+}
+
+uint32_t IPv4Packet::DstAddressRaw() const {
+    return ntohl(*reinterpret_cast<const uint32_t*>(m_data + 16));
+}
+
 const uint8_t* IPv4Packet::Payload() const {
     return m_data + HeaderLength();
 }
@@ -97,9 +89,27 @@ size_t IPv4Packet::PayloadLength() const {
     return (total_len > header_len && total_len <= m_length) ? (total_len - header_len) : 0;
 }
 
+std::string IPv4Packet::Summary() const {
+    TextBuffer out(80);
+    AppendSummary(out);
+    return out.String();
+}
+
+void IPv4Packet::AppendSummary(TextBuffer& out) const {
+    if (!m_valid) {
+        out.Append("Invalid IPv4 Packet");
+        return;
+    }
+    out.Append("IPv4 Packet: Src=").AppendIPv4(m_data + 12);
+    out.Append(", Dst=").AppendIPv4(m_data + 16);
+    out.Append(", Protocol=").Append(ProtocolName(GetProtocol()));
+    if (FragmentOffset() != 0)
+        out.Append(", Fragment Offset=").AppendUInt(FragmentOffset());
+}
+
 std::string IPv4Packet::IPToString(uint32_t ip) {
-    struct in_addr addr;
-    addr.s_addr = ip;
-    return std::string(inet_ntoa(addr));
+    TextBuffer out(15);
+    out.AppendIPv4(reinterpret_cast<const uint8_t*>(&ip));
+    return out.String();
 }
 } // namespace libpkt
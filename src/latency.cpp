@@ -0,0 +1,64 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/latency.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace libpkt {
+uint64_t LatencyHistogram::BucketLowerBound(size_t index) {
+    if (index < (1u << SubBucketBits))
+        return index;
+    unsigned exponent = static_cast<unsigned>(index >> SubBucketBits) + SubBucketBits - 1;
+    uint64_t mantissa = (1u << SubBucketBits) | (index & ((1u << SubBucketBits) - 1));
+    return mantissa << (exponent - SubBucketBits);
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+    if (m_count == 0)
+        return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * m_count + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        seen += m_counts[i];
+        if (seen >= rank) {
+            uint64_t upper = i + 1 < BucketCount ? BucketLowerBound(i + 1) - 1 : UINT64_MAX;
+            return std::clamp(upper, m_min, m_max);
+        }
+    }
+    return m_max;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BucketCount; ++i)
+        m_counts[i] += other.m_counts[i];
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::Reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+std::string LatencyHistogram::Summary() const {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << "count=" << m_count << " min=" << us(Min())
+        << "us p50=" << us(Percentile(0.5)) << "us p90=" << us(Percentile(0.9))
+        << "us p99=" << us(Percentile(0.99)) << "us max=" << us(Max()) << "us";
+    return oss.str();
+}
+} // namespace libpkt
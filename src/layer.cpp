@@ -0,0 +1,65 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/layer.hpp"
+
+namespace libpkt {
+size_t DecodeLayers(const uint8_t* frame, size_t length, Layer (&out)[MaxLayers]) {
+    EthernetFrame eth(frame, length);
+    if (!eth.IsValid())
+        return 0;
+    out[0].emplace<EthernetFrame>(eth);
+
+    switch (eth.Ethertype()) {
+    case EtherType::ARP: {
+        arp::Packet arp(eth.Payload(), eth.PayloadLength());
+        if (!arp.IsValid())
+            return 1;
+        out[1].emplace<arp::Packet>(arp);
+        return 2;
+    }
+    case EtherType::IPv4:
+        break;
+    default:
+        return 1;
+    }
+
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    if (!ip.IsValid())
+        return 1;
+    out[1].emplace<IPv4Packet>(ip);
+    // Only the first fragment of a datagram carries the transport header.
+    if (ip.FragmentOffset() != 0)
+        return 2;
+
+    switch (ip.GetProtocol()) {
+    case Protocol::TCP: {
+        tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+        if (!tcp.IsValid())
+            return 2;
+        out[2].emplace<tcp::Packet>(tcp);
+        return 3;
+    }
+    case Protocol::UDP: {
+        udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        if (!udp.IsValid())
+            return 2;
+        out[2].emplace<udp::Packet>(udp);
+        return 3;
+    }
+    case Protocol::ICMP: {
+        icmp::Packet icmp(ip.Payload(), ip.PayloadLength());
+        if (!icmp.IsValid())
+            return 2;
+        out[2].emplace<icmp::Packet>(icmp);
+        return 3;
+    }
+    default:
+        return 2;
+    }
+}
+} // namespace libpkt
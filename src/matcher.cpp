@@ -0,0 +1,345 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/matcher.hpp"
+
+#include "libpkt/simd_parse.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define LIBPKT_SIMD_X86 1
+#endif
+
+namespace libpkt::match {
+namespace {
+constexpr uint32_t MatchFlag = 0x80000000u;
+constexpr size_t TeddyBuckets = 8;
+constexpr size_t MaxTeddyBytes = 3;
+
+// The prefilter gives up for the rest of a scan once it has been called this
+// often while skipping fewer than MinAverageSkip bytes per call.
+constexpr size_t PrefilterProbation = 8;
+constexpr size_t MinAverageSkip = 32;
+
+struct BuildNode {
+    std::vector<std::pair<uint8_t, uint32_t>> edges; // sorted by byte
+    std::vector<uint32_t> outputs;
+    uint32_t fail = 0;
+};
+
+uint32_t FindEdge(const BuildNode& node, uint8_t byte) {
+    auto it = std::lower_bound(node.edges.begin(), node.edges.end(), std::make_pair(byte, 0u));
+    return (it != node.edges.end() && it->first == byte) ? it->second : UINT32_MAX;
+}
+
+#ifdef LIBPKT_SIMD_X86
+template <size_t K>
+__attribute__((target("avx2"))) size_t TeddyAVX2(const uint8_t (*lo)[32], const uint8_t (*hi)[32],
+                                                 const uint8_t* data, size_t pos, size_t length) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i loMask[K], hiMask[K];
+    for (size_t k = 0; k < K; ++k) {
+        loMask[k] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lo[k]));
+        hiMask[k] = _mm256_load_si256(reinterpret_cast<const __m256i*>(hi[k]));
+    }
+    // Position i + j is a candidate when bytes i + j .. i + j + K - 1 all
+    // agree with some bucket; shifted loads line the K bytes up per lane.
+    for (; pos + 32 + K - 1 <= length; pos += 32) {
+        __m256i acc = _mm256_set1_epi8(-1);
+        for (size_t k = 0; k < K; ++k) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + k));
+            __m256i l = _mm256_shuffle_epi8(loMask[k], _mm256_and_si256(v, nibble));
+            __m256i h = _mm256_shuffle_epi8(hiMask[k],
+                                            _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            acc = _mm256_and_si256(acc, _mm256_and_si256(l, h));
+        }
+        uint32_t empty = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(acc, _mm256_setzero_si256())));
+        if (empty != 0xFFFFFFFFu)
+            return pos + __builtin_ctz(~empty);
+    }
+    return pos;
+}
+
+bool HaveAVX2() {
+    static const bool avx2 = simd::DetectLevel() >= simd::Level::AVX2;
+    return avx2;
+}
+#endif
+} // namespace
+
+Matcher::Matcher(const Config& config)
+    : m_config(config), m_compiled(false), m_classes{}, m_classCount(0),
+      m_prefilterBytes(0), m_teddyLo{}, m_teddyHi{} {}
+
+int Matcher::Add(const uint8_t* pattern, size_t length) {
+    if (m_compiled || length == 0)
+        return -1;
+    m_patternOffsets.push_back(static_cast<uint32_t>(m_patternBytes.size()));
+    m_patternLengths.push_back(static_cast<uint32_t>(length));
+    m_patternBytes.insert(m_patternBytes.end(), pattern, pattern + length);
+    return static_cast<int>(m_patternLengths.size() - 1);
+}
+
+bool Matcher::Compile() {
+    if (m_compiled || m_patternLengths.empty())
+        return false;
+
+    // Trie.
+    std::vector<BuildNode> nodes(1);
+    for (uint32_t id = 0; id < m_patternLengths.size(); ++id) {
+        const uint8_t* p = m_patternBytes.data() + m_patternOffsets[id];
+        uint32_t state = 0;
+        for (size_t i = 0; i < m_patternLengths[id]; ++i) {
+            uint32_t next = FindEdge(nodes[state], p[i]);
+            if (next == UINT32_MAX) {
+                next = static_cast<uint32_t>(nodes.size());
+                auto& edges = nodes[state].edges;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(),
+                                              std::make_pair(p[i], 0u)),
+                             {p[i], next});
+                nodes.emplace_back();
+            }
+            state = next;
+        }
+        nodes[state].outputs.push_back(id);
+    }
+
+    // Failure links in breadth-first order; each state inherits the outputs
+    // of its failure state so matching never walks output chains.
+    std::vector<uint32_t> order;
+    order.reserve(nodes.size());
+    order.push_back(0);
+    for (size_t head = 0; head < order.size(); ++head) {
+        uint32_t state = order[head];
+        for (auto [byte, child] : nodes[state].edges) {
+            if (state != 0) {
+                uint32_t f = nodes[state].fail;
+                uint32_t target;
+                while ((target = FindEdge(nodes[f], byte)) == UINT32_MAX && f != 0)
+                    f = nodes[f].fail;
+                nodes[child].fail = target == UINT32_MAX ? 0 : target;
+                const auto& inherited = nodes[nodes[child].fail].outputs;
+                nodes[child].outputs.insert(nodes[child].outputs.end(), inherited.begin(),
+                                            inherited.end());
+            }
+            order.push_back(child);
+        }
+    }
+
+    // Flatten.
+    const size_t states = nodes.size();
+    m_fail.resize(states);
+    m_edgeBegin.resize(states + 1);
+    m_outputBegin.resize(states + 1);
+    for (size_t s = 0; s < states; ++s) {
+        m_fail[s] = nodes[s].fail;
+        m_edgeBegin[s] = static_cast<uint32_t>(m_edgeBytes.size());
+        m_outputBegin[s] = static_cast<uint32_t>(m_outputs.size());
+        for (auto [byte, child] : nodes[s].edges) {
+            m_edgeBytes.push_back(byte);
+            m_edgeTargets.push_back(child);
+        }
+        m_outputs.insert(m_outputs.end(), nodes[s].outputs.begin(), nodes[s].outputs.end());
+    }
+    m_edgeBegin[states] = static_cast<uint32_t>(m_edgeBytes.size());
+    m_outputBegin[states] = static_cast<uint32_t>(m_outputs.size());
+    // Complete rows for the root and its children: the automaton spends most
+    // of its time there, and failure chains end after at most one hop.
+    // BFS order lists the root and then exactly its children.
+    const size_t denseStates = 1 + nodes[0].edges.size();
+    m_denseRow.assign(states, UINT32_MAX);
+    m_dense.assign(denseStates * 256, 0);
+    for (uint32_t row = 0; row < denseStates; ++row) {
+        const uint32_t s = order[row];
+        m_denseRow[s] = row;
+        for (int b = 0; b < 256; ++b) {
+            uint32_t target = FindEdge(nodes[s], static_cast<uint8_t>(b));
+            // Depth-1 states fail to the root, which is row 0.
+            m_dense[row * 256 + b] = target != UINT32_MAX ? target : s == 0 ? 0 : m_dense[b];
+        }
+    }
+
+    // Bytes that occur in no pattern all behave alike: class 0.
+    bool used[256] = {};
+    for (uint8_t b : m_patternBytes)
+        used[b] = true;
+    m_classCount = 1;
+    for (int b = 0; b < 256; ++b)
+        m_classes[b] = used[b] ? static_cast<uint16_t>(m_classCount++) : 0;
+
+    if (states * m_classCount * sizeof(uint32_t) <= m_config.max_dfa_bytes &&
+        states * m_classCount < MatchFlag) {
+        uint8_t representative[257] = {};
+        for (int b = 0; b < 256; ++b)
+            representative[m_classes[b]] = static_cast<uint8_t>(b);
+        m_dfa.assign(states * m_classCount, 0);
+        // BFS order guarantees fail states are complete before their users.
+        for (uint32_t s : order) {
+            for (uint32_t c = 0; c < m_classCount; ++c) {
+                // Class 0 bytes occur in no pattern, so never have an edge.
+                uint32_t target = c == 0 ? UINT32_MAX : FindEdge(nodes[s], representative[c]);
+                uint32_t entry;
+                if (target != UINT32_MAX) {
+                    entry = target * m_classCount;
+                    if (m_outputBegin[target] != m_outputBegin[target + 1])
+                        entry |= MatchFlag;
+                } else {
+                    entry = s == 0 ? 0 : m_dfa[m_fail[s] * m_classCount + c];
+                }
+                m_dfa[s * m_classCount + c] = entry;
+            }
+        }
+    }
+
+    // Teddy fingerprints over the first K bytes of each pattern.
+    size_t shortest = *std::min_element(m_patternLengths.begin(), m_patternLengths.end());
+    bool prefilter = m_patternLengths.size() <= m_config.prefilter_max_patterns;
+    m_prefilterBytes = prefilter ? std::min(shortest, MaxTeddyBytes) : 0;
+    std::memset(m_teddyLo, 0, sizeof(m_teddyLo));
+    std::memset(m_teddyHi, 0, sizeof(m_teddyHi));
+    for (uint32_t id = 0; id < m_patternLengths.size(); ++id) {
+        const uint8_t* p = m_patternBytes.data() + m_patternOffsets[id];
+        // Patterns sharing a prefix share a bucket, keeping the others sparse.
+        uint32_t h = 0;
+        for (size_t k = 0; k < m_prefilterBytes; ++k)
+            h = h * 31 + p[k];
+        uint8_t bit = static_cast<uint8_t>(1u << ((h * 0x9E3779B1u) >> 29));
+        for (size_t k = 0; k < m_prefilterBytes; ++k) {
+            // Both 128-bit lanes carry the table for the in-lane shuffle.
+            m_teddyLo[k][p[k] & 15] |= bit;
+            m_teddyLo[k][16 + (p[k] & 15)] |= bit;
+            m_teddyHi[k][p[k] >> 4] |= bit;
+            m_teddyHi[k][16 + (p[k] >> 4)] |= bit;
+        }
+    }
+    static_assert(TeddyBuckets == 8, "bucket bits are one byte");
+
+    m_patternBytes.clear();
+    m_patternBytes.shrink_to_fit();
+    m_compiled = true;
+    return true;
+}
+
+size_t Matcher::Prefilter(const uint8_t* data, size_t pos, size_t length) const {
+    const size_t k = m_prefilterBytes;
+#ifdef LIBPKT_SIMD_X86
+    if (HaveAVX2()) {
+        if (k == 1)
+            pos = TeddyAVX2<1>(m_teddyLo, m_teddyHi, data, pos, length);
+        else if (k == 2)
+            pos = TeddyAVX2<2>(m_teddyLo, m_teddyHi, data, pos, length);
+        else
+            pos = TeddyAVX2<3>(m_teddyLo, m_teddyHi, data, pos, length);
+    }
+#endif
+    // Tail (or no AVX2). Near the end only the bytes present are checked,
+    // since a pattern may continue in the next chunk of a stream.
+    for (; pos < length; ++pos) {
+        uint8_t buckets = 0xFF;
+        for (size_t i = 0; i < k && pos + i < length; ++i) {
+            uint8_t b = data[pos + i];
+            buckets &= m_teddyLo[i][b & 15] & m_teddyHi[i][b >> 4];
+        }
+        if (buckets)
+            return pos;
+    }
+    return length;
+}
+
+uint32_t Matcher::NextNFA(uint32_t state, uint8_t byte) const {
+    for (;;) {
+        const uint32_t row = m_denseRow[state];
+        if (row != UINT32_MAX)
+            return m_dense[row * 256 + byte];
+        const uint32_t begin = m_edgeBegin[state];
+        const uint32_t end = m_edgeBegin[state + 1];
+        if (end - begin <= 8) {
+            for (uint32_t e = begin; e < end; ++e) {
+                if (m_edgeBytes[e] == byte)
+                    return m_edgeTargets[e];
+            }
+        } else {
+            const uint8_t* first = m_edgeBytes.data() + begin;
+            const uint8_t* last = m_edgeBytes.data() + end;
+            const uint8_t* it = std::lower_bound(first, last, byte);
+            if (it != last && *it == byte)
+                return m_edgeTargets[it - m_edgeBytes.data()];
+        }
+        state = m_fail[state];
+    }
+}
+
+size_t Matcher::Report(uint32_t state, uint64_t end, MatchSink sink, void* context) const {
+    const uint32_t first = m_outputBegin[state];
+    const uint32_t last = m_outputBegin[state + 1];
+    if (sink != nullptr) {
+        for (uint32_t i = first; i < last; ++i)
+            sink(m_outputs[i], end, context);
+    }
+    return last - first;
+}
+
+template <bool DFA>
+size_t Matcher::Run(StreamState& stream, const uint8_t* data, size_t length, MatchSink sink,
+                    void* context) const {
+    size_t matches = 0;
+    uint32_t state = stream.state;
+    bool prefilter = m_prefilterBytes != 0;
+    size_t calls = 0;
+    size_t skipped = 0;
+
+    size_t i = 0;
+    while (i < length) {
+        if (state == 0 && prefilter) {
+            size_t next = Prefilter(data, i, length);
+            skipped += next - i;
+            if (++calls >= PrefilterProbation && skipped < calls * MinAverageSkip)
+                prefilter = false;
+            i = next;
+            if (i == length)
+                break;
+        }
+        // Step until a match attempt dies back to the start state.
+        do {
+            if constexpr (DFA) {
+                state = m_dfa[state + m_classes[data[i]]];
+                if (state & MatchFlag) {
+                    state &= ~MatchFlag;
+                    matches += Report(state / m_classCount, stream.offset + i + 1, sink, context);
+                }
+            } else {
+                state = NextNFA(state, data[i]);
+                if (m_outputBegin[state] != m_outputBegin[state + 1])
+                    matches += Report(state, stream.offset + i + 1, sink, context);
+            }
+            ++i;
+        } while (i < length && (state != 0 || !prefilter));
+    }
+
+    stream.state = state;
+    stream.offset += length;
+    return matches;
+}
+
+size_t Matcher::Scan(StreamState& stream, const uint8_t* data, size_t length, MatchSink sink,
+                     void* context) const {
+    if (!m_compiled)
+        return 0;
+    return UsesDFA() ? Run<true>(stream, data, length, sink, context)
+                     : Run<false>(stream, data, length, sink, context);
+}
+
+size_t Matcher::Scan(const uint8_t* data, size_t length, MatchSink sink, void* context) const {
+    StreamState stream;
+    return Scan(stream, data, length, sink, context);
+}
+
+} // namespace libpkt::match
@@ -0,0 +1,251 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/neighbor.hpp"
+#include "libpkt/ethernet.hpp"
+
+#include <cstring>
+
+namespace libpkt::arp {
+namespace {
+uint64_t PackMAC(const uint8_t* mac) {
+    uint64_t v = 0;
+    std::memcpy(&v, mac, 6);
+    return v;
+}
+
+void UnpackMAC(uint64_t v, uint8_t* mac) {
+    std::memcpy(mac, &v, 6);
+}
+
+void Pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+} // namespace
+
+NeighborCache::NeighborCache(const Config& config)
+    : m_config(config), m_layout(0), m_size(0), m_hand(0) {
+    size_t capacity = 16;
+    while (capacity < m_config.capacity)
+        capacity *= 2;
+    m_slots = std::make_unique<Slot[]>(capacity);
+    m_mask = capacity - 1;
+}
+
+size_t NeighborCache::Home(uint32_t ip) const {
+    return (ip * 0x9E3779B97F4A7C15ull >> 32) & m_mask;
+}
+
+bool NeighborCache::Read(const Slot& slot, Neighbor& out) const {
+    for (;;) {
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            Pause();
+            continue;
+        }
+        out.ip = slot.ip.load(std::memory_order_relaxed);
+        uint64_t mac = slot.mac.load(std::memory_order_relaxed);
+        out.first_seen_ns = slot.first_ns.load(std::memory_order_relaxed);
+        out.last_seen_ns = slot.last_ns.load(std::memory_order_relaxed);
+        out.changes = slot.changes.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+            continue;
+        UnpackMAC(mac, out.mac);
+        return out.ip != 0;
+    }
+}
+
+void NeighborCache::Write(Slot& slot, const Neighbor& value) {
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ip.store(value.ip, std::memory_order_relaxed);
+    slot.mac.store(PackMAC(value.mac), std::memory_order_relaxed);
+    slot.first_ns.store(value.first_seen_ns, std::memory_order_relaxed);
+    slot.last_ns.store(value.last_seen_ns, std::memory_order_relaxed);
+    slot.changes.store(value.changes, std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool NeighborCache::Lookup(uint32_t ip, Neighbor& out) const {
+    if (ip == 0)
+        return false;
+    for (;;) {
+        uint32_t layout = m_layout.load(std::memory_order_acquire);
+        if (layout & 1) {
+            Pause();
+            continue;
+        }
+        bool found = false;
+        size_t i = Home(ip);
+        for (size_t probes = 0; probes <= m_mask; ++probes, i = (i + 1) & m_mask) {
+            Neighbor entry;
+            if (!Read(m_slots[i], entry))
+                break;
+            if (entry.ip == ip) {
+                out = entry;
+                found = true;
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_layout.load(std::memory_order_relaxed) == layout)
+            return found;
+    }
+}
+
+bool NeighborCache::Lookup(uint32_t ip, uint8_t* mac) const {
+    Neighbor entry;
+    if (!Lookup(ip, entry))
+        return false;
+    std::memcpy(mac, entry.mac, 6);
+    return true;
+}
+
+bool NeighborCache::Learn(const Packet& arp, uint64_t now_ns) {
+    if (!arp.IsValid() || !arp.IsEthernetIPv4() || arp.IsProbe() ||
+        (arp.Opcode() != Request && arp.Opcode() != Reply)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.ignored;
+        return false;
+    }
+    return Update(arp.SenderIPRaw(), arp.SenderMACRaw(), now_ns);
+}
+
+bool NeighborCache::Learn(const FrameView& frame) {
+    EthernetFrame eth(frame.data, frame.length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::ARP)
+        return false;
+    return Learn(Packet(eth.Payload(), eth.PayloadLength()), frame.timestamp_ns);
+}
+
+bool NeighborCache::Update(uint32_t ip, const uint8_t* mac, uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Multicast, broadcast and all-zero senders are never real bindings.
+    if (ip == 0 || (mac[0] & 1) || PackMAC(mac) == 0) {
+        ++m_stats.ignored;
+        return false;
+    }
+
+    size_t i = Home(ip);
+    for (;; i = (i + 1) & m_mask) {
+        uint32_t slotIp = m_slots[i].ip.load(std::memory_order_relaxed);
+        if (slotIp == 0)
+            break;
+        if (slotIp != ip)
+            continue;
+
+        Neighbor entry;
+        Read(m_slots[i], entry);
+        if (std::memcmp(entry.mac, mac, 6) == 0) {
+            if (now_ns > entry.last_seen_ns) {
+                entry.last_seen_ns = now_ns;
+                Write(m_slots[i], entry);
+            }
+            ++m_stats.updates;
+            return true;
+        }
+        uint8_t previous[6];
+        std::memcpy(previous, entry.mac, 6);
+        bool conflict = now_ns < entry.last_seen_ns + m_config.conflict_window_ns;
+        std::memcpy(entry.mac, mac, 6);
+        entry.first_seen_ns = now_ns;
+        entry.last_seen_ns = now_ns;
+        ++entry.changes;
+        Write(m_slots[i], entry);
+        if (conflict)
+            ++m_stats.conflicts;
+        else
+            ++m_stats.changes;
+        Emit(conflict ? Event::Conflict : Event::Changed, entry, previous);
+        return true;
+    }
+
+    if (Size() >= (m_mask + 1) / 4 * 3) {
+        // Make room by evicting the first entry from the new key's home, then
+        // find the free slot again since the removal shifts entries back.
+        size_t victim = Home(ip);
+        while (m_slots[victim].ip.load(std::memory_order_relaxed) == 0)
+            victim = (victim + 1) & m_mask;
+        Neighbor evicted;
+        Read(m_slots[victim], evicted);
+        Erase(victim);
+        ++m_stats.evictions;
+        Emit(Event::Removed, evicted, nullptr);
+        i = Home(ip);
+        while (m_slots[i].ip.load(std::memory_order_relaxed) != 0)
+            i = (i + 1) & m_mask;
+    }
+
+    Neighbor entry{};
+    entry.ip = ip;
+    std::memcpy(entry.mac, mac, 6);
+    entry.first_seen_ns = now_ns;
+    entry.last_seen_ns = now_ns;
+    Write(m_slots[i], entry);
+    m_size.fetch_add(1, std::memory_order_relaxed);
+    ++m_stats.inserts;
+    Emit(Event::New, entry, nullptr);
+    return true;
+}
+
+size_t NeighborCache::Expire(uint64_t now_ns, size_t budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t removed = 0;
+    for (size_t n = 0; n < budget && Size() != 0; ++n) {
+        Neighbor entry;
+        if (Read(m_slots[m_hand], entry) && entry.last_seen_ns + m_config.max_age_ns <= now_ns) {
+            Erase(m_hand);
+            ++m_stats.expired;
+            ++removed;
+            Emit(Event::Removed, entry, nullptr);
+            continue; // the shift may have moved another entry into this slot
+        }
+        m_hand = (m_hand + 1) & m_mask;
+    }
+    return removed;
+}
+
+void NeighborCache::Erase(size_t slot) {
+    // Readers retry while entries move, so a lookup racing with the shift
+    // cannot step past an entry on its way back toward its home slot.
+    uint32_t layout = m_layout.load(std::memory_order_relaxed);
+    m_layout.store(layout + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t hole = slot;
+    for (size_t i = (hole + 1) & m_mask;; i = (i + 1) & m_mask) {
+        Neighbor entry;
+        if (!Read(m_slots[i], entry))
+            break;
+        size_t home = Home(entry.ip);
+        // Move it back unless its home lies cyclically in (hole, i].
+        if (((i - home) & m_mask) >= ((i - hole) & m_mask)) {
+            Write(m_slots[hole], entry);
+            hole = i;
+        }
+    }
+    Write(m_slots[hole], Neighbor{});
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+
+    m_layout.store(layout + 2, std::memory_order_release);
+}
+
+void NeighborCache::Emit(Event event, const Neighbor& neighbor, const uint8_t* previous) {
+    if (m_config.sink != nullptr)
+        m_config.sink(event, neighbor, previous, m_config.context);
+}
+
+NeighborCache::Stats NeighborCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace libpkt::arp
@@ -0,0 +1,624 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/netflow.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace libpkt::netflow {
+namespace {
+constexpr size_t IPFIXHeaderSize = 16;
+constexpr size_t V9HeaderSize = 20;
+constexpr size_t SetHeaderSize = 4;
+constexpr uint16_t IPFIXTemplateSet = 2;
+constexpr uint16_t IPFIXOptionsSet = 3;
+constexpr uint16_t V9TemplateSet = 0;
+constexpr uint16_t V9OptionsSet = 1;
+constexpr uint16_t MinDataSetId = 256;
+constexpr size_t MaxProbe = 16; // a flow sits at most this far past its home slot
+
+// Information element ids (shared by IPFIX and NetFlow v9 where they exist).
+enum : uint16_t {
+    IE_OctetDelta = 1,
+    IE_PacketDelta = 2,
+    IE_Protocol = 4,
+    IE_TcpFlags = 6,
+    IE_SrcPort = 7,
+    IE_SrcIPv4 = 8,
+    IE_DstPort = 11,
+    IE_DstIPv4 = 12,
+    IE_V9LastSwitched = 21,
+    IE_V9FirstSwitched = 22,
+    IE_FlowStartSeconds = 150,
+    IE_FlowEndSeconds = 151,
+    IE_FlowStartMs = 152,
+    IE_FlowEndMs = 153,
+};
+
+struct TemplateField {
+    uint16_t id;
+    uint16_t length;
+};
+
+constexpr TemplateField IPFIXTemplate[] = {
+    {IE_SrcIPv4, 4},      {IE_DstIPv4, 4},      {IE_SrcPort, 2},   {IE_DstPort, 2},
+    {IE_Protocol, 1},     {IE_TcpFlags, 1},     {IE_PacketDelta, 8}, {IE_OctetDelta, 8},
+    {IE_FlowStartMs, 8}, {IE_FlowEndMs, 8},
+};
+
+constexpr TemplateField V9Template[] = {
+    {IE_SrcIPv4, 4},         {IE_DstIPv4, 4},        {IE_SrcPort, 2},   {IE_DstPort, 2},
+    {IE_Protocol, 1},        {IE_TcpFlags, 1},       {IE_PacketDelta, 8}, {IE_OctetDelta, 8},
+    {IE_V9FirstSwitched, 4}, {IE_V9LastSwitched, 4},
+};
+
+constexpr size_t RecordSize(const TemplateField (&fields)[10]) {
+    size_t n = 0;
+    for (const auto& f : fields)
+        n += f.length;
+    return n;
+}
+
+uint64_t NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+void Put(std::vector<uint8_t>& buf, uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i-- > 0;)
+        buf.push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+void PutAt(std::vector<uint8_t>& buf, size_t offset, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i)
+        buf[offset + i] = static_cast<uint8_t>(value >> ((bytes - 1 - i) * 8));
+}
+
+uint64_t Get(const uint8_t* p, size_t bytes) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+} // namespace
+
+// ---------------------------------------------------------------------------
+// FlowTable
+
+FlowTable::FlowTable(const Config& config, RecordSink sink, void* context)
+    : m_config(config), m_sink(sink), m_context(context), m_size(0), m_hand(0) {
+    size_t capacity = 16;
+    while (capacity < config.capacity)
+        capacity <<= 1;
+    m_slots.assign(capacity, Slot{});
+}
+
+void FlowTable::Update(const FlowKey& key, uint64_t timestamp_ns, uint32_t bytes,
+                       uint8_t tcpFlags) {
+    const uint64_t hash = HashFlowKey(key);
+    const size_t mask = m_slots.size() - 1;
+
+    const size_t home = Home(hash);
+    size_t slot = home;
+    size_t distance = 0;
+    for (; distance < MaxProbe; ++distance, slot = (slot + 1) & mask) {
+        const Slot& s = m_slots[slot];
+        if (!s.used || (s.hash == hash && s.record.key == key))
+            break;
+    }
+
+    // A new flow replaces an old one past 3/4 load, or when its probe window
+    // is full. Every slot from its home up to `slot` is in use, so it takes
+    // the least recently seen of them in place: appending at the end of the
+    // run instead would let clusters grow until lookups scan most of the
+    // table.
+    if (distance == MaxProbe || (!m_slots[slot].used && m_size >= m_slots.size() / 4 * 3)) {
+        if (distance != 0) {
+            size_t victim = home;
+            for (size_t n = 1, s = (home + 1) & mask; n < distance; ++n, s = (s + 1) & mask) {
+                if (m_slots[s].record.last_ns < m_slots[victim].record.last_ns)
+                    victim = s;
+            }
+            Emit(m_slots[victim].record);
+            m_slots[victim].used = false;
+            --m_size;
+            slot = victim;
+        } else {
+            // Nothing on the probe path: push out the next flow along.
+            size_t victim = (home + 1) & mask;
+            while (!m_slots[victim].used)
+                victim = (victim + 1) & mask;
+            Emit(m_slots[victim].record);
+            Erase(victim);
+        }
+    }
+    if (!m_slots[slot].used) {
+        Slot& s = m_slots[slot];
+        s.used = true;
+        s.hash = hash;
+        s.record = {};
+        s.record.key = key;
+        s.record.first_ns = timestamp_ns;
+        ++m_size;
+    }
+
+    FlowRecord& rec = m_slots[slot].record;
+    if (timestamp_ns > rec.first_ns && timestamp_ns - rec.first_ns >= m_config.active_timeout_ns &&
+        rec.packets != 0) {
+        Emit(rec);
+        rec.first_ns = timestamp_ns;
+        rec.packets = 0;
+        rec.bytes = 0;
+        rec.tcp_flags = 0;
+    }
+    rec.last_ns = std::max(rec.last_ns, timestamp_ns);
+    rec.packets += 1;
+    rec.bytes += bytes;
+    rec.tcp_flags |= tcpFlags;
+}
+
+bool FlowTable::Update(const FrameView& frame) {
+    EthernetFrame eth(frame.data, frame.length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    if (!ip.IsValid())
+        return false;
+
+    // Fragments are accounted to the address pair: only the first one
+    // carries ports.
+    FlowKey key{ip.SrcAddressRaw(), ip.DstAddressRaw(), 0, 0, ip.ProtocolRaw()};
+    uint8_t flags = 0;
+    const bool ports = !ip.IsFragment();
+    if (ports && ip.GetProtocol() == Protocol::TCP) {
+        tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+        key.src_port = tcp.SrcPort();
+        key.dst_port = tcp.DstPort();
+        flags = tcp.Flags();
+    } else if (ports && ip.GetProtocol() == Protocol::UDP) {
+        udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        key.src_port = udp.SrcPort();
+        key.dst_port = udp.DstPort();
+    }
+    // Flow byte counts are IP-level, as in NetFlow/IPFIX octet deltas.
+    Update(key, frame.timestamp_ns, ip.TotalLength(), flags);
+    return true;
+}
+
+// Linear-probing removal with backward shift. No flow sits MaxProbe or
+// more past its home, so none that far beyond the hole can move into it.
+void FlowTable::Erase(size_t slot) {
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slot;
+    size_t next = slot;
+    for (;;) {
+        m_slots[hole].used = false;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (!m_slots[next].used || ((next - hole) & mask) >= MaxProbe) {
+                --m_size;
+                return;
+            }
+            size_t home = Home(m_slots[next].hash);
+            bool between = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!between)
+                break;
+        }
+        m_slots[hole] = m_slots[next];
+        hole = next;
+    }
+}
+
+void FlowTable::Expire(uint64_t now_ns, size_t budget) {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t n = 0; n < budget && m_size != 0; ++n) {
+        Slot& s = m_slots[m_hand];
+        if (s.used && now_ns > s.record.last_ns &&
+            now_ns - s.record.last_ns >= m_config.idle_timeout_ns) {
+            Emit(s.record);
+            Erase(m_hand); // may pull a later flow into this slot: look again
+            continue;
+        }
+        m_hand = (m_hand + 1) & mask;
+    }
+}
+
+void FlowTable::FlushAll() {
+    for (Slot& s : m_slots) {
+        if (s.used) {
+            Emit(s.record);
+            s.used = false;
+        }
+    }
+    m_size = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Exporter
+
+Exporter::Exporter(const Config& config)
+    : m_config(config), m_fd(-1), m_isFile(false), m_sequence(0), m_startNs(NowNs()),
+      m_lastTemplateNs(0), m_messagesSinceTemplate(0), m_queued(0), m_current(nullptr),
+      m_dataSetOffset(0), m_recordsInMessage(0) {
+    m_config.batch = std::max<size_t>(m_config.batch, 1);
+    m_config.max_datagram = std::clamp<size_t>(m_config.max_datagram, 256, 65507);
+    m_queue.resize(m_config.batch);
+    for (auto& datagram : m_queue)
+        datagram.reserve(m_config.max_datagram);
+}
+
+Exporter::~Exporter() {
+    Close();
+}
+
+bool Exporter::OpenUDP(const std::string& host, uint16_t port) {
+    Close();
+    struct addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* res = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &res) != 0)
+        return false;
+
+    for (struct addrinfo* ai = res; ai != nullptr; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            m_fd = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    freeaddrinfo(res);
+    m_isFile = false;
+    m_lastTemplateNs = 0;
+    return m_fd >= 0;
+}
+
+bool Exporter::OpenFile(const std::string& path) {
+    Close();
+    if (m_config.format != Format::IPFIX) {
+        errno = EINVAL;
+        return false;
+    }
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    m_isFile = true;
+    m_lastTemplateNs = 0;
+    return m_fd >= 0;
+}
+
+void Exporter::Close() {
+    if (m_fd >= 0) {
+        Flush();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void Exporter::BeginMessage(uint64_t now_ns) {
+    m_current = &m_queue[m_queued];
+    m_current->clear();
+    m_current->resize(m_config.format == Format::IPFIX ? IPFIXHeaderSize : V9HeaderSize);
+    m_dataSetOffset = 0;
+    m_recordsInMessage = 0;
+
+    bool templateDue = m_lastTemplateNs == 0 ||
+                       m_messagesSinceTemplate >= m_config.template_refresh_messages ||
+                       now_ns - m_lastTemplateNs >= m_config.template_refresh_ns;
+    if (!templateDue)
+        return;
+
+    const bool ipfix = m_config.format == Format::IPFIX;
+    const auto& fields = ipfix ? IPFIXTemplate : V9Template;
+    std::vector<uint8_t>& buf = *m_current;
+    Put(buf, ipfix ? IPFIXTemplateSet : V9TemplateSet, 2);
+    Put(buf, SetHeaderSize + 4 + std::size(fields) * 4, 2);
+    Put(buf, TemplateId, 2);
+    Put(buf, std::size(fields), 2);
+    for (const auto& f : fields) {
+        Put(buf, f.id, 2);
+        Put(buf, f.length, 2);
+    }
+    ++m_recordsInMessage; // v9 counts template records too
+    m_lastTemplateNs = now_ns;
+    m_messagesSinceTemplate = 0;
+}
+
+void Exporter::FinishMessage() {
+    if (m_current == nullptr)
+        return;
+    std::vector<uint8_t>& buf = *m_current;
+    if (m_dataSetOffset != 0)
+        PutAt(buf, m_dataSetOffset + 2, buf.size() - m_dataSetOffset, 2);
+
+    const uint64_t now = NowNs();
+    if (m_config.format == Format::IPFIX) {
+        PutAt(buf, 0, 10, 2);
+        PutAt(buf, 2, buf.size(), 2);
+        PutAt(buf, 4, now / 1000000000ull, 4);
+        PutAt(buf, 8, m_sequence, 4); // data records sent before this message
+        PutAt(buf, 12, m_config.observation_domain, 4);
+        m_sequence += m_recordsInMessage - (m_messagesSinceTemplate == 0 ? 1 : 0);
+    } else {
+        PutAt(buf, 0, 9, 2);
+        PutAt(buf, 2, m_recordsInMessage, 2);
+        PutAt(buf, 4, (now - m_startNs) / 1000000ull, 4); // sysUptime
+        PutAt(buf, 8, now / 1000000000ull, 4);
+        PutAt(buf, 12, m_sequence++, 4); // export packets
+        PutAt(buf, 16, m_config.observation_domain, 4);
+    }
+
+    ++m_stats.messages;
+    ++m_messagesSinceTemplate;
+    m_current = nullptr;
+    if (++m_queued == m_queue.size())
+        SendQueued();
+}
+
+void Exporter::Export(const FlowRecord& record) {
+    const bool ipfix = m_config.format == Format::IPFIX;
+    const size_t recordSize = ipfix ? RecordSize(IPFIXTemplate) : RecordSize(V9Template);
+
+    if (m_current != nullptr &&
+        m_current->size() + recordSize + (m_dataSetOffset ? 0 : SetHeaderSize) >
+            m_config.max_datagram)
+        FinishMessage();
+    if (m_current == nullptr)
+        BeginMessage(NowNs());
+
+    std::vector<uint8_t>& buf = *m_current;
+    if (m_dataSetOffset == 0) {
+        m_dataSetOffset = buf.size();
+        Put(buf, TemplateId, 2);
+        Put(buf, 0, 2); // length, patched in FinishMessage()
+    }
+
+    Put(buf, record.key.src_ip, 4);
+    Put(buf, record.key.dst_ip, 4);
+    Put(buf, record.key.src_port, 2);
+    Put(buf, record.key.dst_port, 2);
+    Put(buf, record.key.protocol, 1);
+    Put(buf, record.tcp_flags, 1);
+    Put(buf, record.packets, 8);
+    Put(buf, record.bytes, 8);
+    if (ipfix) {
+        Put(buf, record.first_ns / 1000000ull, 8);
+        Put(buf, record.last_ns / 1000000ull, 8);
+    } else {
+        // sysUptime-relative milliseconds; flows from before start clamp to 0.
+        auto uptime = [&](uint64_t ns) { return ns > m_startNs ? (ns - m_startNs) / 1000000 : 0; };
+        Put(buf, uptime(record.first_ns), 4);
+        Put(buf, uptime(record.last_ns), 4);
+    }
+    ++m_recordsInMessage;
+    ++m_stats.records;
+}
+
+bool Exporter::Flush() {
+    FinishMessage();
+    return SendQueued();
+}
+
+bool Exporter::SendQueued() {
+    const size_t count = m_queued;
+    m_queued = 0;
+    if (count == 0)
+        return true;
+    if (m_fd < 0) {
+        m_stats.send_errors += count;
+        return false;
+    }
+
+    bool ok = true;
+    if (m_isFile) {
+        for (size_t i = 0; i < count; ++i) {
+            const auto& d = m_queue[i];
+            if (::write(m_fd, d.data(), d.size()) != static_cast<ssize_t>(d.size())) {
+                ++m_stats.send_errors;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    // Fixed-size chunks keep the headers on the stack whatever the queue
+    // depth.
+    constexpr size_t Chunk = 64;
+    struct iovec iov[Chunk];
+    struct mmsghdr msgs[Chunk];
+    for (size_t sent = 0; sent < count;) {
+        const size_t chunk = std::min(Chunk, count - sent);
+        for (size_t i = 0; i < chunk; ++i) {
+            iov[i] = {m_queue[sent + i].data(), m_queue[sent + i].size()};
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        for (size_t done = 0; done < chunk;) {
+            int n = sendmmsg(m_fd, msgs + done, static_cast<unsigned int>(chunk - done), 0);
+            if (n <= 0) {
+                m_stats.send_errors += count - sent - done;
+                return false;
+            }
+            done += n;
+        }
+        sent += chunk;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Collector
+
+int Collector::Feed(const uint8_t* data, size_t length, RecordSink sink, void* context) {
+    if (length < 4)
+        return -1;
+    const uint16_t version = static_cast<uint16_t>(Get(data, 2));
+    const bool ipfix = version == 10;
+    if (!ipfix && version != 9)
+        return -1;
+
+    size_t headerSize = ipfix ? IPFIXHeaderSize : V9HeaderSize;
+    if (length < headerSize)
+        return -1;
+    size_t end = length;
+    uint32_t domain;
+    uint64_t uptimeBaseMs = 0; // v9: unix time (ms) at which sysUptime was 0
+    if (ipfix) {
+        end = std::min<size_t>(Get(data + 2, 2), length);
+        domain = static_cast<uint32_t>(Get(data + 12, 4));
+    } else {
+        uint64_t uptime = Get(data + 4, 4);
+        uint64_t unixMs = Get(data + 8, 4) * 1000;
+        uptimeBaseMs = unixMs > uptime ? unixMs - uptime : 0;
+        domain = static_cast<uint32_t>(Get(data + 16, 4));
+    }
+
+    int records = 0;
+    size_t off = headerSize;
+    while (off + SetHeaderSize <= end) {
+        const uint16_t setId = static_cast<uint16_t>(Get(data + off, 2));
+        const size_t setLen = Get(data + off + 2, 2);
+        if (setLen < SetHeaderSize || off + setLen > end)
+            return -1;
+        const uint8_t* p = data + off + SetHeaderSize;
+        const uint8_t* setEnd = data + off + setLen;
+        off += setLen;
+
+        if (setId == (ipfix ? IPFIXTemplateSet : V9TemplateSet)) {
+            while (setEnd - p >= 4) {
+                uint16_t id = static_cast<uint16_t>(Get(p, 2));
+                uint16_t count = static_cast<uint16_t>(Get(p + 2, 2));
+                p += 4;
+                std::vector<Field> fields;
+                for (uint16_t i = 0; i < count; ++i) {
+                    if (setEnd - p < 4)
+                        return -1;
+                    Field f{static_cast<uint16_t>(Get(p, 2)), static_cast<uint16_t>(Get(p + 2, 2))};
+                    p += 4;
+                    if (ipfix && (f.id & 0x8000)) {
+                        if (setEnd - p < 4)
+                            return -1;
+                        p += 4; // enterprise number: keep the field, but as unknown
+                    }
+                    fields.push_back(f);
+                }
+                if (id >= MinDataSetId)
+                    m_templates[{domain, id}] = std::move(fields);
+            }
+            continue;
+        }
+        if (setId < MinDataSetId || setId == (ipfix ? IPFIXOptionsSet : V9OptionsSet))
+            continue;
+
+        auto it = m_templates.find({domain, setId});
+        if (it == m_templates.end())
+            continue;
+        const std::vector<Field>& fields = it->second;
+
+        for (;;) {
+            FlowRecord rec;
+            const uint8_t* q = p;
+            bool complete = true;
+            for (const Field& f : fields) {
+                size_t len = f.length;
+                if (len == 0xFFFF) { // IPFIX variable length
+                    if (q >= setEnd) {
+                        complete = false;
+                        break;
+                    }
+                    len = *q++;
+                    if (len == 255) {
+                        if (setEnd - q < 2) {
+                            complete = false;
+                            break;
+                        }
+                        len = Get(q, 2);
+                        q += 2;
+                    }
+                }
+                if (static_cast<size_t>(setEnd - q) < len) {
+                    complete = false;
+                    break;
+                }
+                uint64_t v = len <= 8 ? Get(q, len) : 0;
+                q += len;
+                switch (f.id) {
+                case IE_SrcIPv4:
+                    rec.key.src_ip = static_cast<uint32_t>(v);
+                    break;
+                case IE_DstIPv4:
+                    rec.key.dst_ip = static_cast<uint32_t>(v);
+                    break;
+                case IE_SrcPort:
+                    rec.key.src_port = static_cast<uint16_t>(v);
+                    break;
+                case IE_DstPort:
+                    rec.key.dst_port = static_cast<uint16_t>(v);
+                    break;
+                case IE_Protocol:
+                    rec.key.protocol = static_cast<uint8_t>(v);
+                    break;
+                case IE_TcpFlags:
+                    rec.tcp_flags = static_cast<uint8_t>(v);
+                    break;
+                case IE_PacketDelta:
+                    rec.packets = v;
+                    break;
+                case IE_OctetDelta:
+                    rec.bytes = v;
+                    break;
+                case IE_FlowStartMs:
+                    rec.first_ns = v * 1000000ull;
+                    break;
+                case IE_FlowEndMs:
+                    rec.last_ns = v * 1000000ull;
+                    break;
+                case IE_FlowStartSeconds:
+                    rec.first_ns = v * 1000000000ull;
+                    break;
+                case IE_FlowEndSeconds:
+                    rec.last_ns = v * 1000000000ull;
+                    break;
+                case IE_V9FirstSwitched:
+                    if (!ipfix)
+                        rec.first_ns = (uptimeBaseMs + v) * 1000000ull;
+                    break;
+                case IE_V9LastSwitched:
+                    if (!ipfix)
+                        rec.last_ns = (uptimeBaseMs + v) * 1000000ull;
+                    break;
+                default:
+                    break;
+                }
+            }
+            if (!complete || q == p)
+                break; // remaining bytes are set padding
+            p = q;
+            sink(rec, context);
+            ++records;
+        }
+    }
+    return records;
+}
+} // namespace libpkt::netflow
@@ -0,0 +1,315 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/output.hpp"
+#include "libpkt/layer.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace libpkt::output {
+namespace {
+// The fields JSON and CSV records share, pulled out of a decoded stack.
+struct Fields {
+    const EthernetFrame* eth = nullptr;
+    const IPv4Packet* ip = nullptr;
+    const tcp::Packet* tcp = nullptr;
+    const udp::Packet* udp = nullptr;
+    const icmp::Packet* icmp = nullptr;
+};
+
+Fields Collect(const Layer* layers, size_t count) {
+    Fields f;
+    for (size_t i = 0; i < count; ++i) {
+        if (auto* eth = std::get_if<EthernetFrame>(&layers[i]))
+            f.eth = eth;
+        else if (auto* ip = std::get_if<IPv4Packet>(&layers[i]))
+            f.ip = ip;
+        else if (auto* tcp = std::get_if<tcp::Packet>(&layers[i]))
+            f.tcp = tcp;
+        else if (auto* udp = std::get_if<udp::Packet>(&layers[i]))
+            f.udp = udp;
+        else if (auto* icmp = std::get_if<icmp::Packet>(&layers[i]))
+            f.icmp = icmp;
+    }
+    return f;
+}
+
+uint16_t SrcPort(const Fields& f) {
+    return f.tcp ? f.tcp->SrcPort() : f.udp->SrcPort();
+}
+
+uint16_t DstPort(const Fields& f) {
+    return f.tcp ? f.tcp->DstPort() : f.udp->DstPort();
+}
+
+void AppendText(TextBuffer& out, const FrameView& frame, const Layer* layers, size_t count) {
+    out.AppendTimestamp(frame.timestamp_ns).Append(' ');
+    if (count == 0)
+        out.Append("Invalid Ethernet Frame");
+    for (size_t i = 0; i < count; ++i) {
+        if (i != 0)
+            out.Append(" | ");
+        AppendSummary(out, layers[i]);
+    }
+    out.Append('\n');
+}
+
+void AppendJSON(TextBuffer& out, const FrameView& frame, const Fields& f) {
+    out.Append("{\"ts\":").AppendTimestamp(frame.timestamp_ns);
+    out.Append(",\"len\":").AppendUInt(frame.length);
+    if (f.eth) {
+        out.Append(",\"src_mac\":\"").AppendMAC(f.eth->Data() + 6);
+        out.Append("\",\"dst_mac\":\"").AppendMAC(f.eth->Data());
+        out.Append("\",\"ethertype\":").AppendUInt(f.eth->EthertypeRaw());
+    }
+    if (f.ip) {
+        out.Append(",\"src_ip\":\"").AppendIPv4(f.ip->SrcAddressRaw());
+        out.Append("\",\"dst_ip\":\"").AppendIPv4(f.ip->DstAddressRaw());
+        out.Append("\",\"proto\":").AppendUInt(f.ip->ProtocolRaw());
+        if (f.ip->FragmentOffset() != 0)
+            out.Append(",\"frag_offset\":").AppendUInt(f.ip->FragmentOffset());
+    }
+    if (f.tcp || f.udp) {
+        out.Append(",\"src_port\":").AppendUInt(SrcPort(f));
+        out.Append(",\"dst_port\":").AppendUInt(DstPort(f));
+    }
+    if (f.tcp)
+        out.Append(",\"tcp_flags\":").AppendUInt(f.tcp->Flags());
+    if (f.icmp) {
+        out.Append(",\"icmp_type\":").AppendUInt(f.icmp->Type());
+        out.Append(",\"icmp_code\":").AppendUInt(f.icmp->Code());
+    }
+    out.Append("}\n");
+}
+
+void AppendCSV(TextBuffer& out, const FrameView& frame, const Fields& f) {
+    out.AppendTimestamp(frame.timestamp_ns).Append(',').AppendUInt(frame.length).Append(',');
+    if (f.eth) {
+        out.AppendMAC(f.eth->Data() + 6).Append(',').AppendMAC(f.eth->Data()).Append(',');
+        out.AppendUInt(f.eth->EthertypeRaw());
+    } else {
+        out.Append(",,");
+    }
+    out.Append(',');
+    if (f.ip) {
+        out.AppendIPv4(f.ip->SrcAddressRaw()).Append(',').AppendIPv4(f.ip->DstAddressRaw());
+        out.Append(',').AppendUInt(f.ip->ProtocolRaw());
+    } else {
+        out.Append(",,");
+    }
+    out.Append(',');
+    if (f.tcp || f.udp)
+        out.AppendUInt(SrcPort(f)).Append(',').AppendUInt(DstPort(f));
+    else
+        out.Append(',');
+    out.Append(',');
+    if (f.tcp)
+        out.AppendUInt(f.tcp->Flags());
+    out.Append(',');
+    if (f.icmp)
+        out.AppendUInt(f.icmp->Type()).Append(',').AppendUInt(f.icmp->Code());
+    else
+        out.Append(',');
+    out.Append('\n');
+}
+} // namespace
+
+void AppendFrame(TextBuffer& out, Format format, const FrameView& frame) {
+    Layer layers[MaxLayers];
+    size_t count = DecodeLayers(frame.data, frame.length, layers);
+    switch (format) {
+    case Format::Text:
+        AppendText(out, frame, layers, count);
+        break;
+    case Format::JSON:
+        AppendJSON(out, frame, Collect(layers, count));
+        break;
+    case Format::CSV:
+        AppendCSV(out, frame, Collect(layers, count));
+        break;
+    }
+}
+
+Sink::Sink(const Config& config)
+    : m_config(config), m_fd(-1), m_owned(false), m_current(0), m_queueHead(0), m_queued(0),
+      m_writing(false), m_stop(false) {
+    if (m_config.buffer_size < 2 * MaxFrameRecord)
+        m_config.buffer_size = 2 * MaxFrameRecord;
+    if (m_config.buffers < 2)
+        m_config.buffers = 2;
+    size_t count = m_config.async ? m_config.buffers : 1;
+    m_buffers.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        m_buffers.emplace_back(m_config.buffer_size);
+    m_queue.resize(count);
+    m_free.reserve(count);
+}
+
+Sink::~Sink() {
+    Close();
+}
+
+bool Sink::Open(const std::string& path) {
+    Close();
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    Start(fd, true);
+    return true;
+}
+
+bool Sink::Attach(int fd) {
+    Close();
+    if (fd < 0)
+        return false;
+    Start(fd, false);
+    return true;
+}
+
+void Sink::Start(int fd, bool owned) {
+    m_fd = fd;
+    m_owned = owned;
+    m_stats = Stats{};
+    m_current = 0;
+    for (auto& buffer : m_buffers)
+        buffer.Clear();
+    if (m_config.async) {
+        m_free.clear();
+        for (size_t i = 1; i < m_buffers.size(); ++i)
+            m_free.push_back(i);
+        m_queueHead = 0;
+        m_queued = 0;
+        m_writing = false;
+        m_stop = false;
+        m_writer = std::thread(&Sink::WriterLoop, this);
+    }
+    if (m_config.format == Format::CSV && m_config.csv_header)
+        m_buffers[m_current].Append(CSVHeader);
+}
+
+void Sink::Close() {
+    if (m_fd < 0)
+        return;
+    Flush();
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_ready.notify_one();
+        m_writer.join();
+    }
+    if (m_owned)
+        ::close(m_fd);
+    m_fd = -1;
+}
+
+void Sink::Write(const FrameView& frame) {
+    if (m_fd < 0)
+        return;
+    Reserve(MaxFrameRecord);
+    AppendFrame(m_buffers[m_current], m_config.format, frame);
+    ++m_stats.records;
+}
+
+void Sink::WriteRaw(std::string_view record) {
+    if (m_fd < 0)
+        return;
+    Reserve(record.size());
+    m_buffers[m_current].Append(record);
+    ++m_stats.records;
+}
+
+void Sink::Reserve(size_t n) {
+    const TextBuffer& buffer = m_buffers[m_current];
+    if (buffer.Size() != 0 && buffer.Size() + n > m_config.buffer_size)
+        Submit();
+}
+
+void Sink::Submit() {
+    TextBuffer& buffer = m_buffers[m_current];
+    if (buffer.Size() == 0)
+        return;
+    if (!m_config.async) {
+        WriteAll(buffer, m_stats);
+        buffer.Clear();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue[(m_queueHead + m_queued) % m_queue.size()] = m_current;
+    ++m_queued;
+    m_ready.notify_one();
+    if (m_free.empty()) {
+        ++m_stats.stalls;
+        m_done.wait(lock, [this] { return !m_free.empty(); });
+    }
+    m_current = m_free.back();
+    m_free.pop_back();
+}
+
+bool Sink::Flush() {
+    if (m_fd < 0)
+        return false;
+    Submit();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_config.async)
+        m_done.wait(lock, [this] { return m_queued == 0 && !m_writing; });
+    return m_stats.write_errors == 0;
+}
+
+Sink::Stats Sink::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void Sink::WriteAll(const TextBuffer& buffer, Stats& stats) const {
+    const char* p = buffer.Data();
+    size_t left = buffer.Size();
+    while (left != 0) {
+        ssize_t n = ::write(m_fd, p, left);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            ++stats.write_errors;
+            return;
+        }
+        ++stats.writes;
+        stats.bytes += n;
+        p += n;
+        left -= n;
+    }
+}
+
+void Sink::WriterLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_ready.wait(lock, [this] { return m_queued != 0 || m_stop; });
+        if (m_queued == 0)
+            return;
+        size_t index = m_queue[m_queueHead];
+        m_queueHead = (m_queueHead + 1) % m_queue.size();
+        --m_queued;
+        m_writing = true;
+        lock.unlock();
+
+        Stats written;
+        WriteAll(m_buffers[index], written);
+        m_buffers[index].Clear();
+
+        lock.lock();
+        m_stats.bytes += written.bytes;
+        m_stats.writes += written.writes;
+        m_stats.write_errors += written.write_errors;
+        m_free.push_back(index);
+        m_writing = false;
+        m_done.notify_all();
+    }
+}
+
+} // namespace libpkt::output
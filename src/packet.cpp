@@ -12,7 +12,6 @@
 
 namespace libpkt {
 Packet::Packet(const uint8_t* data, size_t length) : m_data(data), m_length(length) {}
-Packet::~Packet() = default;
 
 const uint8_t* Packet::Data() const {
     return m_data;
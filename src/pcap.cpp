@@ -0,0 +1,115 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/pcap.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libpkt {
+namespace {
+constexpr size_t FileHeaderSize = 24;
+constexpr size_t RecordHeaderSize = 16;
+constexpr uint32_t MagicMicro = 0xA1B2C3D4;
+constexpr uint32_t MagicNano = 0xA1B23C4D;
+} // namespace
+
+PcapReader::~PcapReader() {
+    Close();
+}
+
+bool PcapReader::Open(const std::string& path) {
+    Close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < FileHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    m_base = static_cast<const uint8_t*>(map);
+    m_size = st.st_size;
+
+    uint32_t magic;
+    std::memcpy(&magic, m_base, sizeof(magic));
+    if (magic == MagicMicro || magic == MagicNano) {
+        m_swapped = false;
+    } else if (__builtin_bswap32(magic) == MagicMicro || __builtin_bswap32(magic) == MagicNano) {
+        m_swapped = true;
+        magic = __builtin_bswap32(magic);
+    } else {
+        Close();
+        return false;
+    }
+    m_nanosecond = magic == MagicNano;
+    m_snapLen = Read32(m_base + 16);
+    m_linkType = Read32(m_base + 20) & 0x0FFFFFFF; // upper bits carry FCS info
+    m_offset = FileHeaderSize;
+    return true;
+}
+
+void PcapReader::Close() {
+    if (m_base != nullptr) {
+        munmap(const_cast<uint8_t*>(m_base), m_size);
+        m_base = nullptr;
+    }
+    m_size = 0;
+    m_offset = 0;
+}
+
+uint32_t PcapReader::Read32(const uint8_t* p) const {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return m_swapped ? __builtin_bswap32(v) : v;
+}
+
+bool PcapReader::Next(FrameView& frame) {
+    if (m_base == nullptr || m_size - m_offset < RecordHeaderSize)
+        return false;
+
+    const uint8_t* rec = m_base + m_offset;
+    uint64_t sec = Read32(rec);
+    uint64_t frac = Read32(rec + 4);
+    uint32_t caplen = Read32(rec + 8);
+    if (caplen > m_size - m_offset - RecordHeaderSize)
+        return false;
+
+    frame.data = rec + RecordHeaderSize;
+    frame.length = caplen;
+    frame.timestamp_ns = sec * 1000000000ull + (m_nanosecond ? frac : frac * 1000);
+    m_originalLength = std::max(Read32(rec + 12), caplen);
+    m_offset += RecordHeaderSize + caplen;
+    return true;
+}
+
+size_t PcapReader::ReadBatch(std::vector<FrameView>& out, size_t max) {
+    out.clear();
+    FrameView frame;
+    while (out.size() < max && Next(frame))
+        out.push_back(frame);
+    return out.size();
+}
+
+void PcapReader::Rewind() {
+    if (m_base != nullptr)
+        m_offset = FileHeaderSize;
+}
+} // namespace libpkt
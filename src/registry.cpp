@@ -0,0 +1,203 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/registry.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <algorithm>
+
+namespace libpkt {
+namespace {
+constexpr uint32_t MaxTableBits = 17;
+constexpr uint32_t MaxDisplacementTries = 1u << 16;
+constexpr size_t KeysPerBucket = 4;
+// Slots hold index + 1 in their upper 16 bits.
+constexpr size_t MaxKeys = 0xFFFF;
+} // namespace
+
+bool PerfectHash16::Build(const std::vector<uint16_t>& keys) {
+    m_table.clear();
+    m_displacements.clear();
+    if (keys.empty())
+        return true;
+    if (keys.size() > MaxKeys)
+        return false;
+
+    size_t buckets = 1;
+    while (buckets * KeysPerBucket < keys.size())
+        buckets <<= 1;
+    uint32_t bits = 1;
+    while ((size_t{1} << bits) < keys.size() + keys.size() / 4)
+        ++bits;
+
+    // Group key indices by first-level bucket, largest buckets first.
+    std::vector<std::vector<uint32_t>> groups(buckets);
+    for (uint32_t i = 0; i < keys.size(); ++i)
+        groups[Mix(keys[i]) & (buckets - 1)].push_back(i);
+    std::vector<uint32_t> order(buckets);
+    for (uint32_t b = 0; b < buckets; ++b)
+        order[b] = b;
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return groups[a].size() > groups[b].size(); });
+
+    for (; bits <= MaxTableBits; ++bits) {
+        const uint32_t shift = 32 - bits;
+        std::vector<uint32_t> table(size_t{1} << bits, 0);
+        std::vector<uint32_t> displacements(buckets, 0);
+        std::vector<uint32_t> slots;
+        bool ok = true;
+
+        for (uint32_t b : order) {
+            const auto& group = groups[b];
+            if (group.empty())
+                break;
+            bool placed = false;
+            for (uint32_t attempt = 0; attempt < MaxDisplacementTries && !placed; ++attempt) {
+                uint32_t displacement = attempt * 0x9E3779B9u;
+                slots.clear();
+                placed = true;
+                for (uint32_t i : group) {
+                    uint32_t slot = Mix(keys[i] + displacement) >> shift;
+                    if (table[slot] != 0 ||
+                        std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        placed = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (placed) {
+                    displacements[b] = displacement;
+                    for (size_t k = 0; k < group.size(); ++k)
+                        table[slots[k]] = keys[group[k]] | (group[k] + 1) << 16;
+                }
+            }
+            if (!placed) {
+                ok = false;
+                break;
+            }
+        }
+
+        if (ok) {
+            m_table = std::move(table);
+            m_displacements = std::move(displacements);
+            m_bucketMask = static_cast<uint32_t>(buckets - 1);
+            m_shift = shift;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecoderRegistry::Upsert(std::vector<Registration>& list, uint16_t key, DecoderEntry entry) {
+    if (entry.decoder == nullptr)
+        return false;
+    for (auto& reg : list) {
+        if (reg.key == key) {
+            reg.entry = entry;
+            return true;
+        }
+    }
+    list.push_back({key, entry});
+    return true;
+}
+
+bool DecoderRegistry::RegisterEtherType(uint16_t ethertype, Decoder decoder, void* context) {
+    return Upsert(m_etherRegs, ethertype, {decoder, context});
+}
+
+bool DecoderRegistry::RegisterIPProtocol(uint8_t protocol, Decoder decoder, void* context) {
+    if (decoder == nullptr)
+        return false;
+    m_ipEntries[protocol] = {decoder, context};
+    return true;
+}
+
+bool DecoderRegistry::RegisterTCPPort(uint16_t port, Decoder decoder, void* context) {
+    return Upsert(m_tcpRegs, port, {decoder, context});
+}
+
+bool DecoderRegistry::RegisterUDPPort(uint16_t port, Decoder decoder, void* context) {
+    return Upsert(m_udpRegs, port, {decoder, context});
+}
+
+bool DecoderRegistry::Build(const std::vector<Registration>& list, PerfectHash16& hash,
+                            std::vector<DecoderEntry>& entries) {
+    std::vector<uint16_t> keys;
+    entries.clear();
+    for (const auto& reg : list) {
+        keys.push_back(reg.key);
+        entries.push_back(reg.entry);
+    }
+    return hash.Build(keys);
+}
+
+bool DecoderRegistry::Compile() {
+    return Build(m_etherRegs, m_etherHash, m_etherEntries) &&
+           Build(m_tcpRegs, m_tcpHash, m_tcpEntries) && Build(m_udpRegs, m_udpHash, m_udpEntries);
+}
+
+bool DecoderRegistry::Dispatch(const uint8_t* frame, size_t length) const {
+    EthernetFrame eth(frame, length);
+    if (!eth.IsValid())
+        return false;
+
+    if (const DecoderEntry* e = FindEtherType(eth.EthertypeRaw())) {
+        e->decoder(eth.Payload(), eth.PayloadLength(), e->context);
+        return true;
+    }
+    if (eth.EthertypeRaw() == static_cast<uint16_t>(EtherType::IPv4))
+        return DispatchIPv4(eth.Payload(), eth.PayloadLength());
+    return false;
+}
+
+bool DecoderRegistry::DispatchIPv4(const uint8_t* data, size_t length) const {
+    IPv4Packet ip(data, length);
+    if (!ip.IsValid())
+        return false;
+
+    // A port decoder is more specific than one for the whole IP protocol.
+    // Only the first fragment of a datagram has ports.
+    const uint8_t proto = ip.ProtocolRaw();
+    const DecoderEntry* e = nullptr;
+    const uint8_t* payload = ip.Payload();
+    size_t payloadLength = ip.PayloadLength();
+    const bool ports = ip.FragmentOffset() == 0;
+    if (ports && proto == static_cast<uint8_t>(Protocol::TCP)) {
+        tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+        if (tcp.IsValid()) {
+            e = FindTCPPort(tcp.DstPort());
+            if (e == nullptr)
+                e = FindTCPPort(tcp.SrcPort());
+            if (e != nullptr) {
+                payload = tcp.Payload();
+                payloadLength = tcp.PayloadLength();
+            }
+        }
+    } else if (ports && proto == static_cast<uint8_t>(Protocol::UDP)) {
+        udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        if (udp.IsValid()) {
+            e = FindUDPPort(udp.DstPort());
+            if (e == nullptr)
+                e = FindUDPPort(udp.SrcPort());
+            if (e != nullptr) {
+                payload = udp.Payload();
+                payloadLength = udp.PayloadLength();
+            }
+        }
+    }
+    if (e == nullptr)
+        e = FindIPProtocol(proto);
+    if (e == nullptr)
+        return false;
+    e->decoder(payload, payloadLength, e->context);
+    return true;
+}
+} // namespace libpkt
@@ -0,0 +1,182 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/replay.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <sched.h>
+
+namespace libpkt {
+namespace {
+uint64_t MonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+void Pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Longest single sleep, so Stop() is noticed during long gaps.
+constexpr uint64_t MaxSleepNs = 100'000'000;
+} // namespace
+
+Replayer::Replayer(Interface& iface, const Config& config)
+    : m_iface(iface), m_config(config), m_stop(false), m_loop(0), m_loopStart(true), m_index(0),
+      m_bits(0), m_prevTs(0), m_at(0) {
+    if (m_config.batch_size == 0)
+        m_config.batch_size = 1;
+    if (m_config.speed <= 0)
+        m_config.speed = 1.0;
+    m_batch.reserve(m_config.batch_size);
+    m_deadlines.reserve(m_config.batch_size);
+}
+
+bool Replayer::Next(PcapReader& reader, FrameView& frame, uint64_t& at) {
+    while (!reader.Next(frame)) {
+        // Start the next pass where this one ended; an empty file ends here.
+        if (m_loopStart || (m_config.loops != 0 && m_loop + 1 >= m_config.loops))
+            return false;
+        ++m_loop;
+        m_loopStart = true;
+        reader.Rewind();
+    }
+
+    switch (m_config.mode) {
+    case Mode::Timed:
+        if (!m_loopStart) {
+            uint64_t gap = frame.timestamp_ns > m_prevTs ? frame.timestamp_ns - m_prevTs : 0;
+            if (m_config.max_gap_ns != 0 && gap > m_config.max_gap_ns)
+                gap = m_config.max_gap_ns;
+            m_at += static_cast<uint64_t>(gap / m_config.speed);
+        }
+        break;
+    case Mode::PacketRate:
+        // From the frame number rather than summed gaps, so rounding does not drift.
+        m_at = static_cast<uint64_t>(m_index * 1e9 / m_config.packet_rate);
+        break;
+    case Mode::BitRate:
+        m_at = static_cast<uint64_t>(m_bits * 1e9 / m_config.bit_rate);
+        break;
+    case Mode::TopSpeed:
+        break;
+    }
+    m_loopStart = false;
+    m_prevTs = frame.timestamp_ns;
+    ++m_index;
+    m_bits += frame.length * 8;
+    at = m_at;
+    return true;
+}
+
+void Replayer::WaitUntil(uint64_t deadline) {
+    for (;;) {
+        uint64_t now = MonotonicNs();
+        if (now >= deadline || m_stop.load(std::memory_order_relaxed))
+            return;
+        uint64_t remaining = deadline - now;
+        if (remaining <= m_config.spin_ns) {
+            Pause();
+            continue;
+        }
+        // Absolute sleeps, so an early wake-up or EINTR just goes round again.
+        uint64_t wake = now + std::min(remaining - m_config.spin_ns, MaxSleepNs);
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(wake / 1000000000ull);
+        ts.tv_nsec = static_cast<long>(wake % 1000000000ull);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    }
+}
+
+bool Replayer::Transmit(uint64_t start) {
+    std::span<const FrameView> frames(m_batch);
+    size_t done = 0;
+    while (done < frames.size()) {
+        const uint64_t now = MonotonicNs();
+        ssize_t n = m_iface.SendBatch(frames.subspan(done));
+        ++m_stats.send_calls;
+        if (n > 0) {
+            for (size_t i = done; i < done + static_cast<size_t>(n); ++i) {
+                const uint64_t deadline = start + m_deadlines[i];
+                if (m_config.mode != Mode::TopSpeed)
+                    m_timingError.Record(now > deadline ? now - deadline : deadline - now);
+                m_stats.bytes += frames[i].length;
+            }
+            m_stats.packets += static_cast<uint64_t>(n);
+            m_stats.elapsed_ns = now - start;
+            done += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0 || errno == ENOBUFS || errno == EAGAIN || errno == EINTR) {
+            // Device queue full: the frame was dropped, so offer it again.
+            if (m_stop.load(std::memory_order_relaxed))
+                return true;
+            ++m_stats.retries;
+            sched_yield();
+            continue;
+        }
+        if (errno == EMSGSIZE || errno == EINVAL) {
+            ++m_stats.errors;
+            ++done;
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Replayer::Run(PcapReader& reader) {
+    m_stats = {};
+    m_timingError.Reset();
+    m_stop.store(false, std::memory_order_relaxed);
+    m_loop = 0;
+    m_loopStart = true;
+    m_index = 0;
+    m_bits = 0;
+    m_prevTs = 0;
+    m_at = 0;
+    if (!reader.IsOpen() || reader.LinkType() != PcapReader::LinkTypeEthernet ||
+        (m_config.mode == Mode::PacketRate && m_config.packet_rate <= 0) ||
+        (m_config.mode == Mode::BitRate && m_config.bit_rate <= 0))
+        return false;
+    reader.Rewind();
+
+    FrameView frame;
+    uint64_t at = 0;
+    bool more = Next(reader, frame, at);
+    const uint64_t start = MonotonicNs();
+    while (more && !m_stop.load(std::memory_order_relaxed)) {
+        WaitUntil(start + at);
+        // Everything due by the end of the window goes in this batch.
+        const uint64_t horizon = MonotonicNs() - start + m_config.batch_window_ns;
+        m_batch.clear();
+        m_deadlines.clear();
+        do {
+            m_batch.push_back(frame);
+            m_deadlines.push_back(at);
+            m_stats.schedule_ns = at;
+            more = Next(reader, frame, at);
+        } while (more && m_batch.size() < m_config.batch_size && at <= horizon);
+        if (!Transmit(start))
+            return false;
+    }
+    return true;
+}
+
+bool Replayer::Run(const std::string& path) {
+    PcapReader reader;
+    if (!reader.Open(path))
+        return false;
+    return Run(reader);
+}
+
+} // namespace libpkt
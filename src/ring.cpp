@@ -0,0 +1,588 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/ring.hpp"
+
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/magic.h>
+#include <new>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+namespace libpkt::ring {
+namespace detail {
+constexpr uint64_t Magic = 0x314d48534b50544cull; // "LPKTSHM1"
+constexpr uint32_t Version = 1;
+
+// Producer-written fields share no cache line with consumer-written ones.
+struct alignas(64) Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t policy;
+    uint64_t size; // frame area, a power of two
+    uint64_t data_offset;
+    uint32_t max_consumers;
+    std::atomic<uint32_t> closed;
+
+    alignas(64) std::atomic<uint64_t> head;    // end of the published records
+    std::atomic<uint64_t> reserve;             // end of the records being written
+    std::atomic<uint64_t> head_seq;            // sequence number of the record at head
+    std::atomic<uint32_t> generation;          // odd while head and head_seq change
+    alignas(64) std::atomic<uint32_t> notify;  // futex word, bumped to wake waiters
+    std::atomic<uint32_t> waiters;
+};
+
+enum SlotState : uint32_t { Free, Claimed, Active };
+
+struct alignas(64) Slot {
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> pid;
+    std::atomic<uint64_t> cursor; // everything before it has been released
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> overruns;
+    std::atomic<uint64_t> lost;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs lock-free 64-bit atomics");
+} // namespace detail
+
+namespace {
+using detail::Header;
+using detail::Slot;
+
+struct RecordHeader {
+    uint32_t length; // PaddingMark for the filler before a wrap
+    uint32_t size;   // whole record, header included, 8-byte aligned
+    uint64_t timestamp_ns;
+    uint64_t seq;
+};
+
+constexpr uint32_t PaddingMark = UINT32_MAX;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t MonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+void Pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+uint32_t* FutexWord(std::atomic<uint32_t>& word) {
+    return reinterpret_cast<uint32_t*>(&word);
+}
+
+// Each consumer holds an open-file-description lock on the byte of the ring
+// file matching its slot; the kernel drops it when the process exits, so a
+// free lock on an active slot means its consumer is gone.
+struct flock SlotLock(short type, uint32_t slot) {
+    struct flock lock{};
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = slot;
+    lock.l_len = 1;
+    return lock;
+}
+
+// Whether the consumer in an active slot still holds its lock.
+bool SlotAlive(int fd, uint32_t slot) {
+    struct flock lock = SlotLock(F_WRLCK, slot);
+    return fcntl(fd, F_OFD_GETLK, &lock) < 0 || lock.l_type != F_UNLCK;
+}
+
+// Free the slots of consumers whose process exited without detaching;
+// returns how many. An active slot's consumer holds its lock, so taking the
+// lock proves it gone, and holding it while the slot is freed keeps a new
+// consumer from claiming the slot halfway through. Works from any process
+// that has the ring open.
+uint32_t ReapSlots(int fd, Slot* slots, uint32_t count) {
+    uint32_t reaped = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (slots[i].state.load(std::memory_order_acquire) != detail::Active)
+            continue;
+        struct flock lock = SlotLock(F_WRLCK, i);
+        if (fcntl(fd, F_OFD_SETLK, &lock) < 0)
+            continue;
+        uint32_t expected = detail::Active;
+        if (slots[i].state.compare_exchange_strong(expected, detail::Free))
+            ++reaped;
+        lock = SlotLock(F_UNLCK, i);
+        fcntl(fd, F_OFD_SETLK, &lock);
+    }
+    return reaped;
+}
+
+// Header and cursor slots, page aligned so the frame area starts on a page.
+size_t ControlSize(uint32_t maxConsumers) {
+    return AlignUp(sizeof(Header) + maxConsumers * sizeof(Slot), 4096);
+}
+} // namespace
+
+Producer::Producer(const Config& config)
+    : m_config(config), m_unlink(false), m_hugePages(false), m_fd(-1), m_map(nullptr),
+      m_mapSize(0), m_header(nullptr), m_slots(nullptr), m_data(nullptr), m_mask(0), m_head(0),
+      m_limit(0), m_seq(0), m_publishes(0), m_lastReapNs(0) {
+    size_t size = 1 << 16;
+    while (size < m_config.size)
+        size <<= 1;
+    m_config.size = size;
+    if (m_config.max_consumers == 0)
+        m_config.max_consumers = 1;
+}
+
+Producer::~Producer() {
+    Close();
+}
+
+bool Producer::Create(const std::string& path) {
+    Close();
+    if (path.empty()) {
+        if (m_config.huge_pages) {
+            m_fd = memfd_create("libpkt-ring", MFD_CLOEXEC | MFD_HUGETLB);
+            // Without reserved huge pages the mapping fails; use normal pages.
+            if (m_fd >= 0 && !Map()) {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+        }
+        if (m_fd < 0) {
+            m_fd = memfd_create("libpkt-ring", MFD_CLOEXEC);
+            if (m_fd < 0 || !Map()) {
+                Close();
+                return false;
+            }
+        }
+        m_path = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(m_fd);
+        return true;
+    }
+
+    ::unlink(path.c_str());
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (m_fd < 0)
+        return false;
+    m_path = path;
+    m_unlink = true;
+    if (!Map()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool Producer::Map() {
+    const size_t control = ControlSize(m_config.max_consumers);
+    m_mapSize = control + m_config.size;
+    // hugetlbfs (a MFD_HUGETLB memfd or a file on a hugetlbfs mount) only
+    // takes whole huge pages.
+    struct statfs fs;
+    m_hugePages = fstatfs(m_fd, &fs) == 0 && fs.f_type == HUGETLBFS_MAGIC;
+    if (m_hugePages)
+        m_mapSize = AlignUp(m_mapSize, static_cast<uint64_t>(fs.f_bsize));
+    if (ftruncate(m_fd, static_cast<off_t>(m_mapSize)) < 0)
+        return false;
+    void* map =
+        mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, 0);
+    if (map == MAP_FAILED)
+        return false;
+
+    m_map = map;
+    auto* base = static_cast<uint8_t*>(m_map);
+    m_header = new (base) Header();
+    m_header->magic = detail::Magic;
+    m_header->version = detail::Version;
+    m_header->policy = static_cast<uint32_t>(m_config.policy);
+    m_header->size = m_config.size;
+    m_header->data_offset = control;
+    m_header->max_consumers = m_config.max_consumers;
+    m_slots = new (base + sizeof(Header)) Slot[m_config.max_consumers]();
+    m_data = base + control;
+    m_mask = m_config.size - 1;
+    m_head = 0;
+    m_limit = 0;
+    m_seq = 0;
+    m_stats = {};
+    return true;
+}
+
+void Producer::Close() {
+    if (m_header != nullptr) {
+        Publish();
+        m_header->closed.store(1, std::memory_order_seq_cst);
+        m_header->notify.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, FutexWord(m_header->notify), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+    if (m_map != nullptr)
+        munmap(m_map, m_mapSize);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    if (m_unlink)
+        ::unlink(m_path.c_str());
+    m_map = nullptr;
+    m_header = nullptr;
+    m_slots = nullptr;
+    m_data = nullptr;
+    m_fd = -1;
+    m_unlink = false;
+    m_hugePages = false;
+    m_path.clear();
+}
+
+bool Producer::Write(const FrameView& frame) {
+    bool ok = Append(frame);
+    Publish();
+    return ok;
+}
+
+bool Producer::Write(std::span<const FrameView> frames) {
+    bool ok = true;
+    for (const FrameView& frame : frames)
+        ok &= Append(frame);
+    Publish();
+    return ok;
+}
+
+bool Producer::Append(const FrameView& frame) {
+    if (m_header == nullptr)
+        return false;
+    const uint64_t need = AlignUp(sizeof(RecordHeader) + frame.length, 8);
+    if (need > m_config.size / 4) {
+        ++m_stats.oversize;
+        return false;
+    }
+    const uint64_t offset = m_head & m_mask;
+    const uint64_t room = m_config.size - offset;
+    const uint64_t pad = need > room ? room : 0;
+    const uint64_t end = m_head + pad + need;
+    if (m_config.policy == Policy::Backpressure && end - m_limit > m_config.size)
+        WaitForSpace(end);
+
+    // Announce the bytes about to be overwritten before touching them, so a
+    // consumer that read them can tell it was lapped.
+    m_header->reserve.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // A tail too short for a header is skipped implicitly.
+    if (pad >= sizeof(RecordHeader)) {
+        RecordHeader filler{PaddingMark, static_cast<uint32_t>(pad), 0, 0};
+        std::memcpy(m_data + offset, &filler, sizeof(filler));
+    }
+    uint8_t* record = m_data + ((m_head + pad) & m_mask);
+    RecordHeader header{static_cast<uint32_t>(frame.length), static_cast<uint32_t>(need),
+                        frame.timestamp_ns, m_seq++};
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), frame.data, frame.length);
+    m_head = end;
+    ++m_stats.frames;
+    m_stats.bytes += frame.length;
+    return true;
+}
+
+void Producer::Publish() {
+    if (m_header == nullptr || m_header->head.load(std::memory_order_relaxed) == m_head)
+        return;
+    // head and head_seq change together under a sequence lock. The head
+    // store is sequentially consistent with Consumer::Wait(): either the
+    // waiter sees the new head or we see the waiter.
+    uint32_t generation = m_header->generation.load(std::memory_order_relaxed);
+    m_header->generation.store(generation + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->head_seq.store(m_seq, std::memory_order_relaxed);
+    m_header->head.store(m_head, std::memory_order_seq_cst);
+    m_header->generation.store(generation + 2, std::memory_order_release);
+    if (m_header->waiters.load(std::memory_order_seq_cst) != 0) {
+        m_header->notify.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, FutexWord(m_header->notify), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+    // Under either policy, now and then free the slots of consumers that
+    // exited without detaching; the clock is read once per 1024 publishes.
+    if ((++m_publishes & 1023) == 0 && MonotonicNs() - m_lastReapNs >= 100'000'000)
+        Reap();
+}
+
+// Lowest cursor the producer must not lap. Cursors only move forward, so
+// the result stays a safe bound until the next call.
+uint64_t Producer::MinCursor() const {
+    uint64_t limit = m_header->head.load(std::memory_order_seq_cst);
+    for (uint32_t i = 0; i < m_config.max_consumers; ++i) {
+        if (m_slots[i].state.load(std::memory_order_seq_cst) != detail::Active)
+            continue;
+        uint64_t cursor = m_slots[i].cursor.load(std::memory_order_seq_cst);
+        // A cursor a whole ring behind belongs to a consumer still attaching.
+        if (cursor + m_config.size >= m_head && cursor < limit)
+            limit = cursor;
+    }
+    return limit;
+}
+
+void Producer::WaitForSpace(uint64_t end) {
+    m_limit = MinCursor();
+    if (end - m_limit <= m_config.size)
+        return;
+
+    ++m_stats.waits;
+    // Consumers can only free space by reading what is already written.
+    Publish();
+    uint64_t lastReap = MonotonicNs();
+    for (unsigned spins = 0; end - (m_limit = MinCursor()) > m_config.size; ++spins) {
+        if (spins < 256) {
+            Pause();
+            continue;
+        }
+        sched_yield();
+        if ((spins & 255) == 0) {
+            uint64_t now = MonotonicNs();
+            if (now - lastReap >= 1'000'000) {
+                Reap();
+                lastReap = now;
+            }
+        }
+    }
+}
+
+void Producer::Reap() {
+    m_stats.reaped += ReapSlots(m_fd, m_slots, m_config.max_consumers);
+    m_lastReapNs = MonotonicNs();
+}
+
+std::vector<ConsumerStatus> Producer::Consumers() const {
+    std::vector<ConsumerStatus> out;
+    if (m_header == nullptr)
+        return out;
+    const uint64_t head = m_header->head.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < m_config.max_consumers; ++i) {
+        const Slot& slot = m_slots[i];
+        if (slot.state.load(std::memory_order_acquire) != detail::Active || !SlotAlive(m_fd, i))
+            continue;
+        uint64_t cursor = slot.cursor.load(std::memory_order_acquire);
+        out.push_back({slot.pid.load(std::memory_order_relaxed), head > cursor ? head - cursor : 0,
+                       slot.frames.load(std::memory_order_relaxed),
+                       slot.overruns.load(std::memory_order_relaxed),
+                       slot.lost.load(std::memory_order_relaxed)});
+    }
+    return out;
+}
+
+Consumer::Consumer()
+    : m_fd(-1), m_map(nullptr), m_mapSize(0), m_header(nullptr), m_slot(nullptr), m_data(nullptr),
+      m_size(0), m_pos(0), m_first(0), m_expected(0) {}
+
+Consumer::~Consumer() {
+    Detach();
+}
+
+bool Consumer::Attach(const std::string& path) {
+    Detach();
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_mapSize = static_cast<size_t>(st.st_size);
+    m_map = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        Detach();
+        return false;
+    }
+
+    auto* base = static_cast<uint8_t*>(m_map);
+    auto* header = reinterpret_cast<Header*>(base);
+    if (header->magic != detail::Magic || header->version != detail::Version ||
+        header->data_offset + header->size > m_mapSize ||
+        sizeof(Header) + header->max_consumers * sizeof(Slot) > header->data_offset) {
+        Detach();
+        return false;
+    }
+    auto* slots = reinterpret_cast<Slot*>(base + sizeof(Header));
+    for (int pass = 0; pass < 2 && m_slot == nullptr; ++pass) {
+        // All taken: free the slots of consumers that died attached and retry.
+        if (pass == 1 && ReapSlots(m_fd, slots, header->max_consumers) == 0)
+            break;
+        for (uint32_t i = 0; i < header->max_consumers && m_slot == nullptr; ++i) {
+            uint32_t expected = detail::Free;
+            if (!slots[i].state.compare_exchange_strong(expected, detail::Claimed))
+                continue;
+            struct flock lock = SlotLock(F_WRLCK, i);
+            if (fcntl(m_fd, F_OFD_SETLK, &lock) == 0) {
+                m_slot = &slots[i];
+            } else {
+                slots[i].state.store(detail::Free, std::memory_order_release);
+            }
+        }
+    }
+    if (m_slot == nullptr) {
+        Detach();
+        return false;
+    }
+
+    m_header = header;
+    m_data = base + header->data_offset;
+    m_size = header->size;
+    m_slot->pid.store(getpid(), std::memory_order_relaxed);
+    m_slot->frames.store(0, std::memory_order_relaxed);
+    m_slot->overruns.store(0, std::memory_order_relaxed);
+    m_slot->lost.store(0, std::memory_order_relaxed);
+    // Once active, the producer honours our cursor; start from the head as
+    // it stands after that point, as anything older may already be gone.
+    m_slot->cursor.store(header->head.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    m_slot->state.store(detail::Active, std::memory_order_seq_cst);
+    Head(m_pos, m_expected);
+    m_slot->cursor.store(m_pos, std::memory_order_seq_cst);
+    m_first = m_pos;
+    m_stats = {};
+    return true;
+}
+
+void Consumer::Detach() {
+    if (m_slot != nullptr)
+        m_slot->state.store(detail::Free, std::memory_order_release);
+    if (m_map != nullptr)
+        munmap(m_map, m_mapSize);
+    if (m_fd >= 0)
+        ::close(m_fd); // releases the slot lock
+    m_fd = -1;
+    m_map = nullptr;
+    m_header = nullptr;
+    m_slot = nullptr;
+    m_data = nullptr;
+}
+
+void Consumer::Head(uint64_t& pos, uint64_t& seq) const {
+    for (;;) {
+        uint32_t generation = m_header->generation.load(std::memory_order_acquire);
+        if (generation & 1) {
+            Pause();
+            continue;
+        }
+        pos = m_header->head.load(std::memory_order_seq_cst);
+        seq = m_header->head_seq.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_header->generation.load(std::memory_order_relaxed) == generation)
+            return;
+    }
+}
+
+void Consumer::Release() {
+    m_slot->cursor.store(m_pos, std::memory_order_release);
+    m_slot->frames.store(m_stats.frames, std::memory_order_relaxed);
+    m_slot->overruns.store(m_stats.overruns, std::memory_order_relaxed);
+    m_slot->lost.store(m_stats.lost, std::memory_order_relaxed);
+    m_first = m_pos;
+}
+
+bool Consumer::Read(FrameView& frame, bool first) {
+    for (;;) {
+        if (m_pos == m_header->head.load(std::memory_order_acquire))
+            return false;
+        const uint64_t offset = m_pos & (m_size - 1);
+        const uint64_t room = m_size - offset;
+        if (room < sizeof(RecordHeader)) {
+            m_pos += room;
+            continue;
+        }
+        RecordHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_header->reserve.load(std::memory_order_relaxed) > m_pos + m_size) {
+            // Lapped: what we read may be torn. Resume at the newest frame.
+            uint64_t seq;
+            Head(m_pos, seq);
+            ++m_stats.overruns;
+            m_stats.lost += seq - m_expected;
+            m_expected = seq;
+            if (first)
+                m_first = m_pos;
+            continue;
+        }
+        if (header.length == PaddingMark) {
+            m_pos += room;
+            continue;
+        }
+        m_expected = header.seq + 1;
+        frame = {m_data + offset + sizeof(header), header.length, header.timestamp_ns};
+        m_pos += header.size;
+        ++m_stats.frames;
+        m_stats.bytes += header.length;
+        return true;
+    }
+}
+
+bool Consumer::Next(FrameView& frame) {
+    if (m_header == nullptr)
+        return false;
+    Release();
+    return Read(frame, true);
+}
+
+size_t Consumer::NextBatch(std::vector<FrameView>& out, size_t max) {
+    out.clear();
+    if (m_header == nullptr)
+        return 0;
+    Release();
+    FrameView frame;
+    while (out.size() < max && Read(frame, out.empty()))
+        out.push_back(frame);
+    return out.size();
+}
+
+bool Consumer::Intact() const {
+    if (m_header == nullptr)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_header->reserve.load(std::memory_order_relaxed) <= m_first + m_size;
+}
+
+bool Consumer::Wait(int timeoutMs) {
+    if (m_header == nullptr)
+        return false;
+    if (m_header->head.load(std::memory_order_acquire) != m_pos)
+        return true;
+    m_header->waiters.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t seen = m_header->notify.load(std::memory_order_seq_cst);
+    if (m_header->head.load(std::memory_order_seq_cst) == m_pos &&
+        m_header->closed.load(std::memory_order_seq_cst) == 0) {
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, FutexWord(m_header->notify), FUTEX_WAIT, seen,
+                timeoutMs < 0 ? nullptr : &timeout, nullptr, 0);
+    }
+    m_header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return m_header->head.load(std::memory_order_acquire) != m_pos;
+}
+
+bool Consumer::Finished() const {
+    return m_header == nullptr || (m_header->closed.load(std::memory_order_acquire) != 0 &&
+                                   m_header->head.load(std::memory_order_acquire) == m_pos);
+}
+
+uint64_t Consumer::Lag() const {
+    if (m_header == nullptr)
+        return 0;
+    return m_header->head.load(std::memory_order_acquire) - m_pos;
+}
+
+} // namespace libpkt::ring
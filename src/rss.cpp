@@ -0,0 +1,169 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/rss.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/simd_parse.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace libpkt::rss {
+namespace {
+// 32-bit window of the key starting at bit `bit` (MSB first).
+uint32_t KeyWindow(std::span<const uint8_t, KeySize> key, size_t bit) {
+    uint64_t chunk = 0;
+    size_t byte = bit / 8;
+    for (size_t i = 0; i < 5; ++i)
+        chunk = (chunk << 8) | (byte + i < KeySize ? key[byte + i] : 0);
+    return static_cast<uint32_t>(chunk >> (8 - bit % 8));
+}
+
+uint64_t Mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// 5-tuple of an Ethernet frame; `hasPorts` is set only for a valid TCP/UDP
+// header of an unfragmented datagram, matching what a NIC would hash: all
+// fragments of a datagram hash on addresses alone and stay together.
+bool Extract(const uint8_t* frame, size_t length, FlowKey& key, bool& hasPorts) {
+    hasPorts = false;
+    EthernetFrame eth(frame, length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    if (!ip.IsValid())
+        return false;
+
+    key = {ip.SrcAddressRaw(), ip.DstAddressRaw(), 0, 0, ip.ProtocolRaw()};
+    if (ip.IsFragment())
+        return true;
+    if (ip.GetProtocol() == Protocol::TCP) {
+        tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+        if (tcp.IsValid()) {
+            key.src_port = tcp.SrcPort();
+            key.dst_port = tcp.DstPort();
+            hasPorts = true;
+        }
+    } else if (ip.GetProtocol() == Protocol::UDP) {
+        udp::Packet udp(ip.Payload(), ip.PayloadLength());
+        if (udp.IsValid()) {
+            key.src_port = udp.SrcPort();
+            key.dst_port = udp.DstPort();
+            hasPorts = true;
+        }
+    }
+    return true;
+}
+
+template <typename HashFn>
+void ForEachLane(std::span<const FrameView> frames, uint32_t* out, HashFn hash) {
+    simd::HeaderLanes lanes;
+    for (size_t base = 0; base < frames.size(); base += simd::MaxLanes) {
+        const size_t n = std::min(simd::MaxLanes, frames.size() - base);
+        simd::ParseHeaders(frames.data() + base, n, lanes);
+        const uint32_t withPorts = lanes.tcp_valid | lanes.udp_valid;
+        for (size_t k = 0; k < n; ++k) {
+            if (!((lanes.ipv4_valid >> k) & 1)) {
+                out[base + k] = 0;
+                continue;
+            }
+            FlowKey key{lanes.src_ip[k], lanes.dst_ip[k], lanes.src_port[k], lanes.dst_port[k],
+                        lanes.protocol[k]};
+            // The lanes report ports as tcp::Packet would; fragments hash
+            // without them, as in Extract().
+            const uint8_t* ip = frames[base + k].data + EthernetFrame::HeaderSize;
+            const bool fragment = ((ip[6] & 0x3F) | ip[7]) != 0;
+            if (fragment)
+                key.src_port = key.dst_port = 0;
+            out[base + k] = hash(key, !fragment && ((withPorts >> k) & 1) != 0);
+        }
+    }
+}
+} // namespace
+
+Toeplitz::Toeplitz(std::span<const uint8_t, KeySize> key) : m_tables(MaxInput) {
+    for (size_t i = 0; i < MaxInput; ++i) {
+        uint32_t bitWindows[8];
+        for (size_t b = 0; b < 8; ++b)
+            bitWindows[b] = KeyWindow(key, i * 8 + b);
+        for (uint32_t v = 0; v < 256; ++v) {
+            uint32_t h = 0;
+            for (size_t b = 0; b < 8; ++b) {
+                if (v & (0x80u >> b))
+                    h ^= bitWindows[b];
+            }
+            m_tables[i][v] = h;
+        }
+    }
+}
+
+uint32_t Toeplitz::Hash(const uint8_t* input, size_t length) const {
+    length = std::min(length, MaxInput);
+    uint32_t h = 0;
+    for (size_t i = 0; i < length; ++i)
+        h ^= m_tables[i][input[i]];
+    return h;
+}
+
+uint32_t Toeplitz::Hash(const FlowKey& key, bool withPorts) const {
+    // Network byte order: src addr, dst addr, src port, dst port.
+    const uint8_t input[12] = {
+        static_cast<uint8_t>(key.src_ip >> 24),  static_cast<uint8_t>(key.src_ip >> 16),
+        static_cast<uint8_t>(key.src_ip >> 8),   static_cast<uint8_t>(key.src_ip),
+        static_cast<uint8_t>(key.dst_ip >> 24),  static_cast<uint8_t>(key.dst_ip >> 16),
+        static_cast<uint8_t>(key.dst_ip >> 8),   static_cast<uint8_t>(key.dst_ip),
+        static_cast<uint8_t>(key.src_port >> 8), static_cast<uint8_t>(key.src_port),
+        static_cast<uint8_t>(key.dst_port >> 8), static_cast<uint8_t>(key.dst_port),
+    };
+    return Hash(input, withPorts ? 12 : 8);
+}
+
+uint32_t SymmetricHash(const FlowKey& key) {
+    uint64_t a = (static_cast<uint64_t>(key.src_ip) << 16) | key.src_port;
+    uint64_t b = (static_cast<uint64_t>(key.dst_ip) << 16) | key.dst_port;
+    if (a > b)
+        std::swap(a, b);
+    uint64_t h = Mix64(a ^ 0x9E3779B97F4A7C15ull);
+    h = Mix64(h ^ b ^ (static_cast<uint64_t>(key.protocol) << 56));
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+uint32_t HashFrame(const Toeplitz& toeplitz, const uint8_t* frame, size_t length) {
+    FlowKey key;
+    bool hasPorts;
+    if (!Extract(frame, length, key, hasPorts))
+        return 0;
+    return toeplitz.Hash(key, hasPorts);
+}
+
+uint32_t SymmetricHashFrame(const uint8_t* frame, size_t length) {
+    FlowKey key;
+    bool hasPorts;
+    if (!Extract(frame, length, key, hasPorts))
+        return 0;
+    return SymmetricHash(key);
+}
+
+void HashBatch(const Toeplitz& toeplitz, std::span<const FrameView> frames, uint32_t* out) {
+    ForEachLane(frames, out,
+                [&](const FlowKey& key, bool withPorts) { return toeplitz.Hash(key, withPorts); });
+}
+
+void SymmetricHashBatch(std::span<const FrameView> frames, uint32_t* out) {
+    ForEachLane(frames, out, [](const FlowKey& key, bool) { return SymmetricHash(key); });
+}
+} // namespace libpkt::rss
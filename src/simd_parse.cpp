@@ -0,0 +1,315 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/simd_parse.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+#include "libpkt/tcp.hpp"
+#include "libpkt/udp.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define LIBPKT_SIMD_X86 1
+#endif
+
+namespace libpkt::simd {
+namespace {
+constexpr size_t EthHeader = EthernetFrame::HeaderSize;
+constexpr size_t MinIPv4Frame = EthHeader + IPv4Packet::MinHeaderSize;
+
+// Reference implementation built on the regular packet classes.
+void ParseScalar(const FrameView* frames, size_t count, HeaderLanes& out) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t bit = 1u << i;
+        EthernetFrame eth(frames[i].data, frames[i].length);
+        if (!eth.IsValid())
+            continue;
+        out.ethernet_valid |= bit;
+        out.ethertype[i] = eth.EthertypeRaw();
+        if (eth.Ethertype() != EtherType::IPv4)
+            continue;
+
+        IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+        if (!ip.IsValid())
+            continue;
+        out.ipv4_valid |= bit;
+        out.ihl[i] = ip.HeaderLength() / 4;
+        out.protocol[i] = ip.ProtocolRaw();
+        out.src_ip[i] = ip.SrcAddressRaw();
+        out.dst_ip[i] = ip.DstAddressRaw();
+
+        if (ip.GetProtocol() == Protocol::TCP) {
+            tcp::Packet tcp(ip.Payload(), ip.PayloadLength());
+            if (tcp.IsValid()) {
+                out.tcp_valid |= bit;
+                out.src_port[i] = tcp.SrcPort();
+                out.dst_port[i] = tcp.DstPort();
+                out.tcp_flags[i] = tcp.Flags();
+            }
+        } else if (ip.GetProtocol() == Protocol::UDP) {
+            udp::Packet udp(ip.Payload(), ip.PayloadLength());
+            if (udp.IsValid()) {
+                out.udp_valid |= bit;
+                out.src_port[i] = udp.SrcPort();
+                out.dst_port[i] = udp.DstPort();
+            }
+        }
+    }
+}
+
+#ifdef LIBPKT_SIMD_X86
+// Both kernels gather straight from the frame pointers (base address 0,
+// 64-bit pointer as index) and only load lanes whose captured length covers
+// the bytes read, so short frames never fault. Every validity check of the
+// scalar classes becomes a lane mask.
+
+__attribute__((target("avx2"))) void ParseAVX2(const FrameView* frames, size_t count,
+                                               HeaderLanes& out) {
+    const int* base = nullptr;
+    const __m128i bswap16 = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128i bswap32 = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low16 = _mm_set1_epi32(0xFFFF);
+    const __m128i nibble = _mm_set1_epi32(0xF);
+
+    for (size_t lane = 0; lane < count; lane += 4) {
+        const size_t n = std::min<size_t>(4, count - lane);
+        alignas(32) int64_t ptr[4] = {};
+        alignas(16) int32_t len[4] = {};
+        for (size_t k = 0; k < n; ++k) {
+            ptr[k] = reinterpret_cast<int64_t>(frames[lane + k].data);
+            // Clamp so that signed 32-bit compares are exact.
+            len[k] = static_cast<int32_t>(std::min<size_t>(frames[lane + k].length, 0x7FFFFFFF));
+        }
+        __m256i vptr = _mm256_load_si256(reinterpret_cast<const __m256i*>(ptr));
+        __m128i vlen = _mm_load_si128(reinterpret_cast<const __m128i*>(len));
+        __m128i active = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(n)),
+                                         _mm_setr_epi32(0, 1, 2, 3));
+
+        // Ethernet: bytes 10..13, EtherType in the upper half.
+        __m128i mEth = _mm_and_si128(active, _mm_cmpgt_epi32(vlen, _mm_set1_epi32(EthHeader - 1)));
+        __m128i g = _mm256_mask_i64gather_epi32(zero, base,
+                                                _mm256_add_epi64(vptr, _mm256_set1_epi64x(10)),
+                                                mEth, 1);
+        __m128i ethertype = _mm_and_si128(_mm_shuffle_epi8(g, bswap32), low16);
+
+        // IPv4 version/IHL/total length: bytes 14..17.
+        __m128i mIpCand = _mm_and_si128(
+            _mm_and_si128(mEth, _mm_cmpgt_epi32(vlen, _mm_set1_epi32(MinIPv4Frame - 1))),
+            _mm_cmpeq_epi32(ethertype, _mm_set1_epi32(0x0800)));
+        g = _mm256_mask_i64gather_epi32(zero, base,
+                                        _mm256_add_epi64(vptr, _mm256_set1_epi64x(EthHeader)),
+                                        mIpCand, 1);
+        __m128i version = _mm_and_si128(_mm_srli_epi32(g, 4), nibble);
+        __m128i ihl = _mm_and_si128(g, nibble);
+        __m128i hlen = _mm_slli_epi32(ihl, 2);
+        __m128i total = _mm_srli_epi32(_mm_shuffle_epi8(g, bswap16), 16);
+        __m128i ipLen = _mm_sub_epi32(vlen, _mm_set1_epi32(EthHeader));
+        __m128i mIp = _mm_and_si128(mIpCand, _mm_cmpeq_epi32(version, _mm_set1_epi32(4)));
+        mIp = _mm_and_si128(mIp, _mm_cmpgt_epi32(ihl, _mm_set1_epi32(4)));
+        mIp = _mm_andnot_si128(_mm_cmpgt_epi32(hlen, ipLen), mIp);
+
+        // Protocol (byte 23), addresses (bytes 26..33).
+        g = _mm256_mask_i64gather_epi32(zero, base,
+                                        _mm256_add_epi64(vptr, _mm256_set1_epi64x(20)), mIp, 1);
+        __m128i proto = _mm_srli_epi32(g, 24);
+        __m128i src = _mm256_mask_i64gather_epi32(
+            zero, base, _mm256_add_epi64(vptr, _mm256_set1_epi64x(26)), mIp, 1);
+        __m128i dst = _mm256_mask_i64gather_epi32(
+            zero, base, _mm256_add_epi64(vptr, _mm256_set1_epi64x(30)), mIp, 1);
+        src = _mm_shuffle_epi8(src, bswap32);
+        dst = _mm_shuffle_epi8(dst, bswap32);
+
+        // IPv4Packet::PayloadLength(): total - hlen if hlen < total <= captured.
+        __m128i payloadOk = _mm_andnot_si128(_mm_cmpgt_epi32(total, ipLen),
+                                             _mm_cmpgt_epi32(total, hlen));
+        __m128i payloadLen = _mm_and_si128(payloadOk, _mm_sub_epi32(total, hlen));
+        __m128i mTcp = _mm_and_si128(mIp, _mm_cmpeq_epi32(proto, _mm_set1_epi32(6)));
+        mTcp = _mm_and_si128(mTcp, _mm_cmpgt_epi32(payloadLen, _mm_set1_epi32(19)));
+        __m128i mUdp = _mm_and_si128(mIp, _mm_cmpeq_epi32(proto, _mm_set1_epi32(17)));
+        mUdp = _mm_and_si128(mUdp, _mm_cmpgt_epi32(payloadLen, _mm_set1_epi32(7)));
+
+        // Ports (L4 bytes 0..3) and TCP flags (L4 byte 13).
+        __m256i l4 = _mm256_add_epi64(_mm256_add_epi64(vptr, _mm256_set1_epi64x(EthHeader)),
+                                      _mm256_cvtepu32_epi64(hlen));
+        __m128i mL4 = _mm_or_si128(mTcp, mUdp);
+        g = _mm256_mask_i64gather_epi32(zero, base, l4, mL4, 1);
+        g = _mm_shuffle_epi8(g, bswap16);
+        __m128i srcPort = _mm_and_si128(g, low16);
+        __m128i dstPort = _mm_srli_epi32(g, 16);
+        g = _mm256_mask_i64gather_epi32(zero, base,
+                                        _mm256_add_epi64(l4, _mm256_set1_epi64x(12)), mTcp, 1);
+        __m128i flags = _mm_and_si128(_mm_srli_epi32(g, 8), _mm_set1_epi32(0xFF));
+
+        // Zero fields of invalid layers, then scatter lanes to the output.
+        ihl = _mm_and_si128(ihl, mIp);
+        proto = _mm_and_si128(proto, mIp);
+        ethertype = _mm_and_si128(ethertype, mEth);
+        alignas(16) uint32_t tmp[8][4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[0]), ethertype);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[1]), ihl);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[2]), proto);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[3]), src);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[4]), dst);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[5]), srcPort);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[6]), dstPort);
+        _mm_store_si128(reinterpret_cast<__m128i*>(tmp[7]), flags);
+        for (size_t k = 0; k < n; ++k) {
+            out.ethertype[lane + k] = static_cast<uint16_t>(tmp[0][k]);
+            out.ihl[lane + k] = static_cast<uint8_t>(tmp[1][k]);
+            out.protocol[lane + k] = static_cast<uint8_t>(tmp[2][k]);
+            out.src_ip[lane + k] = tmp[3][k];
+            out.dst_ip[lane + k] = tmp[4][k];
+            out.src_port[lane + k] = static_cast<uint16_t>(tmp[5][k]);
+            out.dst_port[lane + k] = static_cast<uint16_t>(tmp[6][k]);
+            out.tcp_flags[lane + k] = static_cast<uint8_t>(tmp[7][k]);
+        }
+        out.ethernet_valid |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(mEth)))
+                              << lane;
+        out.ipv4_valid |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(mIp))) << lane;
+        out.tcp_valid |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(mTcp))) << lane;
+        out.udp_valid |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(mUdp))) << lane;
+    }
+}
+
+__attribute__((target("avx512f,avx512vl,avx512bw"))) void
+ParseAVX512(const FrameView* frames, size_t count, HeaderLanes& out) {
+    const int* base = nullptr;
+    const __m256i bswap16 = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                             1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m256i bswap32 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                             3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i nibble = _mm256_set1_epi32(0xF);
+
+    for (size_t lane = 0; lane < count; lane += 8) {
+        const size_t n = std::min<size_t>(8, count - lane);
+        const __mmask8 active = static_cast<__mmask8>((1u << n) - 1);
+        alignas(64) int64_t ptr[8] = {};
+        alignas(64) uint64_t len64[8] = {};
+        for (size_t k = 0; k < n; ++k) {
+            ptr[k] = reinterpret_cast<int64_t>(frames[lane + k].data);
+            len64[k] = frames[lane + k].length;
+        }
+        __m512i vptr = _mm512_load_si512(ptr);
+        __m256i vlen = _mm512_maskz_cvtusepi64_epi32(0xFF, _mm512_load_si512(len64)); // saturating
+
+        __mmask8 mEth = _mm256_mask_cmpge_epu32_mask(active, vlen, _mm256_set1_epi32(EthHeader));
+        __m256i g = _mm512_mask_i64gather_epi32(
+            zero, mEth, _mm512_add_epi64(vptr, _mm512_set1_epi64(10)), base, 1);
+        __m256i ethertype =
+            _mm256_and_si256(_mm256_shuffle_epi8(g, bswap32), _mm256_set1_epi32(0xFFFF));
+
+        __mmask8 mIpCand =
+            _mm256_mask_cmpge_epu32_mask(mEth, vlen, _mm256_set1_epi32(MinIPv4Frame)) &
+            _mm256_cmpeq_epi32_mask(ethertype, _mm256_set1_epi32(0x0800));
+        g = _mm512_mask_i64gather_epi32(zero, mIpCand,
+                                        _mm512_add_epi64(vptr, _mm512_set1_epi64(EthHeader)), base,
+                                        1);
+        __m256i version = _mm256_and_si256(_mm256_srli_epi32(g, 4), nibble);
+        __m256i ihl = _mm256_and_si256(g, nibble);
+        __m256i hlen = _mm256_slli_epi32(ihl, 2);
+        __m256i total = _mm256_srli_epi32(_mm256_shuffle_epi8(g, bswap16), 16);
+        __m256i ipLen = _mm256_sub_epi32(vlen, _mm256_set1_epi32(EthHeader));
+        __mmask8 mIp = _mm256_mask_cmpeq_epi32_mask(mIpCand, version, _mm256_set1_epi32(4)) &
+                       _mm256_cmpge_epu32_mask(ihl, _mm256_set1_epi32(5)) &
+                       _mm256_cmple_epu32_mask(hlen, ipLen);
+
+        g = _mm512_mask_i64gather_epi32(zero, mIp, _mm512_add_epi64(vptr, _mm512_set1_epi64(20)),
+                                        base, 1);
+        __m256i proto = _mm256_srli_epi32(g, 24);
+        __m256i src = _mm512_mask_i64gather_epi32(
+            zero, mIp, _mm512_add_epi64(vptr, _mm512_set1_epi64(26)), base, 1);
+        __m256i dst = _mm512_mask_i64gather_epi32(
+            zero, mIp, _mm512_add_epi64(vptr, _mm512_set1_epi64(30)), base, 1);
+        src = _mm256_shuffle_epi8(src, bswap32);
+        dst = _mm256_shuffle_epi8(dst, bswap32);
+
+        __mmask8 payloadOk =
+            _mm256_cmpgt_epu32_mask(total, hlen) & _mm256_cmple_epu32_mask(total, ipLen);
+        __m256i payloadLen = _mm256_maskz_sub_epi32(payloadOk, total, hlen);
+        __mmask8 mTcp = _mm256_mask_cmpeq_epi32_mask(mIp, proto, _mm256_set1_epi32(6)) &
+                        _mm256_cmpge_epu32_mask(payloadLen, _mm256_set1_epi32(20));
+        __mmask8 mUdp = _mm256_mask_cmpeq_epi32_mask(mIp, proto, _mm256_set1_epi32(17)) &
+                        _mm256_cmpge_epu32_mask(payloadLen, _mm256_set1_epi32(8));
+
+        __m512i l4 = _mm512_add_epi64(_mm512_add_epi64(vptr, _mm512_set1_epi64(EthHeader)),
+                                      _mm512_maskz_cvtepu32_epi64(0xFF, hlen));
+        g = _mm512_mask_i64gather_epi32(zero, mTcp | mUdp, l4, base, 1);
+        g = _mm256_shuffle_epi8(g, bswap16);
+        __m256i srcPort = _mm256_and_si256(g, _mm256_set1_epi32(0xFFFF));
+        __m256i dstPort = _mm256_srli_epi32(g, 16);
+        g = _mm512_mask_i64gather_epi32(zero, mTcp, _mm512_add_epi64(l4, _mm512_set1_epi64(12)),
+                                        base, 1);
+        __m256i flags = _mm256_and_si256(_mm256_srli_epi32(g, 8), _mm256_set1_epi32(0xFF));
+
+        ihl = _mm256_maskz_mov_epi32(mIp, ihl);
+        proto = _mm256_maskz_mov_epi32(mIp, proto);
+        ethertype = _mm256_maskz_mov_epi32(mEth, ethertype);
+
+        // Narrow lanes and store straight into the output arrays; the masked
+        // stores leave lanes past `count` untouched.
+        const __mmask8 store = active;
+        _mm256_mask_storeu_epi32(out.src_ip + lane, store, src);
+        _mm256_mask_storeu_epi32(out.dst_ip + lane, store, dst);
+        _mm256_mask_cvtepi32_storeu_epi16(out.ethertype + lane, store, ethertype);
+        _mm256_mask_cvtepi32_storeu_epi16(out.src_port + lane, store, srcPort);
+        _mm256_mask_cvtepi32_storeu_epi16(out.dst_port + lane, store, dstPort);
+        _mm256_mask_cvtepi32_storeu_epi8(out.ihl + lane, store, ihl);
+        _mm256_mask_cvtepi32_storeu_epi8(out.protocol + lane, store, proto);
+        _mm256_mask_cvtepi32_storeu_epi8(out.tcp_flags + lane, store, flags);
+
+        out.ethernet_valid |= static_cast<uint32_t>(mEth) << lane;
+        out.ipv4_valid |= static_cast<uint32_t>(mIp) << lane;
+        out.tcp_valid |= static_cast<uint32_t>(mTcp) << lane;
+        out.udp_valid |= static_cast<uint32_t>(mUdp) << lane;
+    }
+}
+#endif
+
+using Kernel = void (*)(const FrameView*, size_t, HeaderLanes&);
+
+Kernel KernelFor(Level level) {
+#ifdef LIBPKT_SIMD_X86
+    if (level == Level::AVX512)
+        return ParseAVX512;
+    if (level == Level::AVX2)
+        return ParseAVX2;
+#endif
+    (void) level;
+    return ParseScalar;
+}
+} // namespace
+
+Level DetectLevel() {
+#ifdef LIBPKT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx512bw"))
+        return Level::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+#endif
+    return Level::Scalar;
+}
+
+void ParseHeaders(Level level, const FrameView* frames, size_t count, HeaderLanes& out) {
+    std::memset(&out, 0, sizeof(out));
+    count = std::min(count, MaxLanes);
+    KernelFor(std::min(level, DetectLevel()))(frames, count, out);
+}
+
+void ParseHeaders(const FrameView* frames, size_t count, HeaderLanes& out) {
+    static const Kernel kernel = KernelFor(DetectLevel());
+    std::memset(&out, 0, sizeof(out));
+    kernel(frames, std::min(count, MaxLanes), out);
+}
+} // namespace libpkt::simd
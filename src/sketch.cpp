@@ -0,0 +1,362 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/sketch.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace libpkt::sketch {
+namespace {
+// Map a 32-bit hash onto [0, n) without a division.
+size_t Reduce(uint32_t h, size_t n) {
+    return static_cast<size_t>((static_cast<uint64_t>(h) * n) >> 32);
+}
+} // namespace
+
+FlowKey Project(const FlowKey& key, uint8_t fields) {
+    FlowKey out;
+    if (fields & SrcIP)
+        out.src_ip = key.src_ip;
+    if (fields & DstIP)
+        out.dst_ip = key.dst_ip;
+    if (fields & SrcPort)
+        out.src_port = key.src_port;
+    if (fields & DstPort)
+        out.dst_port = key.dst_port;
+    if (fields & Proto)
+        out.protocol = key.protocol;
+    return out;
+}
+
+uint64_t HashKey(const FlowKey& key) {
+    return HashFlowKey(key);
+}
+
+// ---------------------------------------------------------------------------
+// CountMin
+
+CountMin::CountMin(size_t width, size_t depth)
+    : m_width(std::max<size_t>(width, 1)), m_depth(std::max<size_t>(depth, 1)), m_total(0),
+      m_counters(m_width * m_depth, 0) {}
+
+void CountMin::Add(uint64_t hash, uint64_t count) {
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    for (size_t row = 0; row < m_depth; ++row)
+        m_counters[row * m_width + Reduce(h1 + static_cast<uint32_t>(row) * h2, m_width)] += count;
+    m_total += count;
+}
+
+uint64_t CountMin::Estimate(uint64_t hash) const {
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    uint64_t best = UINT64_MAX;
+    for (size_t row = 0; row < m_depth; ++row)
+        best = std::min(best, m_counters[row * m_width +
+                                         Reduce(h1 + static_cast<uint32_t>(row) * h2, m_width)]);
+    return best;
+}
+
+bool CountMin::Merge(const CountMin& other) {
+    if (other.m_width != m_width || other.m_depth != m_depth)
+        return false;
+    for (size_t i = 0; i < m_counters.size(); ++i)
+        m_counters[i] += other.m_counters[i];
+    m_total += other.m_total;
+    return true;
+}
+
+void CountMin::Reset() {
+    std::fill(m_counters.begin(), m_counters.end(), 0);
+    m_total = 0;
+}
+
+// ---------------------------------------------------------------------------
+// SpaceSaving
+
+SpaceSaving::SpaceSaving(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {
+    size_t indexSize = 1;
+    while (indexSize < m_capacity * 2)
+        indexSize <<= 1;
+    m_indexMask = indexSize - 1;
+    m_keys.reserve(m_capacity);
+    m_hashes.reserve(m_capacity);
+    m_errors.reserve(m_capacity);
+    m_heap.reserve(m_capacity);
+    m_heapPos.reserve(m_capacity);
+    m_index.assign(indexSize, 0);
+}
+
+size_t SpaceSaving::FindSlot(const FlowKey& key, uint64_t hash) const {
+    for (size_t slot = hash & m_indexMask;; slot = (slot + 1) & m_indexMask) {
+        uint32_t e = m_index[slot];
+        if (e == 0)
+            return SIZE_MAX;
+        if (m_hashes[e - 1] == hash && m_keys[e - 1] == key)
+            return slot;
+    }
+}
+
+void SpaceSaving::InsertSlot(uint64_t hash, uint32_t entry) {
+    size_t slot = hash & m_indexMask;
+    while (m_index[slot] != 0)
+        slot = (slot + 1) & m_indexMask;
+    m_index[slot] = entry + 1;
+}
+
+// Linear-probing removal with backward shift, so no tombstones accumulate.
+void SpaceSaving::EraseSlot(size_t slot) {
+    size_t hole = slot;
+    size_t next = slot;
+    for (;;) {
+        m_index[hole] = 0;
+        for (;;) {
+            next = (next + 1) & m_indexMask;
+            if (m_index[next] == 0)
+                return;
+            size_t home = m_hashes[m_index[next] - 1] & m_indexMask;
+            bool between = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!between)
+                break;
+        }
+        m_index[hole] = m_index[next];
+        hole = next;
+    }
+}
+
+void SpaceSaving::Place(size_t pos, HeapNode node) {
+    m_heap[pos] = node;
+    m_heapPos[node.entry] = static_cast<uint32_t>(pos);
+}
+
+void SpaceSaving::SiftDown(size_t pos) {
+    const size_t n = m_heap.size();
+    const HeapNode node = m_heap[pos];
+    for (;;) {
+        size_t child = pos * 2 + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && m_heap[child + 1].count < m_heap[child].count)
+            ++child;
+        if (m_heap[child].count >= node.count)
+            break;
+        Place(pos, m_heap[child]);
+        pos = child;
+    }
+    Place(pos, node);
+}
+
+void SpaceSaving::Add(const FlowKey& key, uint64_t hash, uint64_t count) {
+    size_t slot = FindSlot(key, hash);
+    if (slot != SIZE_MAX) {
+        uint32_t pos = m_heapPos[m_index[slot] - 1];
+        m_heap[pos].count += count;
+        SiftDown(pos);
+        return;
+    }
+
+    if (m_keys.size() < m_capacity) {
+        uint32_t e = static_cast<uint32_t>(m_keys.size());
+        m_keys.push_back(key);
+        m_hashes.push_back(hash);
+        m_errors.push_back(0);
+        m_heapPos.push_back(0);
+        m_heap.push_back({count, e});
+        // Sift up.
+        size_t pos = m_heap.size() - 1;
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (m_heap[parent].count <= count)
+                break;
+            Place(pos, m_heap[parent]);
+            pos = parent;
+        }
+        Place(pos, {count, e});
+        InsertSlot(hash, e);
+        return;
+    }
+
+    // Evict the minimum and inherit its count as the new key's error bound.
+    HeapNode& min = m_heap[0];
+    uint32_t e = min.entry;
+    EraseSlot(FindSlot(m_keys[e], m_hashes[e]));
+    m_keys[e] = key;
+    m_hashes[e] = hash;
+    m_errors[e] = min.count;
+    min.count += count;
+    InsertSlot(hash, e);
+    SiftDown(0);
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::Top() const {
+    std::vector<Entry> top;
+    top.reserve(m_heap.size());
+    for (const HeapNode& node : m_heap)
+        top.push_back({m_keys[node.entry], node.count, m_errors[node.entry]});
+    std::sort(top.begin(), top.end(),
+              [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    return top;
+}
+
+void SpaceSaving::Merge(const SpaceSaving& other) {
+    // A key missing from a full summary may still have occurred up to that
+    // summary's minimum count.
+    auto minOf = [](const SpaceSaving& s) {
+        return s.m_keys.size() < s.m_capacity ? 0 : s.m_heap[0].count;
+    };
+    const uint64_t minThis = minOf(*this);
+    const uint64_t minOther = minOf(other);
+
+    struct Merged {
+        Entry entry;
+        uint64_t hash;
+    };
+    std::vector<Merged> combined;
+    std::vector<bool> matched(m_keys.size(), false);
+    for (const HeapNode& node : other.m_heap) {
+        Merged m{{other.m_keys[node.entry], node.count, other.m_errors[node.entry]},
+                 other.m_hashes[node.entry]};
+        size_t slot = FindSlot(m.entry.key, m.hash);
+        if (slot != SIZE_MAX) {
+            uint32_t mine = m_index[slot] - 1;
+            matched[mine] = true;
+            m.entry.count += m_heap[m_heapPos[mine]].count;
+            m.entry.error += m_errors[mine];
+        } else {
+            m.entry.count += minThis;
+            m.entry.error += minThis;
+        }
+        combined.push_back(m);
+    }
+    for (const HeapNode& node : m_heap) {
+        if (matched[node.entry])
+            continue;
+        combined.push_back({{m_keys[node.entry], node.count + minOther,
+                             m_errors[node.entry] + minOther},
+                            m_hashes[node.entry]});
+    }
+
+    std::sort(combined.begin(), combined.end(),
+              [](const Merged& a, const Merged& b) { return a.entry.count > b.entry.count; });
+
+    Reset();
+    for (size_t i = 0; i < combined.size() && i < m_capacity; ++i) {
+        Add(combined[i].entry.key, combined[i].hash, combined[i].entry.count);
+        m_errors.back() = combined[i].entry.error;
+    }
+}
+
+void SpaceSaving::Reset() {
+    m_keys.clear();
+    m_hashes.clear();
+    m_errors.clear();
+    m_heap.clear();
+    m_heapPos.clear();
+    std::fill(m_index.begin(), m_index.end(), 0);
+}
+
+// ---------------------------------------------------------------------------
+// HyperLogLog
+
+HyperLogLog::HyperLogLog(uint8_t precision)
+    : m_precision(std::clamp<uint8_t>(precision, 4, 18)), m_registers(size_t{1} << m_precision, 0) {
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+    size_t index = hash >> (64 - m_precision);
+    uint64_t rest = (hash << m_precision) | (uint64_t{1} << (m_precision - 1)); // bounds the rank
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > m_registers[index])
+        m_registers[index] = rank;
+}
+
+double HyperLogLog::Estimate() const {
+    const double m = static_cast<double>(m_registers.size());
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t r : m_registers) {
+        sum += std::ldexp(1.0, -r);
+        zeros += r == 0;
+    }
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros != 0)
+        estimate = m * std::log(m / zeros); // linear counting for small sets
+    return estimate;
+}
+
+bool HyperLogLog::Merge(const HyperLogLog& other) {
+    if (other.m_precision != m_precision)
+        return false;
+    for (size_t i = 0; i < m_registers.size(); ++i)
+        m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+    return true;
+}
+
+void HyperLogLog::Reset() {
+    std::fill(m_registers.begin(), m_registers.end(), 0);
+}
+
+// ---------------------------------------------------------------------------
+// TrafficSketch
+
+TrafficSketch::TrafficSketch(const Config& config)
+    : m_config(config), m_packets(config.cm_width, config.cm_depth),
+      m_bytes(config.cm_width, config.cm_depth), m_top(config.top_k),
+      m_distinct(config.hll_precision) {}
+
+void TrafficSketch::Update(const FlowKey& key, uint32_t bytes) {
+    FlowKey heavy = Project(key, m_config.heavy_fields);
+    uint64_t hash = HashKey(heavy);
+    m_packets.Add(hash);
+    m_bytes.Add(hash, bytes);
+    m_top.Add(heavy, hash, bytes);
+    m_distinct.Add(HashKey(Project(key, m_config.distinct_fields)));
+}
+
+bool TrafficSketch::Update(const uint8_t* frame, size_t length) {
+    FlowKey key;
+    if (!ExtractFlowKey(frame, length, key))
+        return false;
+    Update(key, static_cast<uint32_t>(length));
+    return true;
+}
+
+uint64_t TrafficSketch::EstimatePackets(const FlowKey& key) const {
+    return m_packets.Estimate(HashKey(Project(key, m_config.heavy_fields)));
+}
+
+uint64_t TrafficSketch::EstimateBytes(const FlowKey& key) const {
+    return m_bytes.Estimate(HashKey(Project(key, m_config.heavy_fields)));
+}
+
+bool TrafficSketch::Merge(const TrafficSketch& other) {
+    const Config& a = m_config;
+    const Config& b = other.m_config;
+    if (a.heavy_fields != b.heavy_fields || a.distinct_fields != b.distinct_fields ||
+        a.cm_width != b.cm_width || a.cm_depth != b.cm_depth ||
+        a.hll_precision != b.hll_precision)
+        return false;
+    m_packets.Merge(other.m_packets);
+    m_bytes.Merge(other.m_bytes);
+    m_top.Merge(other.m_top);
+    m_distinct.Merge(other.m_distinct);
+    return true;
+}
+
+void TrafficSketch::Reset() {
+    m_packets.Reset();
+    m_bytes.Reset();
+    m_top.Reset();
+    m_distinct.Reset();
+}
+} // namespace libpkt::sketch
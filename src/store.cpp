@@ -0,0 +1,608 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/store.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libpkt::store {
+namespace {
+constexpr char IndexMagic[8] = {'L', 'P', 'K', 'T', 'I', 'D', 'X', '1'};
+constexpr uint32_t IndexVersion = 1;
+constexpr uint32_t PcapMagicNano = 0xA1B23C4D;
+constexpr size_t PcapHeaderSize = 24;
+constexpr size_t RecordHeaderSize = 16;
+constexpr uint32_t SnapLen = 262144;
+constexpr uint64_t HostTag = 1ull << 40; // keeps host keys apart from flow keys
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bloom_hashes;
+    uint64_t packets;
+    uint64_t first_ns; // earliest and latest timestamp
+    uint64_t last_ns;
+    uint64_t bucket_base_ns;
+    uint64_t bucket_ns;
+    uint64_t buckets;
+    uint64_t hosts;
+    uint64_t flows;
+    uint64_t postings;
+    uint64_t bloom_words;
+};
+
+struct HostEntry {
+    uint32_t host;
+    uint32_t count;
+    uint64_t first; // into the postings array
+};
+
+struct FlowEntry {
+    uint64_t hash;
+    uint32_t first; // a segment holds fewer than 2^32 postings
+    uint32_t count;
+};
+
+// Byte offsets of the arrays that follow the header, each 8-byte aligned:
+// packet offsets, bucket_lo, bucket_hi, hosts, flows, postings, bloom.
+// Timestamps are read from the pcap record headers.
+struct Layout {
+    size_t offsets, bucket_lo, bucket_hi, hosts, flows, postings, bloom, total;
+};
+
+size_t Align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+
+Layout ComputeLayout(const IndexHeader& h) {
+    Layout l;
+    l.offsets = sizeof(IndexHeader);
+    l.bucket_lo = Align8(l.offsets + h.packets * 4);
+    l.bucket_hi = Align8(l.bucket_lo + h.buckets * 4);
+    l.hosts = Align8(l.bucket_hi + h.buckets * 4);
+    l.flows = l.hosts + h.hosts * sizeof(HostEntry);
+    l.postings = l.flows + h.flows * sizeof(FlowEntry);
+    l.bloom = Align8(l.postings + h.postings * 4);
+    l.total = l.bloom + h.bloom_words * 8;
+    return l;
+}
+
+uint64_t Mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t HostKey(uint32_t host) {
+    return Mix(host | HostTag);
+}
+
+// Both directions of a flow share one hash.
+uint64_t FlowHash(FlowKey key) {
+    if (key.src_ip > key.dst_ip || (key.src_ip == key.dst_ip && key.src_port > key.dst_port))
+        key = key.Reversed();
+    return HashFlowKey(key);
+}
+
+bool SameFlow(const FlowKey& a, const FlowKey& b) {
+    return a == b || a == b.Reversed();
+}
+
+// Bit positions by double hashing (Kirsch-Mitzenmacher).
+void BloomAdd(uint64_t* words, uint64_t bits, uint32_t hashes, uint64_t key) {
+    uint64_t h1 = key & 0xFFFFFFFF, h2 = (key >> 32) | 1;
+    for (uint32_t i = 0; i < hashes; ++i) {
+        uint64_t bit = (h1 + i * h2) & (bits - 1);
+        words[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+bool BloomTest(const uint64_t* words, uint64_t bits, uint32_t hashes, uint64_t key) {
+    uint64_t h1 = key & 0xFFFFFFFF, h2 = (key >> 32) | 1;
+    for (uint32_t i = 0; i < hashes; ++i) {
+        uint64_t bit = (h1 + i * h2) & (bits - 1);
+        if (!(words[bit / 64] & (1ull << (bit % 64))))
+            return false;
+    }
+    return true;
+}
+
+std::string SegmentPath(const std::string& directory, uint32_t number, const char* suffix) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%08u%s", number, suffix);
+    return directory + name;
+}
+
+// Segment number of "NNNNNNNN<suffix>", 0 if the name does not match.
+uint32_t ParseSegmentName(const char* name, const char* suffix) {
+    size_t length = std::strlen(name);
+    if (length != 8 + std::strlen(suffix) || std::strcmp(name + 8, suffix) != 0)
+        return 0;
+    uint32_t number = 0;
+    for (int i = 0; i < 8; ++i) {
+        if (name[i] < '0' || name[i] > '9')
+            return 0;
+        number = number * 10 + (name[i] - '0');
+    }
+    return number;
+}
+
+bool WriteFully(int fd, const uint8_t* data, size_t length) {
+    while (length != 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+const uint8_t* MapFile(const std::string& path, size_t& size, int advice) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return nullptr;
+    madvise(map, st.st_size, advice);
+    size = st.st_size;
+    return static_cast<const uint8_t*>(map);
+}
+} // namespace
+
+Writer::Writer(const Config& config)
+    : m_config(config), m_nextSegment(1), m_fd(-1), m_segmentBytes(0), m_buffered(0),
+      m_flushedPackets(0) {
+    m_config.segment_bytes = std::min<uint64_t>(m_config.segment_bytes, UINT32_MAX);
+    m_config.segment_bytes = std::max<uint64_t>(m_config.segment_bytes, 1 << 16);
+    if (m_config.bucket_ns == 0)
+        m_config.bucket_ns = 1;
+    m_buffer.resize(std::max<size_t>(m_config.write_buffer, 1 << 16));
+}
+
+Writer::~Writer() {
+    Close();
+}
+
+bool Writer::Open(const std::string& directory) {
+    Close();
+    if (::mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST)
+        return false;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return false;
+    m_directory = directory;
+    m_nextSegment = 1;
+    while (struct dirent* entry = readdir(dir)) {
+        uint32_t number = ParseSegmentName(entry->d_name, ".pcap");
+        m_nextSegment = std::max(m_nextSegment, number + 1);
+    }
+    closedir(dir);
+    m_stats = Stats{};
+    return true;
+}
+
+void Writer::Close() {
+    Seal();
+    m_directory.clear();
+}
+
+bool Writer::StartSegment() {
+    if (m_directory.empty())
+        return false;
+    std::string path = SegmentPath(m_directory, m_nextSegment, ".pcap");
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+        return false;
+    uint32_t header[6] = {PcapMagicNano, 2 | (4u << 16), 0, 0, SnapLen, 1};
+    if (!WriteFully(m_fd, reinterpret_cast<const uint8_t*>(header), sizeof(header))) {
+        ++m_stats.write_errors;
+        ::close(m_fd);
+        ::unlink(path.c_str());
+        m_fd = -1;
+        return false;
+    }
+    m_buffered = 0;
+    m_segmentBytes = PcapHeaderSize;
+    m_flushedPackets = 0;
+    return true;
+}
+
+bool Writer::Append(const FrameView& frame, size_t wire_length) {
+    size_t record = RecordHeaderSize + frame.length;
+    if (m_fd >= 0 && m_segmentBytes + record > m_config.segment_bytes && !Seal())
+        return false;
+    if (m_fd < 0 && !StartSegment())
+        return false;
+    if (m_buffered + record > m_buffer.size() && !FlushBuffer())
+        return false;
+
+    uint32_t header[4] = {static_cast<uint32_t>(frame.timestamp_ns / 1000000000ull),
+                          static_cast<uint32_t>(frame.timestamp_ns % 1000000000ull),
+                          static_cast<uint32_t>(frame.length),
+                          static_cast<uint32_t>(std::max(wire_length, frame.length))};
+    if (record > m_buffer.size()) {
+        // Larger than the whole buffer (which the flush above emptied):
+        // write it through.
+        if (!WriteFully(m_fd, reinterpret_cast<const uint8_t*>(header), sizeof(header)) ||
+            !WriteFully(m_fd, frame.data, frame.length)) {
+            ++m_stats.write_errors;
+            Rollback();
+            return false;
+        }
+    } else {
+        std::memcpy(m_buffer.data() + m_buffered, header, sizeof(header));
+        std::memcpy(m_buffer.data() + m_buffered + sizeof(header), frame.data, frame.length);
+        m_buffered += record;
+    }
+
+    // Index the packet only once its record is written or buffered.
+    auto packet = static_cast<uint32_t>(m_timestamps.size());
+    m_timestamps.push_back(frame.timestamp_ns);
+    m_offsets.push_back(static_cast<uint32_t>(m_segmentBytes));
+    FlowKey key;
+    if (ExtractFlowKey(frame.data, frame.length, key)) {
+        m_hostPostings.push_back(static_cast<uint64_t>(key.src_ip) << 32 | packet);
+        if (key.dst_ip != key.src_ip)
+            m_hostPostings.push_back(static_cast<uint64_t>(key.dst_ip) << 32 | packet);
+        m_flowPostings.emplace_back(FlowHash(key), packet);
+    }
+    if (m_buffered == 0)
+        m_flushedPackets = m_timestamps.size();
+    m_segmentBytes += record;
+    m_stats.bytes += record;
+    ++m_stats.packets;
+    return true;
+}
+
+bool Writer::FlushBuffer() {
+    if (m_buffered == 0)
+        return true;
+    if (!WriteFully(m_fd, m_buffer.data(), m_buffered)) {
+        ++m_stats.write_errors;
+        Rollback();
+        return false;
+    }
+    m_buffered = 0;
+    m_flushedPackets = m_timestamps.size();
+    return true;
+}
+
+void Writer::Rollback() {
+    // Drop the buffered packets and cut off whatever part of a failed write
+    // reached the file, so the segment ends with its last whole record.
+    const uint64_t durable = m_segmentBytes - m_buffered;
+    if (::ftruncate(m_fd, static_cast<off_t>(durable)) < 0 ||
+        ::lseek(m_fd, static_cast<off_t>(durable), SEEK_SET) < 0) {
+        Abandon();
+        return;
+    }
+    m_stats.packets -= m_timestamps.size() - m_flushedPackets;
+    m_stats.bytes -= m_buffered;
+    m_segmentBytes = durable;
+    m_buffered = 0;
+    m_timestamps.resize(m_flushedPackets);
+    m_offsets.resize(m_flushedPackets);
+    // Postings are appended in packet order.
+    while (!m_hostPostings.empty() &&
+           static_cast<uint32_t>(m_hostPostings.back()) >= m_flushedPackets)
+        m_hostPostings.pop_back();
+    while (!m_flowPostings.empty() && m_flowPostings.back().second >= m_flushedPackets)
+        m_flowPostings.pop_back();
+}
+
+void Writer::Abandon() {
+    // The segment file cannot be repaired: remove it with everything in it.
+    ::close(m_fd);
+    m_fd = -1;
+    ::unlink(SegmentPath(m_directory, m_nextSegment, ".pcap").c_str());
+    m_stats.packets -= m_timestamps.size();
+    m_stats.bytes -= m_segmentBytes - PcapHeaderSize;
+    m_segmentBytes = 0;
+    m_buffered = 0;
+    m_flushedPackets = 0;
+    m_timestamps.clear();
+    m_offsets.clear();
+    m_hostPostings.clear();
+    m_flowPostings.clear();
+}
+
+bool Writer::Seal() {
+    if (m_fd < 0)
+        return true;
+    bool ok = FlushBuffer();
+    if (m_fd < 0)
+        return false;
+    if (m_timestamps.empty()) {
+        // Nothing made it into this segment; an index of it would be empty.
+        Abandon();
+        return ok;
+    }
+    ok = ::close(m_fd) == 0 && ok;
+    m_fd = -1;
+    m_stats.bytes += PcapHeaderSize;
+    ok = WriteIndex() && ok;
+    m_timestamps.clear();
+    m_offsets.clear();
+    m_hostPostings.clear();
+    m_flowPostings.clear();
+    ++m_nextSegment;
+    ++m_stats.segments;
+    return ok;
+}
+
+bool Writer::WriteIndex() {
+    IndexHeader h{};
+    std::memcpy(h.magic, IndexMagic, sizeof(h.magic));
+    h.version = IndexVersion;
+    h.packets = m_timestamps.size();
+    h.first_ns = *std::min_element(m_timestamps.begin(), m_timestamps.end());
+    h.last_ns = *std::max_element(m_timestamps.begin(), m_timestamps.end());
+    // Never more buckets than packets: a sparse segment gets wider buckets.
+    h.bucket_ns = m_config.bucket_ns;
+    while ((h.last_ns - h.first_ns) / h.bucket_ns + 1 > h.packets + 1)
+        h.bucket_ns *= 2;
+    h.bucket_base_ns = h.first_ns - h.first_ns % h.bucket_ns;
+    h.buckets = (h.last_ns - h.bucket_base_ns) / h.bucket_ns + 1;
+
+    std::sort(m_hostPostings.begin(), m_hostPostings.end());
+    std::sort(m_flowPostings.begin(), m_flowPostings.end());
+    h.postings = m_hostPostings.size() + m_flowPostings.size();
+    for (size_t i = 0; i < m_hostPostings.size(); ++i)
+        h.hosts += i == 0 || (m_hostPostings[i] >> 32) != (m_hostPostings[i - 1] >> 32);
+    for (size_t i = 0; i < m_flowPostings.size(); ++i)
+        h.flows += i == 0 || m_flowPostings[i].first != m_flowPostings[i - 1].first;
+
+    uint64_t bloomBits = 64;
+    while (bloomBits < (h.hosts + h.flows) * m_config.bloom_bits_per_key)
+        bloomBits *= 2;
+    h.bloom_words = bloomBits / 64;
+    h.bloom_hashes = std::max<uint32_t>(1, m_config.bloom_bits_per_key * 69 / 100);
+
+    Layout layout = ComputeLayout(h);
+    std::vector<uint8_t> out(layout.total);
+    std::memcpy(out.data(), &h, sizeof(h));
+    std::memcpy(out.data() + layout.offsets, m_offsets.data(), h.packets * 4);
+
+    // Timestamps need not be monotonic. Bucket k covers [start, end); its
+    // candidates begin at the first packet whose running maximum reaches
+    // `start` (everything before is earlier) and stop before the first
+    // packet whose suffix minimum reaches `end` (everything after is later).
+    auto* bucketLo = reinterpret_cast<uint32_t*>(out.data() + layout.bucket_lo);
+    auto* bucketHi = reinterpret_cast<uint32_t*>(out.data() + layout.bucket_hi);
+    size_t i = 0;
+    uint64_t runningMax = m_timestamps[0];
+    for (uint64_t k = 0; k < h.buckets; ++k) {
+        uint64_t start = h.bucket_base_ns + k * h.bucket_ns;
+        while (i < h.packets && std::max(runningMax, m_timestamps[i]) < start)
+            runningMax = std::max(runningMax, m_timestamps[i++]);
+        bucketLo[k] = static_cast<uint32_t>(i);
+    }
+    std::vector<uint64_t> suffixMin(m_timestamps);
+    for (size_t j = h.packets - 1; j-- > 0;)
+        suffixMin[j] = std::min(suffixMin[j], suffixMin[j + 1]);
+    size_t j = 0;
+    for (uint64_t k = 0; k < h.buckets; ++k) {
+        uint64_t end = h.bucket_base_ns + (k + 1) * h.bucket_ns;
+        while (j < h.packets && suffixMin[j] < end)
+            ++j;
+        bucketHi[k] = static_cast<uint32_t>(j);
+    }
+
+    auto* hosts = reinterpret_cast<HostEntry*>(out.data() + layout.hosts);
+    auto* flows = reinterpret_cast<FlowEntry*>(out.data() + layout.flows);
+    auto* postings = reinterpret_cast<uint32_t*>(out.data() + layout.postings);
+    auto* bloom = reinterpret_cast<uint64_t*>(out.data() + layout.bloom);
+    size_t posting = 0;
+    for (size_t p = 0; p < m_hostPostings.size(); ++p) {
+        auto host = static_cast<uint32_t>(m_hostPostings[p] >> 32);
+        if (p == 0 || host != hosts[-1].host) {
+            *hosts++ = {host, 0, posting};
+            BloomAdd(bloom, bloomBits, h.bloom_hashes, HostKey(host));
+        }
+        ++hosts[-1].count;
+        postings[posting++] = static_cast<uint32_t>(m_hostPostings[p]);
+    }
+    for (size_t p = 0; p < m_flowPostings.size(); ++p) {
+        uint64_t hash = m_flowPostings[p].first;
+        if (p == 0 || hash != flows[-1].hash) {
+            *flows++ = {hash, static_cast<uint32_t>(posting), 0};
+            BloomAdd(bloom, bloomBits, h.bloom_hashes, hash);
+        }
+        ++flows[-1].count;
+        postings[posting++] = m_flowPostings[p].second;
+    }
+
+    // Written under a temporary name so readers never see a partial index.
+    std::string path = SegmentPath(m_directory, m_nextSegment, ".idx");
+    std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ++m_stats.write_errors;
+        return false;
+    }
+    bool ok = WriteFully(fd, out.data(), out.size());
+    ok = ::close(fd) == 0 && ok;
+    ok = ok && ::rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        ++m_stats.write_errors;
+        ::unlink(temp.c_str());
+        return false;
+    }
+    m_stats.index_bytes += out.size();
+    return true;
+}
+
+Reader::~Reader() {
+    Close();
+}
+
+bool Reader::Open(const std::string& directory) {
+    Close();
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return false;
+    std::vector<uint32_t> numbers;
+    while (struct dirent* entry = readdir(dir)) {
+        if (uint32_t number = ParseSegmentName(entry->d_name, ".idx"))
+            numbers.push_back(number);
+    }
+    closedir(dir);
+    std::sort(numbers.begin(), numbers.end());
+
+    for (uint32_t number : numbers) {
+        Segment segment{};
+        segment.index = MapFile(SegmentPath(directory, number, ".idx"), segment.index_size,
+                                MADV_RANDOM);
+        segment.data = MapFile(SegmentPath(directory, number, ".pcap"), segment.data_size,
+                               MADV_RANDOM);
+        bool valid = segment.index != nullptr && segment.data != nullptr &&
+                     segment.index_size >= sizeof(IndexHeader);
+        if (valid) {
+            IndexHeader h;
+            std::memcpy(&h, segment.index, sizeof(h));
+            valid = std::memcmp(h.magic, IndexMagic, sizeof(h.magic)) == 0 &&
+                    h.version == IndexVersion && h.packets != 0 && h.buckets != 0 &&
+                    ComputeLayout(h).total == segment.index_size;
+        }
+        if (!valid) {
+            if (segment.index != nullptr)
+                munmap(const_cast<uint8_t*>(segment.index), segment.index_size);
+            if (segment.data != nullptr)
+                munmap(const_cast<uint8_t*>(segment.data), segment.data_size);
+            continue;
+        }
+        m_segments.push_back(segment);
+    }
+    return true;
+}
+
+void Reader::Close() {
+    for (const Segment& segment : m_segments) {
+        munmap(const_cast<uint8_t*>(segment.index), segment.index_size);
+        munmap(const_cast<uint8_t*>(segment.data), segment.data_size);
+    }
+    m_segments.clear();
+}
+
+size_t Reader::Run(const Query& query, Visitor visitor, void* context) {
+    m_stats = Stats{};
+    size_t matches = 0;
+    for (const Segment& segment : m_segments) {
+        ++m_stats.segments;
+        matches += RunSegment(segment, query, visitor, context);
+    }
+    m_stats.matches = matches;
+    return matches;
+}
+
+size_t Reader::RunSegment(const Segment& segment, const Query& query, Visitor visitor,
+                          void* context) {
+    IndexHeader h;
+    std::memcpy(&h, segment.index, sizeof(h));
+    if (query.to_ns < h.first_ns || query.from_ns > h.last_ns || query.from_ns > query.to_ns) {
+        ++m_stats.skipped_time;
+        return 0;
+    }
+    Layout layout = ComputeLayout(h);
+    const uint8_t* base = segment.index;
+    auto offsets = reinterpret_cast<const uint32_t*>(base + layout.offsets);
+    auto bloom = reinterpret_cast<const uint64_t*>(base + layout.bloom);
+    uint64_t bloomBits = h.bloom_words * 64;
+
+    uint64_t flowHash = query.has_flow ? FlowHash(query.flow) : 0;
+    if ((query.has_host &&
+         !BloomTest(bloom, bloomBits, h.bloom_hashes, HostKey(query.host))) ||
+        (query.has_flow && !BloomTest(bloom, bloomBits, h.bloom_hashes, flowHash))) {
+        ++m_stats.skipped_bloom;
+        return 0;
+    }
+
+    // Candidate packet range from the time buckets.
+    uint32_t lo = 0, hi = static_cast<uint32_t>(h.packets);
+    if (query.from_ns > h.bucket_base_ns)
+        lo = reinterpret_cast<const uint32_t*>(base + layout.bucket_lo)
+            [(query.from_ns - h.bucket_base_ns) / h.bucket_ns];
+    if (query.to_ns < h.last_ns)
+        hi = reinterpret_cast<const uint32_t*>(base + layout.bucket_hi)
+            [(query.to_ns - h.bucket_base_ns) / h.bucket_ns];
+
+    // Postings of the most selective key, or every packet in range.
+    const uint32_t* list = nullptr;
+    size_t listSize = 0;
+    if (query.has_flow) {
+        auto flows = reinterpret_cast<const FlowEntry*>(base + layout.flows);
+        auto it = std::lower_bound(flows, flows + h.flows, flowHash,
+                                   [](const FlowEntry& e, uint64_t v) { return e.hash < v; });
+        if (it == flows + h.flows || it->hash != flowHash)
+            return 0;
+        list = reinterpret_cast<const uint32_t*>(base + layout.postings) + it->first;
+        listSize = it->count;
+    } else if (query.has_host) {
+        auto hosts = reinterpret_cast<const HostEntry*>(base + layout.hosts);
+        auto it = std::lower_bound(hosts, hosts + h.hosts, query.host,
+                                   [](const HostEntry& e, uint32_t v) { return e.host < v; });
+        if (it == hosts + h.hosts || it->host != query.host)
+            return 0;
+        list = reinterpret_cast<const uint32_t*>(base + layout.postings) + it->first;
+        listSize = it->count;
+    }
+    size_t pos = list ? std::lower_bound(list, list + listSize, lo) - list : lo;
+    size_t end = list ? listSize : hi;
+
+    size_t matches = 0;
+    for (; pos < end; ++pos) {
+        uint32_t packet = list ? list[pos] : static_cast<uint32_t>(pos);
+        if (packet >= hi)
+            break;
+        ++m_stats.candidates;
+        size_t offset = offsets[packet];
+        if (offset + RecordHeaderSize > segment.data_size)
+            continue;
+        uint32_t record[4]; // sec, nsec, caplen, len
+        std::memcpy(record, segment.data + offset, sizeof(record));
+        uint64_t ts = record[0] * 1000000000ull + record[1];
+        uint32_t caplen = record[2];
+        if (ts < query.from_ns || ts > query.to_ns ||
+            caplen > segment.data_size - offset - RecordHeaderSize)
+            continue;
+        FrameView frame{segment.data + offset + RecordHeaderSize, caplen, ts};
+        if (query.has_flow) {
+            // The directory is keyed by hash; confirm the actual 5-tuple.
+            FlowKey key;
+            if (!ExtractFlowKey(frame.data, frame.length, key) || !SameFlow(key, query.flow))
+                continue;
+            if (query.has_host && key.src_ip != query.host && key.dst_ip != query.host)
+                continue;
+        }
+        visitor(frame, context);
+        ++matches;
+    }
+    return matches;
+}
+
+} // namespace libpkt::store
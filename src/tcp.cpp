@@ -7,9 +7,10 @@
  */
 #include "libpkt/tcp.hpp"
 
+#include "libpkt/format.hpp"
+
 #include <arpa/inet.h>
-#include <iomanip>
-#include <sstream>
+#include <cstring>
 
 namespace libpkt::tcp {
 #pragma pack(push, 1)
@@ -32,8 +33,6 @@ Packet::Packet(const uint8_t* data, size_t length) : libpkt::Packet(data, length
     }
 }
 
-Packet::~Packet() = default;
-
 uint16_t Packet::SrcPort() const {
     if (!m_valid)
         return 0;
@@ -83,16 +82,140 @@ uint16_t Packet::Window() const {
     return ntohs(hdr->window);
 }
 
+Options Packet::GetOptions() const {
+    size_t end = PayloadOffset();
+    if (end <= sizeof(TcpHeader))
+        return Options(nullptr, nullptr);
+    return Options(m_data + sizeof(TcpHeader), m_data + end);
+}
+
+ParsedOptions Packet::ParseOptions() const {
+    ParsedOptions out;
+    for (const Option& opt : GetOptions()) {
+        switch (opt.kind) {
+        case OptionKind::MSS:
+            if (opt.length == 2)
+                out.mss = static_cast<uint16_t>(opt.data[0] << 8 | opt.data[1]);
+            break;
+        case OptionKind::WindowScale:
+            if (opt.length == 1) {
+                out.window_scale = opt.data[0];
+                out.has_window_scale = true;
+            }
+            break;
+        case OptionKind::SACKPermitted:
+            out.sack_permitted = true;
+            break;
+        case OptionKind::SACK:
+            for (size_t i = 0; i + 8 <= opt.length && out.sack_blocks < 4; i += 8) {
+                uint32_t edges[2];
+                std::memcpy(edges, opt.data + i, sizeof(edges));
+                out.sack[out.sack_blocks][0] = ntohl(edges[0]);
+                out.sack[out.sack_blocks][1] = ntohl(edges[1]);
+                ++out.sack_blocks;
+            }
+            break;
+        case OptionKind::Timestamp:
+            if (opt.length == 8) {
+                uint32_t ts[2];
+                std::memcpy(ts, opt.data, sizeof(ts));
+                out.ts_val = ntohl(ts[0]);
+                out.ts_ecr = ntohl(ts[1]);
+                out.has_timestamp = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return out;
+}
+
+bool Packet::GetTimestamp(uint32_t& tsVal, uint32_t& tsEcr) const {
+    Options opts = GetOptions();
+    const uint8_t* p = opts.Data();
+    // RFC 7323 appendix A layout: NOP, NOP, kind 8, length 10.
+    if (opts.Size() >= 12 && p[0] == 1 && p[1] == 1 && p[2] == 8 && p[3] == 10) {
+        uint32_t ts[2];
+        std::memcpy(ts, p + 4, sizeof(ts));
+        tsVal = ntohl(ts[0]);
+        tsEcr = ntohl(ts[1]);
+        return true;
+    }
+    for (const Option& opt : opts) {
+        if (opt.kind == OptionKind::Timestamp && opt.length == 8) {
+            uint32_t ts[2];
+            std::memcpy(ts, opt.data, sizeof(ts));
+            tsVal = ntohl(ts[0]);
+            tsEcr = ntohl(ts[1]);
+            return true;
+        }
+    }
+    return false;
+}
+
+OptionIterator::OptionIterator(const uint8_t* begin, const uint8_t* end)
+    : m_pos(begin), m_end(end), m_current{} {
+    Load();
+}
+
+OptionIterator& OptionIterator::operator++() {
+    size_t size = (m_current.kind == OptionKind::NOP) ? 1 : 2 + m_current.length;
+    m_pos += size;
+    Load();
+    return *this;
+}
+
+void OptionIterator::Load() {
+    if (m_pos == nullptr || m_pos >= m_end || m_pos[0] == 0) {
+        m_pos = nullptr;
+        return;
+    }
+    m_current.kind = static_cast<OptionKind>(m_pos[0]);
+    if (m_current.kind == OptionKind::NOP) {
+        m_current.length = 0;
+        m_current.data = m_pos + 1;
+        return;
+    }
+    // kind, length (which counts both), value
+    if (m_end - m_pos < 2 || m_pos[1] < 2 || m_pos[1] > m_end - m_pos) {
+        m_pos = nullptr;
+        return;
+    }
+    m_current.length = static_cast<uint8_t>(m_pos[1] - 2);
+    m_current.data = m_pos + 2;
+}
+
+const uint8_t* Packet::Payload() const {
+    return m_data + PayloadOffset();
+}
+
+size_t Packet::PayloadLength() const {
+    return m_length - PayloadOffset();
+}
+
+size_t Packet::PayloadOffset() const {
+    size_t offset = DataOffset();
+    return (offset >= sizeof(TcpHeader) && offset <= m_length) ? offset : m_length;
+}
+
 std::string Packet::Summary() const {
+    TextBuffer out(96);
+    AppendSummary(out);
+    return out.String();
+}
+
+void Packet::AppendSummary(TextBuffer& out) const {
     if (!m_valid) {
-        return "Invalid TCP Packet";
+        out.Append("Invalid TCP Packet");
+        return;
     }
-    std::ostringstream oss;
-    oss << "TCP Packet: SrcPort=" << SrcPort() << ", DstPort=" << DstPort()
-        << ", SeqNum=" << SeqNum() << ", AckNum=" << AckNum() << ", Flags=0x" << std::hex
-        << std::setw(2) << std::setfill('0') << static_cast<int>(Flags()) << ", Window=" << std::dec
-        << Window();
-    return oss.str();
+    out.Append("TCP Packet: SrcPort=").AppendUInt(SrcPort());
+    out.Append(", DstPort=").AppendUInt(DstPort());
+    out.Append(", SeqNum=").AppendUInt(SeqNum());
+    out.Append(", AckNum=").AppendUInt(AckNum());
+    out.Append(", Flags=0x").AppendHex(Flags(), 2);
+    out.Append(", Window=").AppendUInt(Window());
 }
 
 bool Packet::IsValid() const {
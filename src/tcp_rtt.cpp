@@ -0,0 +1,249 @@
+/*
+ * ============================================================================
+ * libpkt - A low-level C++ networking library for Linux.
+ * Apache License 2.0 (see LICENSE file or
+ * https://www.apache.org/licenses/LICENSE-2.0)
+ * ============================================================================
+ */
+#include "libpkt/tcp_rtt.hpp"
+
+#include "libpkt/ethernet.hpp"
+#include "libpkt/ipv4.hpp"
+
+namespace libpkt::tcp {
+namespace {
+// Sequence number comparisons modulo 2^32 (RFC 1982).
+bool SeqLT(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+bool SeqLEQ(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) <= 0;
+}
+} // namespace
+
+void RttTracker::Queue::Push(uint32_t value, uint64_t ns) {
+    if (count == Pending) {
+        head = (head + 1) % Pending;
+        --count;
+    }
+    marks[(head + count) % Pending] = {value, ns};
+    ++count;
+}
+
+bool RttTracker::Queue::Acknowledge(uint32_t v, bool exact, Mark& out) {
+    bool found = false;
+    while (count != 0 && SeqLEQ(marks[head].value, v)) {
+        out = marks[head];
+        found = true;
+        head = (head + 1) % Pending;
+        --count;
+    }
+    return found && (!exact || out.value == v);
+}
+
+RttTracker::RttTracker(const Config& config) : m_config(config), m_size(0), m_hand(0) {
+    size_t capacity = 16;
+    while (capacity < config.capacity)
+        capacity <<= 1;
+    m_slots.assign(capacity, Connection{});
+}
+
+bool RttTracker::Update(const FrameView& frame) {
+    EthernetFrame eth(frame.data, frame.length);
+    if (!eth.IsValid() || eth.Ethertype() != EtherType::IPv4)
+        return false;
+    IPv4Packet ip(eth.Payload(), eth.PayloadLength());
+    // Later fragments carry no TCP header.
+    if (!ip.IsValid() || ip.GetProtocol() != Protocol::TCP || ip.FragmentOffset() != 0)
+        return false;
+    Packet tcp(ip.Payload(), ip.PayloadLength());
+    if (!tcp.IsValid())
+        return false;
+
+    FlowKey key{ip.SrcAddressRaw(), ip.DstAddressRaw(), tcp.SrcPort(), tcp.DstPort(),
+                ip.ProtocolRaw()};
+    Update(key, tcp, tcp.PayloadLength(), frame.timestamp_ns);
+    return true;
+}
+
+void RttTracker::Update(const FlowKey& key, const Packet& tcp, size_t payloadLength,
+                        uint64_t timestamp_ns) {
+    const bool swap = key.src_ip > key.dst_ip ||
+                      (key.src_ip == key.dst_ip && key.src_port > key.dst_port);
+    const FlowKey canonical = swap ? key.Reversed() : key;
+    const uint8_t d = swap ? 1 : 0;
+    const uint8_t flags = tcp.Flags();
+    const uint32_t seq = tcp.SeqNum();
+    const uint32_t ack = tcp.AckNum();
+
+    // Only SYNs and data open state; stray ACKs, FINs and RSTs never do.
+    const bool create = !(flags & RST) && ((flags & SYN) || payloadLength != 0);
+    Connection* conn = Find(canonical, HashFlowKey(canonical), create);
+    if (conn == nullptr)
+        return;
+    if (flags & RST) {
+        Erase(conn - m_slots.data());
+        return;
+    }
+    conn->last_ns = timestamp_ns;
+    Direction& self = conn->dirs[d];
+    Direction& peer = conn->dirs[d ^ 1];
+
+    if ((flags & (SYN | ACK)) == SYN) {
+        if (conn->handshake == SynSeen && conn->client_dir == d && conn->client_isn == seq) {
+            conn->syn_ns = 0; // retransmitted SYN
+            ++m_stats.karn_discards;
+        } else {
+            // New connection, possibly reusing the 4-tuple: start over.
+            conn->dirs[0] = {};
+            conn->dirs[1] = {};
+            conn->handshake = SynSeen;
+            conn->client_dir = d;
+            conn->client_isn = seq;
+            conn->syn_ns = timestamp_ns;
+        }
+        self.next_seq = seq + 1;
+        self.seq_valid = true;
+    } else if (flags & SYN) {
+        if (conn->handshake == SynSeen && d != conn->client_dir && ack == conn->client_isn + 1) {
+            if (conn->syn_ns != 0)
+                Emit(*conn, Sample::HandshakeServer, conn->syn_ns, timestamp_ns);
+            conn->handshake = SynAckSeen;
+            conn->server_isn = seq;
+            conn->synack_ns = timestamp_ns;
+        } else if (conn->handshake == SynAckSeen && d != conn->client_dir &&
+                   seq == conn->server_isn) {
+            conn->synack_ns = 0; // retransmitted SYN/ACK
+            ++m_stats.karn_discards;
+        }
+        self.next_seq = seq + 1;
+        self.seq_valid = true;
+    } else if ((flags & ACK) && conn->handshake == SynAckSeen && d == conn->client_dir &&
+               ack == conn->server_isn + 1) {
+        if (conn->synack_ns != 0)
+            Emit(*conn, Sample::HandshakeClient, conn->synack_ns, timestamp_ns);
+        conn->handshake = Done;
+    }
+
+    if (payloadLength != 0) {
+        const uint32_t end = seq + static_cast<uint32_t>(payloadLength);
+        if (self.seq_valid && SeqLT(seq, self.next_seq)) {
+            // Retransmission or reordering: any outstanding mark could now be
+            // acknowledged by either copy.
+            self.data.count = 0;
+            ++m_stats.karn_discards;
+        } else {
+            self.data.Push(end, timestamp_ns);
+        }
+        if (!self.seq_valid || SeqLT(self.next_seq, end)) {
+            self.next_seq = end;
+            self.seq_valid = true;
+        }
+    }
+
+    Mark mark;
+    if ((flags & ACK) && peer.data.Acknowledge(ack, false, mark))
+        Emit(*conn, Sample::Data, mark.ns, timestamp_ns);
+
+    uint32_t tsVal, tsEcr;
+    if (tcp.GetTimestamp(tsVal, tsEcr)) {
+        if (!self.ts_valid || SeqLT(self.last_tsval, tsVal)) {
+            self.timestamps.Push(tsVal, timestamp_ns);
+            self.last_tsval = tsVal;
+            self.ts_valid = true;
+        }
+        if ((flags & ACK) && tsEcr != 0 && peer.timestamps.Acknowledge(tsEcr, true, mark))
+            Emit(*conn, Sample::Timestamp, mark.ns, timestamp_ns);
+    }
+
+    if (flags & FIN) {
+        self.fin = true;
+        if (peer.fin)
+            Erase(conn - m_slots.data());
+    }
+}
+
+RttTracker::Connection* RttTracker::Find(const FlowKey& key, uint64_t hash, bool create) {
+    const size_t mask = m_slots.size() - 1;
+    size_t slot = Home(hash);
+    while (m_slots[slot].used) {
+        if (m_slots[slot].hash == hash && m_slots[slot].key == key)
+            return &m_slots[slot];
+        slot = (slot + 1) & mask;
+    }
+    if (!create)
+        return nullptr;
+
+    // Past 3/4 load, make room by dropping a connection from this probe run.
+    if (m_size >= m_slots.size() / 4 * 3) {
+        size_t victim = Home(hash);
+        while (!m_slots[victim].used)
+            victim = (victim + 1) & mask;
+        Erase(victim);
+        ++m_stats.evictions;
+        slot = Home(hash);
+        while (m_slots[slot].used)
+            slot = (slot + 1) & mask;
+    }
+
+    Connection& conn = m_slots[slot];
+    conn = Connection{};
+    conn.key = key;
+    conn.hash = hash;
+    conn.used = true;
+    ++m_size;
+    ++m_stats.connections;
+    return &conn;
+}
+
+// Linear-probing removal with backward shift.
+void RttTracker::Erase(size_t slot) {
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slot;
+    size_t next = slot;
+    for (;;) {
+        m_slots[hole].used = false;
+        for (;;) {
+            next = (next + 1) & mask;
+            if (!m_slots[next].used) {
+                --m_size;
+                return;
+            }
+            size_t home = Home(m_slots[next].hash);
+            bool between = hole <= next ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!between)
+                break;
+        }
+        m_slots[hole] = m_slots[next];
+        hole = next;
+    }
+}
+
+void RttTracker::Expire(uint64_t now_ns, size_t budget) {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t n = 0; n < budget && m_size != 0; ++n) {
+        const Connection& conn = m_slots[m_hand];
+        if (conn.used && now_ns > conn.last_ns &&
+            now_ns - conn.last_ns >= m_config.idle_timeout_ns) {
+            Erase(m_hand); // may pull a later connection into this slot
+            continue;
+        }
+        m_hand = (m_hand + 1) & mask;
+    }
+}
+
+void RttTracker::Emit(const Connection& conn, Sample kind, uint64_t sent_ns, uint64_t now_ns) {
+    // Merged or multi-queue captures are not always in time order.
+    if (now_ns < sent_ns) {
+        ++m_stats.clock_discards;
+        return;
+    }
+    const uint64_t rtt_ns = now_ns - sent_ns;
+    m_histograms[static_cast<size_t>(kind)].Record(rtt_ns);
+    if (m_config.sink != nullptr)
+        m_config.sink(conn.key, kind, rtt_ns, m_config.context);
+}
+
+} // namespace libpkt::tcp
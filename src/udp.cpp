@@ -7,9 +7,9 @@
  */
 #include "libpkt/udp.hpp"
 
+#include "libpkt/format.hpp"
+
 #include <arpa/inet.h>
-#include <iomanip>
-#include <sstream>
 
 namespace libpkt::udp {
 
@@ -28,8 +28,6 @@ Packet::Packet(const uint8_t* data, size_t length) : libpkt::Packet(data, length
     }
 }
 
-Packet::~Packet() = default;
-
 uint16_t Packet::SrcPort() const {
     if (!m_valid)
         return 0;
@@ -44,13 +42,40 @@ uint16_t Packet::DstPort() const {
     return ntohs(hdr->dst_port);
 }
 
+uint16_t Packet::DatagramLength() const {
+    if (!m_valid)
+        return 0;
+    auto hdr = reinterpret_cast<const UdpHeader*>(m_data);
+    return ntohs(hdr->length);
+}
+
+const uint8_t* Packet::Payload() const {
+    return m_data + sizeof(UdpHeader);
+}
+
+size_t Packet::PayloadLength() const {
+    if (!m_valid)
+        return 0;
+    // Trust the header length only when it fits in the captured data.
+    size_t len = DatagramLength();
+    if (len >= sizeof(UdpHeader) && len <= m_length)
+        return len - sizeof(UdpHeader);
+    return m_length - sizeof(UdpHeader);
+}
+
 std::string Packet::Summary() const {
+    TextBuffer out(48);
+    AppendSummary(out);
+    return out.String();
+}
+
+void Packet::AppendSummary(TextBuffer& out) const {
     if (!m_valid) {
-        return "Invalid UDP Packet";
+        out.Append("Invalid UDP Packet");
+        return;
     }
-    std::ostringstream oss;
-    oss << "UDP Packet: SrcPort=" << SrcPort() << ", DstPort=" << DstPort();
-    return oss.str();
+    out.Append("UDP Packet: SrcPort=").AppendUInt(SrcPort());
+    out.Append(", DstPort=").AppendUInt(DstPort());
 }
 
 bool Packet::IsValid() const {
@@ -26,4 +26,22 @@ uint16_t IPChecksum(const uint8_t* data, size_t length) {
     }
     return htons(~sum);
 }
+
+uint16_t UpdateChecksum(uint16_t checksum, const uint8_t* before, const uint8_t* after,
+                        size_t length) {
+    // HC' = ~(~HC + ~m + m'); one's complement sums do not depend on byte
+    // order, so the words are used as stored.
+    uint32_t sum = static_cast<uint16_t>(~checksum);
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        uint16_t from, to;
+        memcpy(&from, before + i, 2);
+        memcpy(&to, after + i, 2);
+        sum += static_cast<uint16_t>(~from);
+        sum += to;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
 } // namespace libpkt::checksum